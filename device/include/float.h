@@ -132,6 +132,15 @@ _Bool __fsgt (float, float) __SDCC_FLOAT_NONBANKED;
 #define exp_b dph
 #endif	/* using mcs51 assembly */
 
+/* The z80 and stm8 kernels produce bit-identical results to the C versions. */
+#if defined(__SDCC_FLOAT_LIB) && (defined(__SDCC_z80) || defined(__SDCC_z180) || defined(__SDCC_ez80_z80) || defined(__SDCC_z80n) || defined(__SDCC_r800)) && __SDCCCALL == 1 && !defined(_SDCC_NO_ASM_LIB_FUNCS)
+#define FLOAT_ASM_Z80
+#endif
+
+#if defined(__SDCC_FLOAT_LIB) && defined(__SDCC_stm8) && !defined(__SDCC_MODEL_LARGE) && __SDCCCALL == 1 && !defined(_SDCC_NO_ASM_LIB_FUNCS)
+#define FLOAT_ASM_STM8
+#endif
+
 
 #endif	/* __SDC51_FLOAT_H */
 
@@ -71,6 +71,84 @@ fs2ulong_done:
 	__endasm;
 }
 
+#elif defined(FLOAT_ASM_Z80)
+
+// unsigned long __fs2ulong (float a1)
+static void dummy(void) __naked
+{
+	__asm
+	.globl	___fs2ulong
+; a1 in hlde, result in hlde.
+___fs2ulong:
+	; negative numbers and zero give 0
+	bit	7, h
+	jr	NZ, 00005$
+	ld	a, h
+	or	a, l
+	or	a, d
+	or	a, e
+	ret	Z
+
+	; exp = EXP (a1) - EXCESS - 24, hlde = MANT (a1)
+	ld	a, l
+	rla
+	ld	a, h
+	rla
+	ld	h, #0
+	set	7, l
+	sub	a, #150
+	jr	C, 00002$
+
+	; exp > 8 saturates
+	cp	a, #9
+	jr	NC, 00006$
+	or	a, a
+	ret	Z
+	ld	b, a
+00001$:
+	sla	e
+	rl	d
+	rl	l
+	rl	h
+	djnz	00001$
+	ret
+
+00002$:
+	neg
+	cp	a, #24
+	jr	NC, 00005$
+	sub	a, #8
+	jr	C, 00004$
+00003$:
+	ld	e, d
+	ld	d, l
+	ld	l, #0
+	sub	a, #8
+	jr	NC, 00003$
+00004$:
+	add	a, #8
+	ret	Z
+	ld	b, a
+00007$:
+	srl	l
+	rr	d
+	rr	e
+	djnz	00007$
+	ret
+
+00005$:
+	ld	hl, #0
+	ld	e, l
+	ld	d, h
+	ret
+00006$:
+	ld	hl, #0xffff
+	ld	e, l
+	ld	d, h
+	ret
+	__endasm;
+}
+
 #else
 
 /*
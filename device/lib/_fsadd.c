@@ -142,6 +142,549 @@ fsadd_direct_entry:
 	__endasm;
 }
 
+#elif defined(FLOAT_ASM_Z80)
+
+// float __fsadd (float a1, float a2)
+static void dummy(void) __naked
+{
+	__asm
+	.globl	___fsadd
+	.globl	fsadd_core
+
+; a1 in hlde, a2 on stack, result in hlde, a2 popped by callee.
+___fsadd:
+	ld	iy, #2
+	add	iy, sp
+	call	fsadd_core
+	pop	iy
+	pop	af
+	pop	af
+	jp	(iy)
+
+	; hlde = a1 + (iy), working on mantissas scaled by 16 to keep guard bits.
+fsadd_core:
+	; if (!a2) return a1
+	ld	a, 0 (iy)
+	or	a, 1 (iy)
+	or	a, 2 (iy)
+	or	a, 3 (iy)
+	ret	Z
+	; if (!a1) return a2
+	ld	a, h
+	or	a, l
+	or	a, d
+	or	a, e
+	jp	Z, 00090$
+
+	; c = exp2, b = exp1
+	ld	a, 2 (iy)
+	rla
+	ld	a, 3 (iy)
+	rla
+	ld	c, a
+	ld	a, l
+	rla
+	ld	a, h
+	rla
+	ld	b, a
+	sub	a, c
+	jr	C, 00011$
+
+	; exp1 >= exp2: mant2 gets aligned
+	cp	a, #26
+	ret	NC
+	ld	c, a
+	call	00080$
+	call	00085$
+	call	00080$
+	jr	00012$
+
+00011$:
+	; exp1 < exp2: mant1 gets aligned, exp1 = exp2
+	neg
+	cp	a, #26
+	jp	NC, 00090$
+	ld	b, c
+	ld	c, a
+	call	00085$
+	call	00080$
+	call	00085$
+	call	00080$
+
+00012$:
+	; arithmetic shift right of hlde by c, bytewise first
+	ld	a, c
+	sub	a, #8
+	jr	C, 00014$
+00013$:
+	ld	c, a
+	ld	e, d
+	ld	d, l
+	ld	l, h
+	ld	a, h
+	rla
+	sbc	a, a
+	ld	h, a
+	ld	a, c
+	sub	a, #8
+	jr	NC, 00013$
+00014$:
+	add	a, #8
+	jr	Z, 00016$
+	ld	c, a
+00015$:
+	sra	h
+	rr	l
+	rr	d
+	rr	e
+	dec	c
+	jr	NZ, 00015$
+00016$:
+
+	; mant1 += mant2
+	ld	a, e
+	add	a, 0 (iy)
+	ld	e, a
+	ld	a, d
+	adc	a, 1 (iy)
+	ld	d, a
+	ld	a, l
+	adc	a, 2 (iy)
+	ld	l, a
+	ld	a, h
+	adc	a, 3 (iy)
+	ld	h, a
+
+	; sign of the result goes to 3 (iy), exponent to bc
+	ld	c, b
+	ld	b, #0
+	ld	3 (iy), b
+	bit	7, h
+	jr	Z, 00017$
+	call	00082$
+	ld	3 (iy), #0x80
+	jr	00018$
+00017$:
+	or	a, l
+	or	a, d
+	or	a, e
+	ret	Z
+
+	; normalize
+00018$:
+	ld	a, h
+	cp	a, #0x08
+	jr	NC, 00020$
+	or	a, a
+	jr	NZ, 00019$
+	ld	a, l
+	cp	a, #0x08
+	jr	NC, 00019$
+	ld	h, l
+	ld	l, d
+	ld	d, e
+	ld	e, #0
+	ld	a, c
+	sub	a, #8
+	ld	c, a
+	jr	NC, 00018$
+	dec	b
+	jr	00018$
+00019$:
+	sla	e
+	rl	d
+	rl	l
+	rl	h
+	dec	bc
+	jr	00018$
+
+	; round off
+00020$:
+	ld	a, h
+	and	a, #0xf0
+	jr	Z, 00022$
+	bit	0, e
+	jr	Z, 00021$
+	ld	a, e
+	add	a, #2
+	ld	e, a
+	jr	NC, 00021$
+	inc	d
+	jr	NZ, 00021$
+	inc	l
+	jr	NZ, 00021$
+	inc	h
+00021$:
+	srl	h
+	rr	l
+	rr	d
+	rr	e
+	inc	bc
+	jr	00020$
+
+00022$:
+	; turn off hidden bit
+	res	3, h
+	ld	a, b
+	or	a, a
+	jr	NZ, 00024$
+	; pack up and go home
+	ld	b, #4
+00023$:
+	srl	h
+	rr	l
+	rr	d
+	rr	e
+	djnz	00023$
+	srl	c
+	jr	NC, 00026$
+	set	7, l
+00026$:
+	ld	a, 3 (iy)
+	or	a, c
+	ld	h, a
+	ret
+
+00024$:
+	; exponent out of range
+	ld	hl, #0
+	ld	e, l
+	ld	d, h
+	bit	7, b
+	ret	NZ
+	ld	a, 3 (iy)
+	or	a, #0x7f
+	ld	h, a
+	ld	l, #0x80
+	ret
+
+00090$:
+	; return a2
+	ld	e, 0 (iy)
+	ld	d, 1 (iy)
+	ld	l, 2 (iy)
+	ld	h, 3 (iy)
+	ret
+
+	; unpack float in hlde into signed mantissa << 4, keeps bc
+00080$:
+	ld	a, h
+	ld	h, #0
+	set	7, l
+	sla	e
+	rl	d
+	rl	l
+	rl	h
+	sla	e
+	rl	d
+	rl	l
+	rl	h
+	sla	e
+	rl	d
+	rl	l
+	rl	h
+	sla	e
+	rl	d
+	rl	l
+	rl	h
+	rla
+	ret	NC
+	; negate hlde
+00082$:
+	xor	a, a
+	sub	a, e
+	ld	e, a
+	ld	a, #0
+	sbc	a, d
+	ld	d, a
+	ld	a, #0
+	sbc	a, l
+	ld	l, a
+	ld	a, #0
+	sbc	a, h
+	ld	h, a
+	ret
+
+	; exchange hlde with (iy)
+00085$:
+	ld	a, 0 (iy)
+	ld	0 (iy), e
+	ld	e, a
+	ld	a, 1 (iy)
+	ld	1 (iy), d
+	ld	d, a
+	ld	a, 2 (iy)
+	ld	2 (iy), l
+	ld	l, a
+	ld	a, 3 (iy)
+	ld	3 (iy), h
+	ld	h, a
+	ret
+	__endasm;
+}
+
+#elif defined(FLOAT_ASM_STM8)
+
+// float __fsadd (float a1, float a2)
+static void dummy(void) __naked
+{
+	__asm
+	.globl	___fsadd
+	.globl	fsadd_core
+
+; a1, a2 on stack, result in yx, parameters popped by callee.
+___fsadd:
+	sub	sp, #8
+	call	fsadd_core
+	ld	a, (9, sp)
+	ld	(17, sp), a
+	ld	a, (10, sp)
+	ld	(18, sp), a
+	addw	sp, #16
+	ret
+
+; yx = a1 + a2 on mantissas scaled by 16 to keep guard bits.
+; locals: (3..6) mantissa, (7, 8) exponent, (9) shift count, (10) scratch / sign
+; a1 at (13..16), a2 at (17..20), msb first.
+fsadd_core:
+	; if (!a2) return a1
+	ldw	x, (17, sp)
+	jrne	00001$
+	ldw	x, (19, sp)
+	jrne	00001$
+00002$:
+	ldw	y, (13, sp)
+	ldw	x, (15, sp)
+	ret
+00001$:
+	; if (!a1) return a2
+	ldw	x, (13, sp)
+	jrne	00003$
+	ldw	x, (15, sp)
+	jrne	00003$
+00004$:
+	ldw	y, (17, sp)
+	ldw	x, (19, sp)
+	ret
+00003$:
+	; (10) = exp2, a = exp1
+	ld	a, (18, sp)
+	sll	a
+	ld	a, (17, sp)
+	rlc	a
+	ld	(10, sp), a
+	ld	a, (14, sp)
+	sll	a
+	ld	a, (13, sp)
+	rlc	a
+	clr	(7, sp)
+	sub	a, (10, sp)
+	jrc	00005$
+
+	; exp1 >= exp2: mant2 gets aligned
+	cp	a, #26
+	jrnc	00002$
+	ld	(9, sp), a
+	add	a, (10, sp)
+	ld	(8, sp), a
+	ldw	y, (13, sp)
+	ldw	x, (15, sp)
+	call	00080$
+	ldw	(3, sp), y
+	ldw	(5, sp), x
+	ldw	y, (17, sp)
+	ldw	x, (19, sp)
+	call	00080$
+	jra	00006$
+
+00005$:
+	; exp1 < exp2: mant1 gets aligned, exp1 = exp2
+	neg	a
+	cp	a, #26
+	jrnc	00004$
+	ld	(9, sp), a
+	ld	a, (10, sp)
+	ld	(8, sp), a
+	ldw	y, (17, sp)
+	ldw	x, (19, sp)
+	call	00080$
+	ldw	(3, sp), y
+	ldw	(5, sp), x
+	ldw	y, (13, sp)
+	ldw	x, (15, sp)
+	call	00080$
+
+00006$:
+	; arithmetic shift right of yx, bytewise first
+	ld	a, (9, sp)
+	sub	a, #8
+	jrc	00008$
+00007$:
+	ld	(9, sp), a
+	ld	a, yl
+	rrwa	x
+	ld	a, yh
+	ld	yl, a
+	sll	a
+	clr	a
+	sbc	a, #0
+	ld	yh, a
+	ld	a, (9, sp)
+	sub	a, #8
+	jrnc	00007$
+00008$:
+	add	a, #8
+	jreq	00010$
+00009$:
+	sraw	y
+	rrcw	x
+	dec	a
+	jrne	00009$
+00010$:
+
+	; mant1 += mant2
+	addw	x, (5, sp)
+	jrnc	00011$
+	incw	y
+00011$:
+	addw	y, (3, sp)
+
+	; sign of the result goes to (10)
+	clr	(10, sp)
+	tnzw	y
+	jrpl	00012$
+	cplw	x
+	cplw	y
+	addw	x, #1
+	jrnc	00013$
+	incw	y
+00013$:
+	ld	a, #0x80
+	ld	(10, sp), a
+	jra	00014$
+00012$:
+	jrne	00014$
+	tnzw	x
+	jrne	00014$
+	ret
+
+	; normalize
+00014$:
+	ld	a, yh
+	cp	a, #0x08
+	jrnc	00016$
+	tnz	a
+	jrne	00015$
+	ld	a, yl
+	cp	a, #0x08
+	jrnc	00015$
+	ld	yh, a
+	clr	a
+	rlwa	x
+	ld	yl, a
+	ld	a, (8, sp)
+	sub	a, #8
+	ld	(8, sp), a
+	jrnc	00014$
+	dec	(7, sp)
+	jra	00014$
+00015$:
+	sllw	x
+	rlcw	y
+	ld	a, (8, sp)
+	sub	a, #1
+	ld	(8, sp), a
+	jrnc	00014$
+	dec	(7, sp)
+	jra	00014$
+
+	; round off
+00016$:
+	ld	a, yh
+	and	a, #0xf0
+	jreq	00019$
+	ld	a, xl
+	srl	a
+	jrnc	00017$
+	addw	x, #2
+	jrnc	00017$
+	incw	y
+00017$:
+	srlw	y
+	rrcw	x
+	inc	(8, sp)
+	jrne	00016$
+	inc	(7, sp)
+	jra	00016$
+
+00019$:
+	; turn off hidden bit
+	ld	a, yh
+	and	a, #0xf7
+	ld	yh, a
+	tnz	(7, sp)
+	jrne	00021$
+	; pack up and go home
+	ld	a, #4
+00020$:
+	srlw	y
+	rrcw	x
+	dec	a
+	jrne	00020$
+	ld	a, yl
+	sll	a
+	srl	(8, sp)
+	rrc	a
+	ld	yl, a
+	ld	a, (8, sp)
+	or	a, (10, sp)
+	ld	yh, a
+	ret
+
+00021$:
+	; exponent out of range
+	clrw	x
+	clrw	y
+	tnz	(7, sp)
+	jrmi	00022$
+	ld	a, (10, sp)
+	or	a, #0x7f
+	ld	yh, a
+	ld	a, #0x80
+	ld	yl, a
+00022$:
+	ret
+
+	; unpack float in yx into signed mantissa << 4
+00080$:
+	ld	a, yh
+	push	a
+	ld	a, yl
+	or	a, #0x80
+	ld	yl, a
+	clr	a
+	ld	yh, a
+	sllw	x
+	rlcw	y
+	sllw	x
+	rlcw	y
+	sllw	x
+	rlcw	y
+	sllw	x
+	rlcw	y
+	pop	a
+	tnz	a
+	jrpl	00081$
+	cplw	x
+	cplw	y
+	addw	x, #1
+	jrnc	00081$
+	incw	y
+00081$:
+	ret
+	__endasm;
+}
+
 #else
 
 /*
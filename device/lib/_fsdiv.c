@@ -244,6 +244,374 @@ ___fsdiv:
 	__endasm;
 }
 
+#elif defined(FLOAT_ASM_Z80)
+
+// float __fsdiv (float a1, float a2)
+static void dummy(void) __naked
+{
+	__asm
+	.globl	___fsdiv
+; a1 in hlde, a2 on stack, result in hlde, a2 popped by callee.
+___fsdiv:
+	ld	iy, #2
+	add	iy, sp
+
+	; c = exp2
+	ld	a, 2 (iy)
+	rla
+	ld	a, 3 (iy)
+	rla
+	ld	c, a
+	or	a, a
+	jr	NZ, 00002$
+
+	; a2 is denormal or zero: +inf, -inf or nan depending on a1
+	ld	a, h
+	and	a, #0x7f
+	or	a, l
+	or	a, d
+	or	a, e
+	jr	Z, 00001$
+	ld	a, h
+	and	a, #0x80
+	jp	00081$
+00001$:
+	ld	hl, #0xffc0
+	ld	de, #0
+	jp	00090$
+00002$:
+	; numerator denormal: return 0
+	ld	a, l
+	rla
+	ld	a, h
+	rla
+	or	a, a
+	jp	Z, 00082$
+	ld	b, a
+
+	; sign
+	ld	a, h
+	xor	a, 3 (iy)
+	and	a, #0x80
+	push	af
+
+	; compare mantissas, carry: mant1 < mant2
+	set	7, l
+	ld	a, 2 (iy)
+	or	a, #0x80
+	ld	2 (iy), a
+	ld	a, e
+	sub	a, 0 (iy)
+	ld	a, d
+	sbc	a, 1 (iy)
+	ld	a, l
+	sbc	a, 2 (iy)
+	push	af
+
+	; exp = exp1 - exp2 + EXCESS + (mant1 >= mant2)
+	ccf
+	ld	a, b
+	ld	b, #0
+	adc	a, #126
+	jr	NC, 00003$
+	inc	b
+00003$:
+	sub	a, c
+	jr	NC, 00004$
+	dec	b
+00004$:
+	ld	c, a
+	ld	a, b
+	or	a, a
+	jr	NZ, 00005$
+	or	a, c
+	jr	Z, 00006$
+	inc	a
+	jr	NZ, 00007$
+	; exp >= 255: inf
+00005$:
+	bit	7, b
+	jr	NZ, 00006$
+	pop	af
+	pop	af
+	jr	00081$
+	; exp < 1: 0
+00006$:
+	pop	af
+	pop	af
+	jr	00082$
+
+00007$:
+	ld	3 (iy), c
+
+	; remainder in a:hl, divisor in c:de, quotient bytes pushed via b
+	pop	af
+	ld	a, l
+	ld	h, d
+	ld	l, e
+	ld	c, 2 (iy)
+	ld	d, 1 (iy)
+	ld	e, 0 (iy)
+	jr	NC, 00010$
+	; mant1 < mant2: the first quotient bit (mask 0x1000000) is always 0
+	add	hl, hl
+	adc	a, a
+00010$:
+	ld	0 (iy), #3
+00011$:
+	ld	b, #1
+00012$:
+	jr	C, 00013$
+	sbc	hl, de
+	sbc	a, c
+	jr	NC, 00014$
+	add	hl, de
+	adc	a, c
+	ccf
+	jr	00015$
+00013$:
+	or	a, a
+	sbc	hl, de
+	sbc	a, c
+00014$:
+	scf
+00015$:
+	rl	b
+	jr	C, 00016$
+	add	hl, hl
+	adc	a, a
+	jr	00012$
+00016$:
+	push	bc
+	add	hl, hl
+	adc	a, a
+	dec	0 (iy)
+	jr	NZ, 00011$
+
+	; round: carry if remainder >= mant2
+	jr	C, 00017$
+	sbc	hl, de
+	sbc	a, c
+	ccf
+00017$:
+	pop	bc
+	ld	e, b
+	pop	bc
+	ld	d, b
+	pop	bc
+	ld	l, b
+	jr	NC, 00018$
+	inc	e
+	jr	NZ, 00018$
+	inc	d
+	jr	NZ, 00018$
+	inc	l
+00018$:
+	; pack
+	ld	a, 3 (iy)
+	srl	a
+	jr	C, 00019$
+	res	7, l
+00019$:
+	ld	h, a
+	pop	af
+	or	a, h
+	ld	h, a
+	jr	00090$
+
+00081$:
+	; signed infinity, sign in a
+	or	a, #0x7f
+	ld	h, a
+	ld	l, #0x80
+	ld	de, #0
+	jr	00090$
+
+00082$:
+	ld	hl, #0
+	ld	e, l
+	ld	d, h
+00090$:
+	pop	iy
+	pop	af
+	pop	af
+	jp	(iy)
+	__endasm;
+}
+
+#elif defined(FLOAT_ASM_STM8)
+
+// float __fsdiv (float a1, float a2)
+static void dummy(void) __naked
+{
+	__asm
+	.globl	___fsdiv
+; a1, a2 on stack, result in yx, parameters popped by callee.
+; locals: (1) sign, (2) exponent, (3) mant1 >= mant2, (4) quotient msb, (5, 6) scratch
+; a1 at (9..12), a2 at (13..16), msb first.
+___fsdiv:
+	sub	sp, #6
+
+	; exp2
+	ld	a, (14, sp)
+	sll	a
+	ld	a, (13, sp)
+	rlc	a
+	jrne	00002$
+
+	; a2 is denormal or zero: +inf, -inf or nan depending on a1
+	ld	a, (9, sp)
+	and	a, #0x7f
+	or	a, (10, sp)
+	or	a, (11, sp)
+	or	a, (12, sp)
+	jreq	00001$
+	ld	a, (9, sp)
+	and	a, #0x80
+	jp	00081$
+00001$:
+	ldw	y, #0xffc0
+	clrw	x
+	jp	00090$
+
+00002$:
+	clrw	x
+	ld	xl, a
+	ldw	(5, sp), x
+
+	; numerator denormal: return 0
+	ld	a, (10, sp)
+	sll	a
+	ld	a, (9, sp)
+	rlc	a
+	jrne	00003$
+	jp	00082$
+00003$:
+	ld	(2, sp), a
+
+	; sign
+	ld	a, (9, sp)
+	xor	a, (13, sp)
+	and	a, #0x80
+	ld	(1, sp), a
+
+	; hidden bits, then (3) = mant1 >= mant2
+	ld	a, (10, sp)
+	or	a, #0x80
+	ld	(10, sp), a
+	ld	a, (14, sp)
+	or	a, #0x80
+	ld	(14, sp), a
+	ldw	x, (11, sp)
+	subw	x, (15, sp)
+	ld	a, (10, sp)
+	sbc	a, (14, sp)
+	ccf
+	clr	(3, sp)
+	rlc	(3, sp)
+
+	; exp = exp1 - exp2 + EXCESS + (mant1 >= mant2)
+	clrw	x
+	ld	a, (2, sp)
+	ld	xl, a
+	addw	x, #126
+	subw	x, (5, sp)
+	tnz	(3, sp)
+	jreq	00004$
+	incw	x
+00004$:
+	tnzw	x
+	jrsgt	00005$
+	jp	00082$
+00005$:
+	cpw	x, #255
+	jrslt	00006$
+	ld	a, (1, sp)
+	jp	00081$
+00006$:
+	ld	a, xl
+	ld	(2, sp), a
+
+	; remainder in a:x, divisor at (14..16), quotient in (4):y
+	ld	a, #24
+	ld	(5, sp), a
+	ld	a, (10, sp)
+	ldw	x, (11, sp)
+	tnz	(3, sp)
+	jrne	00007$
+	; mant1 < mant2: the first quotient bit (mask 0x1000000) is always 0
+	sllw	x
+	rlc	a
+	jra	00008$
+00007$:
+	rcf
+00008$:
+	jrc	00009$
+	subw	x, (15, sp)
+	sbc	a, (14, sp)
+	jrnc	00010$
+	addw	x, (15, sp)
+	adc	a, (14, sp)
+	rcf
+	jra	00011$
+00009$:
+	subw	x, (15, sp)
+	sbc	a, (14, sp)
+00010$:
+	scf
+00011$:
+	rlcw	y
+	rlc	(4, sp)
+	sllw	x
+	rlc	a
+	dec	(5, sp)
+	jrne	00008$
+
+	; round: carry if remainder >= mant2
+	jrc	00012$
+	subw	x, (15, sp)
+	sbc	a, (14, sp)
+	ccf
+	jrnc	00013$
+00012$:
+	incw	y
+	jrne	00013$
+	inc	(4, sp)
+00013$:
+	; pack
+	sll	(4, sp)
+	srl	(2, sp)
+	rrc	(4, sp)
+	ld	a, (2, sp)
+	or	a, (1, sp)
+	ldw	x, y
+	ld	yh, a
+	ld	a, (4, sp)
+	ld	yl, a
+	jra	00090$
+
+00081$:
+	; signed infinity, sign in a
+	or	a, #0x7f
+	ld	yh, a
+	ld	a, #0x80
+	ld	yl, a
+	clrw	x
+	jra	00090$
+
+00082$:
+	clrw	x
+	clrw	y
+00090$:
+	ld	a, (7, sp)
+	ld	(15, sp), a
+	ld	a, (8, sp)
+	ld	(16, sp), a
+	addw	sp, #14
+	ret
+	__endasm;
+}
+
 #else
 
 /*
@@ -78,6 +78,143 @@ skip_invert:
 	__endasm;
 }
 
+#elif defined(FLOAT_ASM_Z80)
+
+// _Bool __fslt (float a1, float a2)
+static void dummy(void) __naked
+{
+	__asm
+	.globl	___fslt
+; a1 in hlde, a2 on stack, result in a, a2 popped by callee.
+___fslt:
+	ld	iy, #2
+	add	iy, sp
+
+	; +0 and -0 compare equal
+	ld	a, h
+	or	a, 3 (iy)
+	and	a, #0x7f
+	or	a, l
+	or	a, d
+	or	a, e
+	or	a, 2 (iy)
+	or	a, 1 (iy)
+	or	a, 0 (iy)
+	jr	Z, 00003$
+
+	; different signs: a1 < a2 iff a1 is negative
+	ld	a, h
+	xor	a, 3 (iy)
+	jp	P, 00001$
+	ld	a, h
+	rlca
+	and	a, #0x01
+	jr	00003$
+
+00001$:
+	bit	7, h
+	jr	NZ, 00002$
+	; both positive: unsigned a1 < a2
+	ld	a, e
+	sub	a, 0 (iy)
+	ld	a, d
+	sbc	a, 1 (iy)
+	ld	a, l
+	sbc	a, 2 (iy)
+	ld	a, h
+	sbc	a, 3 (iy)
+	ld	a, #0
+	rla
+	jr	00003$
+
+00002$:
+	; both negative: unsigned a2 < a1
+	ld	a, 0 (iy)
+	sub	a, e
+	ld	a, 1 (iy)
+	sbc	a, d
+	ld	a, 2 (iy)
+	sbc	a, l
+	ld	a, 3 (iy)
+	sbc	a, h
+	ld	a, #0
+	rla
+
+00003$:
+	pop	iy
+	pop	bc
+	pop	bc
+	jp	(iy)
+	__endasm;
+}
+
+#elif defined(FLOAT_ASM_STM8)
+
+// _Bool __fslt (float a1, float a2)
+static void dummy(void) __naked
+{
+	__asm
+	.globl	___fslt
+; a1, a2 on stack, result in a, parameters popped by callee.
+___fslt:
+	; +0 and -0 compare equal
+	ld	a, (3, sp)
+	or	a, (7, sp)
+	and	a, #0x7f
+	or	a, (4, sp)
+	or	a, (5, sp)
+	or	a, (6, sp)
+	or	a, (8, sp)
+	or	a, (9, sp)
+	or	a, (10, sp)
+	jreq	00003$
+
+	; different signs: a1 < a2 iff a1 is negative
+	ld	a, (3, sp)
+	xor	a, (7, sp)
+	jrpl	00001$
+	ld	a, (3, sp)
+	sll	a
+	jra	00004$
+
+00001$:
+	tnz	(3, sp)
+	jrmi	00002$
+	; both positive: unsigned a1 < a2
+	ld	a, (6, sp)
+	sub	a, (10, sp)
+	ld	a, (5, sp)
+	sbc	a, (9, sp)
+	ld	a, (4, sp)
+	sbc	a, (8, sp)
+	ld	a, (3, sp)
+	sbc	a, (7, sp)
+	jra	00004$
+
+00002$:
+	; both negative: unsigned a2 < a1
+	ld	a, (10, sp)
+	sub	a, (6, sp)
+	ld	a, (9, sp)
+	sbc	a, (5, sp)
+	ld	a, (8, sp)
+	sbc	a, (4, sp)
+	ld	a, (7, sp)
+	sbc	a, (3, sp)
+	jra	00004$
+
+00003$:
+	rcf
+00004$:
+	clr	a
+	rlc	a
+	ldw	x, (1, sp)
+	ldw	(9, sp), x
+	addw	sp, #8
+	ret
+	__endasm;
+}
+
 #else
 
 /*
@@ -211,6 +211,404 @@ ___fsmul:
 	__endasm;
 }
 
+#elif defined(FLOAT_ASM_Z80)
+
+// float __fsmul (float a1, float a2)
+static void dummy(void) __naked
+{
+	__asm
+	.globl	___fsmul
+; a1 in hlde, a2 on stack, result in hlde, a2 popped by callee.
+___fsmul:
+	ld	iy, #2
+	add	iy, sp
+
+	; if (!a1 || !a2) return 0
+	ld	a, h
+	or	a, l
+	or	a, d
+	or	a, e
+	jp	Z, 00090$
+	ld	a, 0 (iy)
+	or	a, 1 (iy)
+	or	a, 2 (iy)
+	or	a, 3 (iy)
+	jp	Z, 00090$
+
+	; sign = SIGN (a1) ^ SIGN (a2)
+	ld	a, h
+	xor	a, 3 (iy)
+	push	af
+
+	; exp = EXP (a1) - EXCESS + EXP (a2), kept 16 bit
+	ld	a, 2 (iy)
+	rla
+	ld	a, 3 (iy)
+	rla
+	ld	c, a
+	ld	a, l
+	rla
+	ld	a, h
+	rla
+	add	a, c
+	ld	c, a
+	ld	a, #0
+	adc	a, a
+	ld	b, a
+	ld	a, c
+	sub	a, #126
+	ld	c, a
+	jr	NC, 00001$
+	dec	b
+00001$:
+	push	bc
+
+	; m1 = l:d:e, m2 = 2(iy):1(iy):0(iy), both with hidden bit
+	set	7, l
+	ld	b, l
+	ld	c, d
+
+	; (m2 & 0xff) * (m1 >> 8) >> 8
+	ld	a, 0 (iy)
+	call	00080$
+	push	hl
+
+	; (m1 & 0xff) * (m2 >> 8) >> 8
+	push	bc
+	ld	a, 2 (iy)
+	or	a, #0x80
+	ld	b, a
+	ld	c, 1 (iy)
+	ld	a, e
+	call	00080$
+	ld	d, b
+	ld	e, c
+	pop	bc
+	push	hl
+
+	; (m1 >> 8) * (m2 >> 8), 16 x 16 -> 32 bit into dehl
+	ld	hl, #0
+	ld	a, #16
+00002$:
+	add	hl, hl
+	rl	e
+	rl	d
+	jr	NC, 00003$
+	add	hl, bc
+	jr	NC, 00003$
+	inc	de
+00003$:
+	dec	a
+	jr	NZ, 00002$
+
+	; add both partial products and round, phase 1
+	pop	bc
+	add	hl, bc
+	jr	NC, 00004$
+	inc	de
+00004$:
+	pop	bc
+	add	hl, bc
+	jr	NC, 00005$
+	inc	de
+00005$:
+	ld	bc, #0x40
+	add	hl, bc
+	jr	NC, 00006$
+	inc	de
+00006$:
+	pop	bc
+	bit	7, d
+	jr	Z, 00007$
+
+	; round, phase 2 and shift right by 8: result in d:e:h
+	ld	a, l
+	add	a, #0x40
+	jr	NC, 00008$
+	inc	h
+	jr	NZ, 00008$
+	inc	de
+	jr	00008$
+00007$:
+	; shift right by 7: result in d:e:h
+	sla	l
+	rl	h
+	rl	e
+	rl	d
+	dec	bc
+00008$:
+	; pack: exponent in bc, sign in bit 7 of the saved a
+	ld	a, b
+	or	a, a
+	jr	NZ, 00010$
+	ld	a, d
+	add	a, a
+	srl	c
+	rra
+	ld	d, a
+	pop	af
+	and	a, #0x80
+	or	a, c
+	ld	c, a
+	ld	a, h
+	ld	h, c
+	ld	l, d
+	ld	d, e
+	ld	e, a
+	jr	00092$
+
+00010$:
+	; exponent out of range
+	pop	af
+	bit	7, b
+	jr	NZ, 00090$
+	and	a, #0x80
+	or	a, #0x7f
+	ld	h, a
+	ld	l, #0x80
+	ld	de, #0
+	jr	00092$
+
+00090$:
+	ld	hl, #0
+	ld	e, l
+	ld	d, h
+00092$:
+	pop	iy
+	pop	af
+	pop	af
+	jp	(iy)
+
+	; a * bc -> a:hl, return (a:hl) >> 8 in hl
+00080$:
+	ld	hl, #0
+	ld	d, #8
+00081$:
+	add	hl, hl
+	rla
+	jr	NC, 00082$
+	add	hl, bc
+	adc	a, #0
+00082$:
+	dec	d
+	jr	NZ, 00081$
+	ld	l, h
+	ld	h, a
+	ret
+	__endasm;
+}
+
+#elif defined(FLOAT_ASM_STM8)
+
+// float __fsmul (float a1, float a2)
+static void dummy(void) __naked
+{
+	__asm
+	.globl	___fsmul
+; a1, a2 on stack, result in yx, parameters popped by callee.
+; locals: (1) sign, (2, 3) exponent, (4..7) product, (8) scratch
+; a1 at (11..14), a2 at (15..18), msb first.
+___fsmul:
+	sub	sp, #8
+
+	; if (!a1 || !a2) return 0
+	ldw	x, (11, sp)
+	jrne	00001$
+	ldw	x, (13, sp)
+	jrne	00001$
+	jp	00020$
+00001$:
+	ldw	x, (15, sp)
+	jrne	00002$
+	ldw	x, (17, sp)
+	jrne	00002$
+	jp	00020$
+00002$:
+
+	; sign
+	ld	a, (11, sp)
+	xor	a, (15, sp)
+	and	a, #0x80
+	ld	(1, sp), a
+
+	; exp = EXP (a1) - EXCESS + EXP (a2)
+	ld	a, (16, sp)
+	sll	a
+	ld	a, (15, sp)
+	rlc	a
+	ld	(8, sp), a
+	ld	a, (12, sp)
+	sll	a
+	ld	a, (11, sp)
+	rlc	a
+	add	a, (8, sp)
+	clrw	x
+	ld	xl, a
+	clr	a
+	adc	a, #0
+	ld	xh, a
+	subw	x, #126
+	ldw	(2, sp), x
+
+	; hidden bits
+	ld	a, (12, sp)
+	or	a, #0x80
+	ld	(12, sp), a
+	ld	a, (16, sp)
+	or	a, #0x80
+	ld	(16, sp), a
+
+	; (m1 >> 8) * (m2 >> 8)
+	ld	a, (12, sp)
+	ld	xl, a
+	ld	a, (16, sp)
+	mul	x, a
+	ldw	(4, sp), x
+	ld	a, (13, sp)
+	ld	xl, a
+	ld	a, (17, sp)
+	mul	x, a
+	ldw	(6, sp), x
+	ld	a, (12, sp)
+	ld	xl, a
+	ld	a, (17, sp)
+	mul	x, a
+	addw	x, (5, sp)
+	ldw	(5, sp), x
+	jrnc	00003$
+	inc	(4, sp)
+00003$:
+	ld	a, (13, sp)
+	ld	xl, a
+	ld	a, (16, sp)
+	mul	x, a
+	addw	x, (5, sp)
+	ldw	(5, sp), x
+	jrnc	00004$
+	inc	(4, sp)
+00004$:
+
+	; + ((m1 & 0xff) * (m2 >> 8)) >> 8
+	ld	a, (14, sp)
+	ld	xl, a
+	ld	a, (17, sp)
+	mul	x, a
+	ld	a, xh
+	ld	(8, sp), a
+	ld	a, (14, sp)
+	ld	xl, a
+	ld	a, (16, sp)
+	mul	x, a
+	ld	a, xl
+	add	a, (8, sp)
+	ld	xl, a
+	ld	a, xh
+	adc	a, #0
+	ld	xh, a
+	addw	x, (6, sp)
+	ldw	(6, sp), x
+	jrnc	00005$
+	ldw	x, (4, sp)
+	incw	x
+	ldw	(4, sp), x
+00005$:
+
+	; + ((m2 & 0xff) * (m1 >> 8)) >> 8
+	ld	a, (18, sp)
+	ld	xl, a
+	ld	a, (13, sp)
+	mul	x, a
+	ld	a, xh
+	ld	(8, sp), a
+	ld	a, (18, sp)
+	ld	xl, a
+	ld	a, (12, sp)
+	mul	x, a
+	ld	a, xl
+	add	a, (8, sp)
+	ld	xl, a
+	ld	a, xh
+	adc	a, #0
+	ld	xh, a
+	addw	x, (6, sp)
+	jrnc	00006$
+	ldw	y, (4, sp)
+	incw	y
+	ldw	(4, sp), y
+00006$:
+
+	; round, phase 1
+	addw	x, #0x40
+	ldw	(6, sp), x
+	jrnc	00007$
+	ldw	x, (4, sp)
+	incw	x
+	ldw	(4, sp), x
+00007$:
+	tnz	(4, sp)
+	jrpl	00008$
+
+	; round, phase 2, result >>= 8
+	ld	a, (7, sp)
+	add	a, #0x40
+	jrnc	00009$
+	ldw	x, (5, sp)
+	incw	x
+	ldw	(5, sp), x
+	jrne	00009$
+	inc	(4, sp)
+	jra	00009$
+
+00008$:
+	; result >>= 7, exp--
+	sll	(7, sp)
+	rlc	(6, sp)
+	rlc	(5, sp)
+	rlc	(4, sp)
+	ldw	x, (2, sp)
+	decw	x
+	ldw	(2, sp), x
+
+00009$:
+	; pack: mantissa in (4..6)
+	tnz	(2, sp)
+	jrne	00010$
+	sll	(4, sp)
+	ld	a, (3, sp)
+	srl	a
+	rrc	(4, sp)
+	or	a, (1, sp)
+	ld	yh, a
+	ld	a, (4, sp)
+	ld	yl, a
+	ldw	x, (5, sp)
+	jra	00021$
+
+00010$:
+	; exponent out of range
+	tnz	(2, sp)
+	jrmi	00020$
+	ld	a, (1, sp)
+	or	a, #0x7f
+	ld	yh, a
+	ld	a, #0x80
+	ld	yl, a
+	clrw	x
+	jra	00021$
+
+00020$:
+	clrw	x
+	clrw	y
+00021$:
+	ld	a, (9, sp)
+	ld	(17, sp), a
+	ld	a, (10, sp)
+	ld	(18, sp), a
+	addw	sp, #16
+	ret
+	__endasm;
+}
+
 #else
 
 /*
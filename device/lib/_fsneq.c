@@ -50,6 +50,93 @@ ___fsneq:
 	__endasm;
 }
 
+#elif defined(FLOAT_ASM_Z80)
+
+// _Bool __fsneq (float a1, float a2)
+static void dummy(void) __naked
+{
+	__asm
+	.globl	___fsneq
+; a1 in hlde, a2 on stack, result in a, a2 popped by callee.
+___fsneq:
+	ld	iy, #2
+	add	iy, sp
+
+	ld	a, e
+	cp	a, 0 (iy)
+	jr	NZ, 00001$
+	ld	a, d
+	cp	a, 1 (iy)
+	jr	NZ, 00001$
+	ld	a, l
+	cp	a, 2 (iy)
+	jr	NZ, 00001$
+	ld	a, h
+	cp	a, 3 (iy)
+	jr	Z, 00002$
+00001$:
+	; +0 and -0 compare equal
+	ld	a, h
+	or	a, 3 (iy)
+	and	a, #0x7f
+	or	a, l
+	or	a, d
+	or	a, e
+	or	a, 2 (iy)
+	or	a, 1 (iy)
+	or	a, 0 (iy)
+	jr	Z, 00002$
+	ld	a, #1
+	jr	00003$
+00002$:
+	xor	a, a
+00003$:
+	pop	iy
+	pop	bc
+	pop	bc
+	jp	(iy)
+	__endasm;
+}
+
+#elif defined(FLOAT_ASM_STM8)
+
+// _Bool __fsneq (float a1, float a2)
+static void dummy(void) __naked
+{
+	__asm
+	.globl	___fsneq
+; a1, a2 on stack, result in a, parameters popped by callee.
+___fsneq:
+	ldw	x, (3, sp)
+	cpw	x, (7, sp)
+	jrne	00001$
+	ldw	x, (5, sp)
+	cpw	x, (9, sp)
+	jreq	00002$
+00001$:
+	; +0 and -0 compare equal
+	ld	a, (3, sp)
+	or	a, (7, sp)
+	and	a, #0x7f
+	or	a, (4, sp)
+	or	a, (5, sp)
+	or	a, (6, sp)
+	or	a, (8, sp)
+	or	a, (9, sp)
+	or	a, (10, sp)
+	jreq	00002$
+	ld	a, #1
+	jra	00003$
+00002$:
+	clr	a
+00003$:
+	ldw	x, (1, sp)
+	ldw	(9, sp), x
+	addw	sp, #8
+	ret
+	__endasm;
+}
+
 #else
 
 /*
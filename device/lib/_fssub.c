@@ -49,6 +49,59 @@ ___fssub:
 	__endasm;
 }
 
+#elif defined(FLOAT_ASM_Z80)
+
+// float __fssub (float a1, float a2)
+static void dummy(void) __naked
+{
+	__asm
+	.globl	___fssub
+
+; computed as -((-a1) + a2) like the C version
+___fssub:
+	ld	a, h
+	xor	a, #0x80
+	ld	h, a
+	ld	iy, #2
+	add	iy, sp
+	call	fsadd_core
+	ld	a, h
+	xor	a, #0x80
+	ld	h, a
+	pop	iy
+	pop	af
+	pop	af
+	jp	(iy)
+	__endasm;
+}
+
+#elif defined(FLOAT_ASM_STM8)
+
+// float __fssub (float a1, float a2)
+static void dummy(void) __naked
+{
+	__asm
+	.globl	___fssub
+
+; computed as -((-a1) + a2) like the C version
+___fssub:
+	ld	a, (3, sp)
+	xor	a, #0x80
+	ld	(3, sp), a
+	sub	sp, #8
+	call	fsadd_core
+	ld	a, yh
+	xor	a, #0x80
+	ld	yh, a
+	ld	a, (9, sp)
+	ld	(17, sp), a
+	ld	a, (10, sp)
+	ld	(18, sp), a
+	addw	sp, #16
+	ret
+	__endasm;
+}
+
 #else
 
 /*
@@ -54,6 +54,97 @@ long2fs_doit:
 	__endasm;
 }
 
+#elif defined(FLOAT_ASM_Z80)
+
+// float __ulong2fs (unsigned long a)
+static void dummy(void) __naked
+{
+	__asm
+	.globl	___ulong2fs
+; a in hlde, result in hlde.
+___ulong2fs:
+	ld	a, h
+	or	a, l
+	or	a, d
+	or	a, e
+	ret	Z
+
+	; 0xffffffff would overflow the rounding below
+	ld	a, h
+	and	a, l
+	and	a, d
+	and	a, e
+	inc	a
+	jr	NZ, 00001$
+	ld	hl, #0x4f80
+	ld	e, a
+	ld	d, a
+	ret
+
+00001$:
+	ld	c, #150
+
+	; normalize small values, bytewise first
+	ld	a, h
+	or	a, a
+	jr	NZ, 00004$
+00002$:
+	or	a, l
+	jr	NZ, 00003$
+	ld	a, d
+	cp	a, #0x80
+	jr	NC, 00003$
+	ld	l, d
+	ld	d, e
+	ld	e, #0
+	ld	a, c
+	sub	a, #8
+	ld	c, a
+	xor	a, a
+	jr	00002$
+00003$:
+	bit	7, l
+	jr	NZ, 00006$
+	sla	e
+	rl	d
+	rl	l
+	dec	c
+	jr	00003$
+
+	; reduce large values to 24 bits, rounding on the way
+00004$:
+	bit	0, e
+	jr	Z, 00005$
+	ld	a, e
+	add	a, #2
+	ld	e, a
+	jr	NC, 00005$
+	inc	d
+	jr	NZ, 00005$
+	inc	l
+	jr	NZ, 00005$
+	inc	h
+00005$:
+	srl	h
+	rr	l
+	rr	d
+	rr	e
+	inc	c
+	ld	a, h
+	or	a, a
+	jr	NZ, 00004$
+
+	; pack: hidden bit is replaced by the exponent lsb
+00006$:
+	srl	c
+	jr	C, 00007$
+	res	7, l
+00007$:
+	ld	h, c
+	ret
+	__endasm;
+}
+
 #else
 
 /*
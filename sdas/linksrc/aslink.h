@@ -282,6 +282,12 @@ extern	int	ASxxxx_VERSION;
 /* Additional flags for hc08 */
 #define A_NOLOAD  0400          /* nonloadable */
 #define A_LOAD    0000          /* loadable (default) */
+
+/* Section flags for --gc-areas and --merge-strings */
+#define A_GCSPLIT 01            /* section split off by the compiler */
+#define A_GCMARK  02            /* section reached from the roots */
+#define A_GCDEAD  04            /* section removed */
+#define A_STRING  010           /* literal string split off by the compiler */
 /* end sdld specific */
 
 /*
@@ -694,8 +700,31 @@ struct  areax
         struct  head    *a_bhp; /* Base header link */
         a_uint  a_addr;         /* Beginning address of section */
         a_uint  a_size;         /* Size of the area in section */
+/* sdld specific */
+        int     a_gcflg;        /* --gc-areas flags */
+        struct  gcref   *a_gcref; /* References from this section */
+        char    *a_text;        /* --merge-strings, contents of the section */
+        a_uint  a_tsize;        /* Number of bytes of a_text read */
+        struct  areax   *a_mrgp; /* Identical section linked instead */
+/* end sdld specific */
 };
 
+/* sdld specific */
+/*
+ *      With --gc-areas a gcref structure is created for every
+ *      area or symbol reference found in the R lines of the
+ *      first pass.  The referenced section is either given
+ *      directly or is the one the symbol is defined in, which
+ *      may only be known once all REL files have been read.
+ */
+struct  gcref
+{
+        struct  gcref   *r_next; /* Reference link */
+        struct  areax   *r_axp; /* Referenced section */
+        struct  sym     *r_sp;  /* Referenced symbol */
+};
+/* end sdld specific */
+
 /*
  *      A sym structure is created for every unique symbol
  *      referenced/defined while reading the REL files.  The
@@ -1125,6 +1154,15 @@ extern  long code_size;         /*      code size
                                  */
 extern  char *sdld_output;      /*      output file name, --output argument
                                  */
+extern  int     gcflag;         /*      --gc-areas, remove unreachable
+                                 *      split sections
+                                 */
+extern  struct  globl   *keepp; /*      The pointer to the first --keep
+                                 *      symbol string
+                                 */
+extern  int     mergeflag;      /*      --merge-strings, link identical
+                                 *      literal strings only once
+                                 */
 extern char *optsdcc;
 extern char *optsdcc_module;
 /* sdld 8015 specific */
@@ -1162,6 +1200,7 @@ extern  VOID            bassav(void);
 extern  int             fndidx(char *str);
 extern  int             fndext(char *str);
 extern  VOID            gblsav(void);
+extern  VOID            lngopt(void);
 extern  int             intsiz(void);
 extern  VOID            iramsav(void);
 extern  VOID            xramsav(void);
@@ -1194,6 +1233,11 @@ extern  VOID            skip(int c);
 extern  VOID            unget(int c);
 
 /* lkarea.c */
+extern  VOID            gcareas(void);
+extern  VOID            gcrel(int c);
+extern  VOID            mrgaddr(void);
+extern  VOID            mrgareas(void);
+extern  VOID            mrgrel(int c);
 extern  VOID            lkparea(char *id);
 extern  VOID            lnkarea(void);
 extern  VOID            lnkarea2(void);
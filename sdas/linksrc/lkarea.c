@@ -35,6 +35,11 @@
  *      from the .rel file(s).
  *
  *      lkarea.c contains the following functions:
+ *              VOID    gcareas()
+ *              VOID    gcrel()
+ *              VOID    mrgaddr()
+ *              VOID    mrgareas()
+ *              VOID    mrgrel()
  *              VOID    lnkarea()
  *              VOID    lnksect()
  *              VOID    lkparea()
@@ -74,6 +79,8 @@
  *              char    id[]            id string
  *              int     k               counter, loop variable
  *              int     narea           number of areas in this head structure
+ *              char *  p               position of the split suffix
+ *              int     split           section split off by the compiler
  *              areax * taxp            pointer to an areax structure
  *                                      to areax structures
  *
@@ -121,7 +128,8 @@ newarea(void)
         int k, narea;
         struct areax *taxp;
         struct areax **halp;
-        char id[NCPS];
+        char id[NCPS], *p;
+        int split;
 
         if (headp == NULL) {
                 fprintf(stderr, "No header defined\n");
@@ -131,7 +139,26 @@ newarea(void)
          * Create Area entry
          */
         getid(id, -1);
+        /* sdld specific */
+        /*
+         * A section the compiler split off as NAME.suffix
+         * is linked as part of area NAME.
+         */
+        split = (id[0] != '.') && (p = strchr(id, '.')) != NULL;
+        if (split)
+                *p = '\0';
         lkparea(id);
+        if (split) {
+                axp->a_gcflg = A_GCSPLIT;
+                /*
+                 * The literal strings are named __str_n,
+                 * with the usual prefix of the port.
+                 */
+                k = (int) strspn(p + 1, "_");
+                if (k >= 2 && !strncmp(p + 1 + k, "str_", 4))
+                        axp->a_gcflg |= A_STRING;
+        }
+        /* end sdld specific */
         /*
          * Evaluate area size
          */
@@ -777,6 +804,422 @@ setarea(void)
 
 
 /* sdld specific */
+/*)Function     VOID    gcrel(c)
+ *
+ *              int     c               R or P line type
+ *
+ *      The function gcrel() records the references an R line
+ *      makes from its section during the first pass, for use
+ *      by gcareas().  The line format is described in relr3().
+ *      As the base page of a P line is only known from its T
+ *      line, a P line keeps all sections of its module instead.
+ *
+ *      local variables:
+ *              areax   **a             pointer to array of area pointers
+ *              int     aindex          area index
+ *              int     k               loop counter
+ *              int     mode            relocation mode
+ *              gcref   *rp             pointer to a gcref structure
+ *              int     rindex          symbol / area index
+ *              sym     **s             pointer to array of symbol pointers
+ *
+ *      global variables:
+ *              head    *hp             Pointer to the current
+ *                                      head structure
+ *
+ *      functions called:
+ *              int     eval()          lkeval.c
+ *              a_uint  evword()        lkrloc.c
+ *              int     more()          lklex.c
+ *              VOID *  new()           lksym.c
+ *
+ *      side effects:
+ *              gcref structures are linked to the section.
+ *              Malformed lines are left for the second pass
+ *              to report.
+ */
+
+VOID
+gcrel(int c)
+{
+        struct areax **a;
+        struct sym **s;
+        struct gcref *rp;
+        int aindex, rindex, mode, k;
+
+        a = hp->a_list;
+        s = hp->s_list;
+
+        if (eval() != (R3_WORD | R3_AREA) || eval())
+                return;
+        aindex = (int) evword();
+        if (aindex >= hp->h_narea)
+                return;
+
+        if (c == 'P') {
+                for (k = 0; k < hp->h_narea; k++) {
+                        if (a[k])
+                                a[k]->a_gcflg &= ~A_GCSPLIT;
+                }
+                return;
+        }
+
+        while (more()) {
+                mode = (int) eval();
+                if ((mode & R_ESCAPE_MASK) == R_ESCAPE_MASK)
+                        mode = ((mode & ~R_ESCAPE_MASK) << 8) | eval();
+                eval();
+                rindex = (int) evword();
+
+                if (mode & R3_SYM) {
+                        if (rindex >= hp->h_nsym)
+                                return;
+                } else if (rindex >= hp->h_narea) {
+                        /* absolute acall/ajmp address */
+                        continue;
+                }
+
+                rp = (struct gcref *) new (sizeof (struct gcref));
+                if (mode & R3_SYM)
+                        rp->r_sp = s[rindex];
+                else
+                        rp->r_axp = a[rindex];
+                rp->r_next = a[aindex]->a_gcref;
+                a[aindex]->a_gcref = rp;
+        }
+}
+
+/*)Function     VOID    gcareas()
+ *
+ *      The function gcareas() removes the sections split off by
+ *      the compiler that nothing else needs.  Starting from every
+ *      section that was not split off (this includes the startup
+ *      code and the interrupt vectors) and from the sections that
+ *      define the --keep symbols, all sections reachable through
+ *      the recorded references are marked.  The remaining split
+ *      sections get size zero, so lnkarea() skips them, and their
+ *      data is not output in the second pass.
+ *
+ *      local variables:
+ *              int     n               number of sections
+ *              int     sp              stack pointer
+ *              areax   **stack         sections still to visit
+ *              area    *tap            pointer to an area structure
+ *              areax   *taxp           pointer to an areax structure
+ *              gcref   *rp             pointer to a gcref structure
+ *              sym     *tsp            pointer to a symbol structure
+ *              globl   *kp             pointer to a --keep string
+ *
+ *      global variables:
+ *              area    *areap          The pointer to the first
+ *                                      area structure of a linked list
+ *              globl   *keepp          The pointer to the first
+ *                                      --keep symbol string
+ *
+ *      functions called:
+ *              int     fprintf()       c_library
+ *              VOID    free()          c_library
+ *              sym *   lkpsym()        lksym.c
+ *              VOID *  malloc()        c_library
+ *
+ *      side effects:
+ *              Unreachable split sections are removed.
+ */
+
+VOID
+gcareas(void)
+{
+        struct area *tap;
+        struct areax *taxp, **stack;
+        struct gcref *rp;
+        struct sym *tsp;
+        struct globl *kp;
+        int n, sp;
+
+        n = 0;
+        for (tap = areap; tap; tap = tap->a_ap)
+                for (taxp = tap->a_axp; taxp; taxp = taxp->a_axp)
+                        n++;
+        if ((stack = (struct areax **) malloc ((n + 1) * sizeof (struct areax *))) == NULL) {
+                fprintf(stderr, "Insufficient space for --gc-areas.\n");
+                lkexit(ER_FATAL);
+        }
+
+        /*
+         * Roots
+         */
+        sp = 0;
+        for (tap = areap; tap; tap = tap->a_ap) {
+                for (taxp = tap->a_axp; taxp; taxp = taxp->a_axp) {
+                        if (!(taxp->a_gcflg & A_GCSPLIT)) {
+                                taxp->a_gcflg |= A_GCMARK;
+                                stack[sp++] = taxp;
+                        }
+                }
+        }
+        for (kp = keepp; kp; kp = kp->g_globl) {
+                tsp = lkpsym(kp->g_strp, 0);
+                if (tsp == NULL || tsp->s_axp == NULL) {
+                        fprintf(stderr,
+                                "ASlink-Warning-No definition of kept symbol %s\n", kp->g_strp);
+                        continue;
+                }
+                if (!(tsp->s_axp->a_gcflg & A_GCMARK)) {
+                        tsp->s_axp->a_gcflg |= A_GCMARK;
+                        stack[sp++] = tsp->s_axp;
+                }
+        }
+
+        /*
+         * Mark everything reachable
+         */
+        while (sp) {
+                for (rp = stack[--sp]->a_gcref; rp; rp = rp->r_next) {
+                        taxp = rp->r_sp ? rp->r_sp->s_axp : rp->r_axp;
+                        if (taxp && !(taxp->a_gcflg & A_GCMARK)) {
+                                taxp->a_gcflg |= A_GCMARK;
+                                stack[sp++] = taxp;
+                        }
+                }
+        }
+        free(stack);
+
+        /*
+         * Remove the rest
+         */
+        for (tap = areap; tap; tap = tap->a_ap) {
+                for (taxp = tap->a_axp; taxp; taxp = taxp->a_axp) {
+                        if (!(taxp->a_gcflg & A_GCMARK)) {
+                                taxp->a_gcflg |= A_GCDEAD;
+                                taxp->a_size = 0;
+                        }
+                }
+        }
+}
+
+/*)Function     VOID    mrgrel(c)
+ *
+ *              int     c               T, R or P line type
+ *
+ *      The function mrgrel() saves the contents of the literal
+ *      strings split off by the compiler during the first pass,
+ *      for use by mrgareas().  The data of a T line is kept in
+ *      rtval[] until the R line names its section.  A literal
+ *      string with relocations, or in a module with P lines,
+ *      is not merged.
+ *
+ *      local variables:
+ *              areax   **a             pointer to array of area pointers
+ *              int     aindex          area index
+ *              int     k               loop counter
+ *              int     n               number of data bytes
+ *              a_uint  offset          offset of the data in the section
+ *              areax   *taxp           pointer to an areax structure
+ *
+ *      global variables:
+ *              head    *hp             Pointer to the current
+ *                                      head structure
+ *              int     a_bytes         T line address bytes
+ *              int     rtcnt           count of rtval[] elements
+ *              a_uint  rtval[]         T line data
+ *
+ *      functions called:
+ *              a_uint  adb_xb()        lkrloc.c
+ *              int     eval()          lkeval.c
+ *              a_uint  evword()        lkrloc.c
+ *              VOID *  malloc()        c_library
+ *              int     more()          lklex.c
+ *              VOID    relt3()         lkrloc3.c
+ *
+ *      side effects:
+ *              The contents are saved in the section.
+ */
+
+VOID
+mrgrel(int c)
+{
+        struct areax **a, *taxp;
+        a_uint offset;
+        int aindex, k, n;
+
+        if (c == 'T') {
+                relt3();
+                return;
+        }
+
+        a = hp->a_list;
+
+        if (eval() != (R3_WORD | R3_AREA) || eval())
+                return;
+        aindex = (int) evword();
+        if (aindex >= hp->h_narea)
+                return;
+
+        if (c == 'P') {
+                for (k = 0; k < hp->h_narea; k++) {
+                        if (a[k])
+                                a[k]->a_gcflg &= ~A_STRING;
+                }
+                return;
+        }
+
+        taxp = a[aindex];
+        if (!(taxp->a_gcflg & A_STRING))
+                return;
+        n = rtcnt - a_bytes;
+        if (more() || n < 0) {
+                taxp->a_gcflg &= ~A_STRING;
+                return;
+        }
+        offset = adb_xb(0, 0);
+        if (offset + n > taxp->a_size) {
+                taxp->a_gcflg &= ~A_STRING;
+                return;
+        }
+        if (taxp->a_text == NULL &&
+            (taxp->a_text = (char *) malloc(taxp->a_size)) == NULL) {
+                taxp->a_gcflg &= ~A_STRING;
+                return;
+        }
+        for (k = 0; k < n; k++)
+                taxp->a_text[offset + k] = (char) rtval[a_bytes + k];
+        taxp->a_tsize += n;
+}
+
+/*
+ *      Order of the literal strings for mrgareas(): by area,
+ *      size and contents, the first one read first.
+ */
+struct mrgitem {
+        struct  areax   *m_axp;
+        int     m_seq;
+};
+
+static int
+mrgcmp(const void *p1, const void *p2)
+{
+        const struct mrgitem *m1 = (const struct mrgitem *) p1;
+        const struct mrgitem *m2 = (const struct mrgitem *) p2;
+        int r;
+
+        if (m1->m_axp->a_bap != m2->m_axp->a_bap)
+                return m1->m_axp->a_bap < m2->m_axp->a_bap ? -1 : 1;
+        if (m1->m_axp->a_size != m2->m_axp->a_size)
+                return m1->m_axp->a_size < m2->m_axp->a_size ? -1 : 1;
+        r = memcmp(m1->m_axp->a_text, m2->m_axp->a_text, m1->m_axp->a_size);
+        return r ? r : m1->m_seq - m2->m_seq;
+}
+
+/*)Function     VOID    mrgareas()
+ *
+ *      The function mrgareas() links identical literal strings
+ *      the compiler split off only once.  Of the literal strings
+ *      with the same contents in the same area the first one is
+ *      kept; the others get size zero like the sections removed
+ *      by gcareas(), and mrgaddr() later gives them the address
+ *      of the one kept.
+ *
+ *      local variables:
+ *              int     i               loop counter
+ *              int     k               first of equal literal strings
+ *              mrgitem *m              array of literal strings
+ *              int     n               number of literal strings
+ *              area    *tap            pointer to an area structure
+ *              areax   *taxp           pointer to an areax structure
+ *
+ *      global variables:
+ *              area    *areap          The pointer to the first
+ *                                      area structure of a linked list
+ *
+ *      functions called:
+ *              int     fprintf()       c_library
+ *              VOID    free()          c_library
+ *              VOID *  malloc()        c_library
+ *              VOID    qsort()         c_library
+ *
+ *      side effects:
+ *              Duplicate literal strings are removed.
+ */
+
+VOID
+mrgareas(void)
+{
+        struct area *tap;
+        struct areax *taxp;
+        struct mrgitem *m;
+        int i, k, n;
+
+        n = 0;
+        for (tap = areap; tap; tap = tap->a_ap)
+                for (taxp = tap->a_axp; taxp; taxp = taxp->a_axp)
+                        n++;
+        if ((m = (struct mrgitem *) malloc ((n + 1) * sizeof (struct mrgitem))) == NULL) {
+                fprintf(stderr, "Insufficient space for --merge-strings.\n");
+                lkexit(ER_FATAL);
+        }
+
+        n = 0;
+        for (tap = areap; tap; tap = tap->a_ap) {
+                for (taxp = tap->a_axp; taxp; taxp = taxp->a_axp) {
+                        if ((taxp->a_gcflg & (A_STRING | A_GCDEAD)) == A_STRING &&
+                            taxp->a_size && taxp->a_tsize == taxp->a_size) {
+                                m[n].m_axp = taxp;
+                                m[n].m_seq = n;
+                                n++;
+                        }
+                }
+        }
+        qsort(m, n, sizeof (struct mrgitem), mrgcmp);
+
+        for (k = 0, i = 1; i < n; i++) {
+                if (m[i].m_axp->a_bap == m[k].m_axp->a_bap &&
+                    m[i].m_axp->a_size == m[k].m_axp->a_size &&
+                    !memcmp(m[i].m_axp->a_text, m[k].m_axp->a_text, m[k].m_axp->a_size)) {
+                        taxp = m[i].m_axp;
+                        taxp->a_mrgp = m[k].m_axp;
+                        taxp->a_gcflg |= A_GCDEAD;
+                        taxp->a_size = 0;
+                } else {
+                        k = i;
+                }
+        }
+        free(m);
+}
+
+/*)Function     VOID    mrgaddr()
+ *
+ *      The function mrgaddr() gives the literal strings removed
+ *      by mrgareas() the address of the identical one kept, so
+ *      that the references to them and the labels in them are
+ *      relocated to it.
+ *
+ *      local variables:
+ *              area    *tap            pointer to an area structure
+ *              areax   *taxp           pointer to an areax structure
+ *
+ *      global variables:
+ *              area    *areap          The pointer to the first
+ *                                      area structure of a linked list
+ *
+ *      functions called:
+ *              none
+ *
+ *      side effects:
+ *              The section addresses are changed.
+ */
+
+VOID
+mrgaddr(void)
+{
+        struct area *tap;
+        struct areax *taxp;
+
+        for (tap = areap; tap; tap = tap->a_ap)
+                for (taxp = tap->a_axp; taxp; taxp = taxp->a_axp)
+                        if (taxp->a_mrgp)
+                                taxp->a_addr = taxp->a_mrgp->a_addr;
+}
+
 a_uint lnksect2 (struct area *tap, int locIndex);
 unsigned long codemap8051[524288];
 unsigned long xdatamap[131216];
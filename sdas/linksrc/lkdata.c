@@ -162,6 +162,15 @@ long    xram_size = -1; /*      external ram size
                          */
 long    code_size = -1; /*      code size
                          */
+int     gcflag;         /*      --gc-areas, remove unreachable
+                         *      split sections
+                         */
+struct  globl   *keepp; /*      The pointer to the first --keep
+                         *      symbol string
+                         */
+int     mergeflag;      /*      --merge-strings, link identical
+                         *      literal strings only once
+                         */
 /* end sdld specific */
 
 /*
@@ -410,7 +410,7 @@ lstarea(struct area *xp, struct bank *yp)
                 for (i=0; i<NHASH; i++) {
                         sp = symhash[i];
                         while (sp != NULL) {
-                                if (oxp == sp->s_axp)
+                                if (oxp == sp->s_axp && !(oxp->a_gcflg & A_GCDEAD))
                                         ++nmsym;
                                 sp = sp->s_sp;
                         }
@@ -443,7 +443,7 @@ lstarea(struct area *xp, struct bank *yp)
                 for (i=0; i<NHASH; i++) {
                         sp = symhash[i];
                         while (sp != NULL) {
-                                if (oxp == sp->s_axp) {
+                                if (oxp == sp->s_axp && !(oxp->a_gcflg & A_GCDEAD)) {
                                         p[nmsym++] = sp;
                                 }
                                 sp = sp->s_sp;
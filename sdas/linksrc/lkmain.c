@@ -39,6 +39,7 @@
  *              int     intsiz()
  *              VOID    link_main()
  *              VOID    lkexit()
+ *              VOID    lngopt()
  *              int     fndext()
  *              int     fndidx()
  *              int     main()
@@ -215,6 +216,18 @@ main(int argc, char *argv[])
 
         for(i=1; i<argc; i++) {
                 ip = ib;
+                /* sdld specific */
+                if(argv[i][0] == '-' && argv[i][1] == '-') {
+                        strcpy(ip, argv[i]);
+                        if (!strcmp(argv[i], "--keep") && i < argc - 1) {
+                                strcat(ip, " ");
+                                strcat(ip, argv[++i]);
+                        }
+                        if(pflag)
+                                fprintf(stdout, "ASlink >> %s\n", ip);
+                        parse();
+                } else
+                /* end sdld specific */
                 if(argv[i][0] == '-') {
                         j = i;
                         k = 1;
@@ -331,6 +344,19 @@ main(int argc, char *argv[])
                          */
                         search();
 
+                        /* sdld specific */
+                        /*
+                         * Remove unreachable split sections
+                         */
+                        if (gcflag)
+                                gcareas();
+                        /*
+                         * Link identical literal strings once
+                         */
+                        if (mergeflag)
+                                mrgareas();
+                        /* end sdld specific */
+
                         /* sdas specific */
                         /* use these defaults for parsing the .lk script */
                         a_bytes = 4;
@@ -356,6 +382,10 @@ main(int argc, char *argv[])
                         else
                                 /* end sdld 8051 specific */
                                 lnkarea();
+                        /* sdld specific */
+                        if (mergeflag)
+                                mrgaddr();
+                        /* end sdld specific */
                         /*
                          * Check bank size limits.
                          */
@@ -711,8 +741,19 @@ link_main()
         case 'T':
         case 'R':
         case 'P':
-                if (pass == 0)
+                if (pass == 0) {
+                        /* sdld specific */
+                        char *sip = ip;
+
+                        if (gcflag && c != 'T')
+                                gcrel(c);
+                        if (mergeflag) {
+                                ip = sip;
+                                mrgrel(c);
+                        }
+                        /* end sdld specific */
                         break;
+                }
                 reloc(c);
                 break;
 
@@ -917,6 +958,7 @@ map(void)
  *              VOID    doparse()       lkmain.c
  *              int     fprintf()       c_library
  *              VOID    gblsav()        lkmain.c
+ *              VOID    lngopt()        lkmain.c
  *              VOID    getfid()        lklex.c
  *              int     get()           lklex.c
  *              int     getnb()         lklex.c
@@ -943,6 +985,13 @@ parse()
                         return(0);
                 /* end sdld specific */
                 if ( c == '-') {
+                        /* sdld specific */
+                        if (*ip == '-') {
+                                ++ip;
+                                lngopt();
+                                return(0);
+                        }
+                        /* end sdld specific */
                         while (ctype[c=get()] & LETTER) {
                                 switch(c) {
 
@@ -1320,6 +1369,79 @@ gblsav()
 }
 
 
+/* sdld specific */
+/*)Function     VOID    lngopt()
+ *
+ *      The function lngopt() processes an option written with
+ *      two dashes, ip pointing past them:
+ *
+ *              --gc-areas      remove the sections split off by the
+ *                              compiler that are not reachable
+ *              --keep symbol   keep the section defining symbol
+ *              --merge-strings link identical literal strings
+ *                              split off by the compiler once
+ *
+ *      local variables:
+ *              char    opt[]           option name
+ *              int     c               character
+ *              int     i               loop counter
+ *              globl   *kp             pointer to a globl structure
+ *
+ *      global variables:
+ *              int     gcflag          --gc-areas flag
+ *              int     mergeflag       --merge-strings flag
+ *              globl   *keepp          The pointer to the first
+ *                                      --keep symbol string
+ *              char    *ip             pointer into the text line
+ *
+ *      functions called:
+ *              int     fprintf()       c_library
+ *              int     get()           lklex.c
+ *              VOID    getid()         lklex.c
+ *              int     getnb()         lklex.c
+ *              VOID *  new()           lksym.c
+ *              int     strcmp()        c_library
+ *              char *  strsto()        lksym.c
+ *
+ *      side effects:
+ *              The flag is set or the symbol string saved.
+ */
+
+VOID
+lngopt()
+{
+        char opt[NCPS];
+        struct globl *kp;
+        int c, i;
+
+        i = 0;
+        while ((c = get()) != 0 && c != ' ' && c != '\t' && c != '=') {
+                if (i < NCPS - 1)
+                        opt[i++] = (char) c;
+        }
+        opt[i] = '\0';
+
+        if (!strcmp(opt, "gc-areas")) {
+                gcflag = 1;
+        } else if (!strcmp(opt, "merge-strings")) {
+                mergeflag = 1;
+        } else if (!strcmp(opt, "keep")) {
+                if ((c = getnb()) == 0) {
+                        fprintf(stderr, "Missing symbol for --keep\n");
+                        lkerr++;
+                        return;
+                }
+                getid(opt, c);
+                kp = (struct globl *) new (sizeof (struct globl));
+                kp->g_strp = strsto(opt);
+                kp->g_globl = keepp;
+                keepp = kp;
+        } else {
+                fprintf(stderr, "Unknown option --%s ignored\n", opt);
+        }
+}
+/* end sdld specific */
+
 /*)Function     VOID    setgbl()
  *
  *      The function setgbl() scans the global variable lines in the
@@ -1720,6 +1842,10 @@ char *usetxt[] = {
         "  -u   Update listing file(s) with link data as file(s)[.rst]",
         "Case Sensitivity:",
         "  -z   Disable Case Sensitivity for Symbols",
+        "Unused code:",
+        "  --gc-areas           Remove split areas no other area refers to",
+        "  --keep symbol        Keep the area defining symbol with --gc-areas",
+        "  --merge-strings      Link identical split literal strings once",
         "End:",
         "  -e   or null line terminates input",
         "",
@@ -1766,6 +1892,10 @@ char *usetxt_8051[] = {
         "  -C   [code-size] Check for code overflow",
         "  -M   Generate memory usage summary file[.mem]",
         "  -S   [stack-size] Allocate space for stack",
+        "Unused code:",
+        "  --gc-areas           Remove split areas no other area refers to",
+        "  --keep symbol        Keep the area defining symbol with --gc-areas",
+        "  --merge-strings      Link identical split literal strings once",
         "End:",
         "  -e   or null line terminates input",
         "",
@@ -1812,6 +1942,10 @@ char *usetxt_6808[] = {
         "  -X   [xram-size] Check for external RAM overflow",
         "  -C   [code-size] Check for code overflow",
         "  -M   Generate memory usage summary file[.mem]",
+        "Unused code:",
+        "  --gc-areas           Remove split areas no other area refers to",
+        "  --keep symbol        Keep the area defining symbol with --gc-areas",
+        "  --merge-strings      Link identical split literal strings once",
         "End:",
         "  -e   or null line terminates input",
         "",
@@ -1853,6 +1987,10 @@ char *usetxt_z80_gb[] = {
         "  -u   Update listing file(s) with link data as file(s)[.rst]",
         "Case Sensitivity:",
         "  -z   Disable Case Sensitivity for Symbols",
+        "Unused code:",
+        "  --gc-areas           Remove split areas no other area refers to",
+        "  --keep symbol        Keep the area defining symbol with --gc-areas",
+        "  --merge-strings      Link identical split literal strings once",
         "End:",
         "  -e   or null line terminates input",
         "",
@@ -292,6 +292,14 @@ relr3(void)
                 return;
         }
 
+/* sdld specific */
+        /*
+         * Section removed by --gc-areas
+         */
+        if (a[aindex]->a_gcflg & A_GCDEAD)
+                return;
+/* end sdld specific */
+
         /*
          * Select Output File
          */
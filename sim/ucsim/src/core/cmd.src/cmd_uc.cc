@@ -26,6 +26,8 @@ Software Foundation, 59 Temple Place - Suite 330, Boston, MA
 /*@1@*/
 
 #include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
 #include <string.h>
 
 // prj
@@ -97,8 +99,249 @@ COMMAND_DO_WORK_UC(cl_state_cmd)
 CMDHELP(cl_state_cmd,
 	"state",
 	"State of microcontroller",
+	"Without parameter, print out state of the microcontroller.\n"
+	"The whole state can be saved into a file and restored\n"
+	"later by the subcommands.")
+
+/*
+ * Command: state save
+ *----------------------------------------------------------------------------
+ */
+
+COMMAND_DO_WORK_UC(cl_state_save_cmd)
+{
+  const char *fname= 0;
+
+  if ((cmdline->param(0) == 0) ||
+      ((fname= cmdline->param(0)->get_svalue()) == NULL))
+    {
+      con->dd_printf("File name is missing.\n");
+      return(0);
+    }
+  uc->save_state(fname, con);
+  return(0);
+}
+
+CMDHELP(cl_state_save_cmd,
+	"state save \"FILE\"",
+	"Save full state of the simulated uc into FILE",
+	"Contents of all memories, CPU registers, state of hardware\n"
+	"elements and clock counters are written into FILE.")
+
+/*
+ * Command: state load
+ *----------------------------------------------------------------------------
+ */
+
+COMMAND_DO_WORK_UC(cl_state_load_cmd)
+{
+  const char *fname= 0;
+
+  if ((cmdline->param(0) == 0) ||
+      ((fname= cmdline->param(0)->get_svalue()) == NULL))
+    {
+      con->dd_printf("File name is missing.\n");
+      return(0);
+    }
+  uc->load_state(fname, con);
+  return(0);
+}
+
+CMDHELP(cl_state_load_cmd,
+	"state load \"FILE\"",
+	"Restore state of the simulated uc from FILE",
+	"FILE must be saved by \"state save\" using the same\n"
+	"CPU type and configuration.")
+
+/*
+ * Command: profile start
+ *----------------------------------------------------------------------------
+ */
+
+COMMAND_DO_WORK_UC(cl_profile_start_cmd)
+{
+  delete uc->profiler;
+  uc->profiler= new cl_profiler(uc);
+  uc->profiler->init();
+  return(0);
+}
+
+CMDHELP(cl_profile_start_cmd,
+	"profile start",
+	"Start call graph profiler",
+	"Collected data is cleared, actual function becomes the root\n"
+	"of the call graph. Only the simulators which report calls\n"
+	"and returns can be profiled.")
+
+/*
+ * Command: profile stop
+ *----------------------------------------------------------------------------
+ */
+
+COMMAND_DO_WORK_UC(cl_profile_stop_cmd)
+{
+  delete uc->profiler;
+  uc->profiler= NULL;
+  return(0);
+}
+
+CMDHELP(cl_profile_stop_cmd,
+	"profile stop",
+	"Stop call graph profiler and drop collected data",
+	"")
+
+/*
+ * Command: profile [report]
+ *----------------------------------------------------------------------------
+ */
+
+COMMAND_DO_WORK_UC(cl_profile_report_cmd)
+{
+  class cl_cmd_arg *params[1]= { cmdline->param(0) };
+  int lines= 0;
+
+  if (!uc->profiler)
+    {
+      con->dd_printf("Profiler is not started.\n");
+      return(0);
+    }
+  if (params[0])
+    lines= params[0]->i_value;
+  uc->profiler->report(con, lines);
+  return(0);
+}
+
+CMDHELP(cl_profile_report_cmd,
+	"profile report [lines]",
+	"Print ticks spent in functions",
+	"Functions are ordered by exclusive time (ticks spent in the\n"
+	"function itself), inclusive time contains the callees too.\n"
+	"Function names come from loaded .cdb or .map files.")
+
+/*
+ * Command: profile folded
+ *----------------------------------------------------------------------------
+ */
+
+COMMAND_DO_WORK_UC(cl_profile_folded_cmd)
+{
+  const char *fname= 0;
+  FILE *f;
+
+  if (!uc->profiler)
+    {
+      con->dd_printf("Profiler is not started.\n");
+      return(0);
+    }
+  if ((cmdline->param(0) == 0) ||
+      ((fname= cmdline->param(0)->get_svalue()) == NULL))
+    {
+      con->dd_printf("File name is missing.\n");
+      return(0);
+    }
+  if ((f= fopen(fname, "w")) == NULL)
+    {
+      con->dd_printf("Error: %s: %s\n", fname, strerror(errno));
+      return(0);
+    }
+  uc->profiler->folded(f);
+  fclose(f);
+  return(0);
+}
+
+CMDHELP(cl_profile_folded_cmd,
+	"profile folded \"FILE\"",
+	"Write call paths in folded stack format",
+	"Every line of FILE is a call path, functions separated by\n"
+	"semicolons, and the ticks spent in its last function. It is\n"
+	"the input format of flame graph tools.")
+
+/*
+ * Command: coverage start
+ *----------------------------------------------------------------------------
+ */
+
+COMMAND_DO_WORK_UC(cl_coverage_start_cmd)
+{
+  delete uc->coverage;
+  uc->coverage= new cl_coverage(uc);
+  uc->coverage->init();
+  return(0);
+}
+
+CMDHELP(cl_coverage_start_cmd,
+	"coverage start",
+	"Start collecting code coverage",
+	"Executed instructions and the ways they were left are marked\n"
+	"for every code address. Previously collected data is cleared.")
+
+/*
+ * Command: coverage stop
+ *----------------------------------------------------------------------------
+ */
+
+COMMAND_DO_WORK_UC(cl_coverage_stop_cmd)
+{
+  delete uc->coverage;
+  uc->coverage= NULL;
+  return(0);
+}
+
+CMDHELP(cl_coverage_stop_cmd,
+	"coverage stop",
+	"Stop collecting code coverage and drop collected data",
+	"")
+
+/*
+ * Command: coverage
+ *----------------------------------------------------------------------------
+ */
+
+COMMAND_DO_WORK_UC(cl_coverage_info_cmd)
+{
+  if (!uc->coverage)
+    con->dd_printf("Coverage is not started.\n");
+  else
+    uc->coverage->report(con);
+  return(0);
+}
+
+CMDHELP(cl_coverage_info_cmd,
+	"coverage",
+	"Print summary of collected code coverage",
 	"")
 
+/*
+ * Command: coverage lcov
+ *----------------------------------------------------------------------------
+ */
+
+COMMAND_DO_WORK_UC(cl_coverage_lcov_cmd)
+{
+  const char *fname= 0;
+
+  if (!uc->coverage)
+    {
+      con->dd_printf("Coverage is not started.\n");
+      return(0);
+    }
+  if ((cmdline->param(0) == 0) ||
+      ((fname= cmdline->param(0)->get_svalue()) == NULL))
+    {
+      con->dd_printf("File name is missing.\n");
+      return(0);
+    }
+  uc->coverage->lcov(fname, con);
+  return(0);
+}
+
+CMDHELP(cl_coverage_lcov_cmd,
+	"coverage lcov \"FILE\"",
+	"Add line and branch coverage to lcov tracefile",
+	"Source lines and functions are taken from the loaded .cdb file.\n"
+	"If FILE exists, its counters are increased, so the same file can\n"
+	"collect coverage of several runs.")
+
 /*
  * Command: file
  *----------------------------------------------------------------------------
@@ -31,6 +31,16 @@ Software Foundation, 59 Temple Place - Suite 330, Boston, MA
 #include "newcmdcl.h"
 
 COMMAND_ON(uc,cl_state_cmd);
+COMMAND_ON(uc,cl_state_save_cmd);
+COMMAND_ON(uc,cl_state_load_cmd);
+COMMAND_ON(uc,cl_profile_start_cmd);
+COMMAND_ON(uc,cl_profile_stop_cmd);
+COMMAND_ON(uc,cl_profile_report_cmd);
+COMMAND_ON(uc,cl_profile_folded_cmd);
+COMMAND_ON(uc,cl_coverage_start_cmd);
+COMMAND_ON(uc,cl_coverage_stop_cmd);
+COMMAND_ON(uc,cl_coverage_info_cmd);
+COMMAND_ON(uc,cl_coverage_lcov_cmd);
 COMMAND_ON(uc,cl_file_cmd);
 COMMAND_ON(uc,cl_dl_cmd);
 COMMAND_ON(uc,cl_check_cmd);
@@ -0,0 +1,550 @@
+/*
+ * Simulator of microcontrollers (cov.cc)
+ *
+ * Copyright (C) 2026 Drotos Daniel
+ * 
+ * To contact author send email to dr.dkdb@gmail.com
+ *
+ */
+
+/* This file is part of microcontroller simulator: ucsim.
+
+UCSIM is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+UCSIM is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with UCSIM; see the file COPYING.  If not, write to the Free
+Software Foundation, 59 Temple Place - Suite 330, Boston, MA
+02111-1307, USA. */
+/*@1@*/
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+// prj
+#include "globals.h"
+
+// sim
+#include "uccl.h"
+
+// local
+#include "covcl.h"
+
+
+/*
+ * Table of names
+ */
+
+cl_names::cl_names(void):
+  cl_base()
+{
+  names= NULL;
+  count= 0;
+}
+
+cl_names::~cl_names(void)
+{
+  int i;
+
+  for (i= 0; i < count; i++)
+    free(names[i]);
+  free(names);
+}
+
+int
+cl_names::idx(const char *name)
+{
+  int i;
+
+  for (i= count-1; i >= 0; i--)
+    if (strcmp(names[i], name) == 0)
+      return i;
+  names= (char **)realloc(names, (count+1) * sizeof(char *));
+  names[count]= strdup(name);
+  return count++;
+}
+
+
+/*
+ * Line records of the debug information
+ */
+
+cl_dbg_lines::cl_dbg_lines(void):
+  cl_base()
+{
+  lines= NULL;
+  count= limit= 0;
+}
+
+cl_dbg_lines::~cl_dbg_lines(void)
+{
+  free(lines);
+}
+
+void
+cl_dbg_lines::add(char kind, const char *file, long line, t_addr addr)
+{
+  if (count >= limit)
+    {
+      limit= limit?(2*limit):256;
+      lines= (struct dbg_line *)realloc(lines, limit * sizeof(struct dbg_line));
+    }
+  lines[count].kind= kind;
+  lines[count].file= names.idx(file);
+  lines[count].line= line;
+  lines[count].addr= addr;
+  count++;
+}
+
+static int
+cmp_dbg_line(const void *p1, const void *p2)
+{
+  const struct dbg_line *l1= (const struct dbg_line *)p1;
+  const struct dbg_line *l2= (const struct dbg_line *)p2;
+
+  if (l1->addr != l2->addr)
+    return (l1->addr < l2->addr)?-1:1;
+  // function start first, then lines in order
+  if (l1->kind != l2->kind)
+    return (l1->kind == 'F')?-1:((l2->kind == 'F')?1:(l1->kind - l2->kind));
+  if (l1->line != l2->line)
+    return (l1->line < l2->line)?-1:1;
+  return 0;
+}
+
+void
+cl_dbg_lines::sort(void)
+{
+  qsort(lines, count, sizeof(struct dbg_line), cmp_dbg_line);
+}
+
+
+/*
+ * Code coverage
+ */
+
+cl_coverage::cl_coverage(class cl_uc *auc):
+  cl_base()
+{
+  uc= auc;
+  start= 0;
+  size= 0;
+  map= NULL;
+  recs= NULL;
+  nuof_recs= recs_limit= 0;
+}
+
+cl_coverage::~cl_coverage(void)
+{
+  free(map);
+  free(recs);
+}
+
+int
+cl_coverage::init(void)
+{
+  cl_base::init();
+  if (uc->rom)
+    {
+      start= uc->rom->get_start_address();
+      size= uc->rom->get_size();
+    }
+  map= (u8_t *)calloc(size?size:1, 1);
+  return 0;
+}
+
+void
+cl_coverage::clear(void)
+{
+  memset(map, 0, size);
+}
+
+/* Length of the instruction is looked up only once, later executions
+   compare the next PC to the cached value. */
+
+void
+cl_coverage::first(t_addr addr)
+{
+  int l= uc->inst_length(addr);
+
+  if ((l < 0) ||
+      (l >= (1 << (8-COV_LEN_SHIFT))))
+    l= 0;
+  map[addr-start]= COV_EXEC | (l << COV_LEN_SHIFT);
+}
+
+u8_t
+cl_coverage::flags(t_addr addr)
+{
+  t_addr i= addr - start;
+  return (i < size)?map[i]:0;
+}
+
+/* An executed instruction is a branch if it was seen both jumping and
+   continuing, or continuing although the disassembler knows it as a
+   jump. Branches which always jumped can not be told from unconditional
+   jumps, they are not reported. */
+
+bool
+cl_coverage::is_branch(t_addr addr)
+{
+  u8_t f= flags(addr);
+  int b;
+
+  if (!(f & COV_EXEC))
+    return false;
+  if ((f & COV_JUMP) && (f & COV_NEXT))
+    return true;
+  if (f & COV_NEXT)
+    {
+      b= uc->inst_branch(addr);
+      return (b != 0) && (b != ' ');
+    }
+  return false;
+}
+
+void
+cl_coverage::add_rec(int file, long line, int kind, int block, int branch,
+		     int name, long count)
+{
+  if (nuof_recs >= recs_limit)
+    {
+      recs_limit= recs_limit?(2*recs_limit):1024;
+      recs= (struct cov_rec *)realloc(recs, recs_limit * sizeof(struct cov_rec));
+    }
+  struct cov_rec *r= &recs[nuof_recs++];
+  r->file= file;
+  r->line= line;
+  r->kind= kind;
+  r->block= block;
+  r->branch= branch;
+  r->name= name;
+  r->count= count;
+}
+
+/* A C line covers the code from its address up to the next C line or
+   the end of the function, an assembler line up to the next assembler
+   line. If more lines start at the same address, the code belongs to
+   the last one, the others are covered if the first instruction was
+   executed. A function is reported at its first C line. */
+
+void
+cl_coverage::collect(class cl_dbg_lines *dl)
+{
+  int i, j, file;
+  t_addr a, end;
+  bool hit, shared;
+
+  if (!dl)
+    return;
+  dl->sort();
+  for (i= 0; i < dl->count; i++)
+    {
+      struct dbg_line *l= &dl->lines[i];
+      if (l->kind == 'F')
+	{
+	  for (j= i+1; j < dl->count; j++)
+	    {
+	      if (dl->lines[j].kind == 'X')
+		break;
+	      if (dl->lines[j].kind == 'C')
+		{
+		  add_rec(names.idx(dl->names.at(dl->lines[j].file)),
+			  dl->lines[j].line, COV_R_FN, 0, 0,
+			  names.idx(dl->names.at(l->file)),
+			  (flags(l->addr) & COV_EXEC)?1:0);
+		  break;
+		}
+	    }
+	  continue;
+	}
+      if ((l->kind != 'C') &&
+	  (l->kind != 'A'))
+	continue;
+      end= l->addr + 1;
+      shared= false;
+      for (j= i+1; j < dl->count; j++)
+	{
+	  struct dbg_line *n= &dl->lines[j];
+	  if (n->kind == l->kind)
+	    {
+	      if (n->addr > l->addr)
+		end= n->addr;
+	      else
+		shared= true;
+	      break;
+	    }
+	  if ((l->kind == 'C') &&
+	      (n->kind == 'X'))
+	    {
+	      end= n->addr + 1;
+	      break;
+	    }
+	}
+      file= names.idx(dl->names.at(l->file));
+      hit= false;
+      for (a= l->addr; a < end; a++)
+	{
+	  if (flags(a) & COV_EXEC)
+	    hit= true;
+	  if (shared)
+	    break;
+	  if (is_branch(a))
+	    {
+	      add_rec(file, l->line, COV_R_BR, a, 0, 0,
+		      (flags(a) & COV_JUMP)?1:0);
+	      add_rec(file, l->line, COV_R_BR, a, 1, 0,
+		      (flags(a) & COV_NEXT)?1:0);
+	    }
+	}
+      add_rec(file, l->line, COV_R_DA, 0, 0, 0, hit?1:0);
+    }
+}
+
+/* Records of an existing tracefile are appended, coalesce() adds them
+   to the ones of this run. */
+
+int
+cl_coverage::merge(FILE *f)
+{
+  char ln[1024], *s;
+  int file= -1, first_fn= nuof_recs, i, n= 0;
+  long line, count;
+  int block, branch;
+
+  while (fgets(ln, sizeof(ln), f))
+    {
+      if ((s= strpbrk(ln, "\r\n")) != NULL)
+	*s= 0;
+      if (strncmp(ln, "SF:", 3) == 0)
+	{
+	  file= names.idx(ln+3);
+	  first_fn= nuof_recs;
+	}
+      else if (strcmp(ln, "end_of_record") == 0)
+	file= -1;
+      else if (file < 0)
+	continue;
+      else if (strncmp(ln, "FN:", 3) == 0)
+	{
+	  line= strtol(ln+3, &s, 10);
+	  if (*s != ',')
+	    continue;
+	  add_rec(file, line, COV_R_FN, 0, 0, names.idx(s+1), 0);
+	  n++;
+	}
+      else if (strncmp(ln, "FNDA:", 5) == 0)
+	{
+	  count= strtol(ln+5, &s, 10);
+	  if (*s++ != ',')
+	    continue;
+	  for (i= first_fn; i < nuof_recs; i++)
+	    if ((recs[i].kind == COV_R_FN) &&
+		(strcmp(names.at(recs[i].name), s) == 0))
+	      recs[i].count= count;
+	}
+      else if (strncmp(ln, "DA:", 3) == 0)
+	{
+	  line= strtol(ln+3, &s, 10);
+	  if (*s++ != ',')
+	    continue;
+	  count= strtol(s, NULL, 10);
+	  add_rec(file, line, COV_R_DA, 0, 0, 0, count);
+	  n++;
+	}
+      else if (strncmp(ln, "BRDA:", 5) == 0)
+	{
+	  line= strtol(ln+5, &s, 10);
+	  if (*s++ != ',')
+	    continue;
+	  block= strtol(s, &s, 10);
+	  if (*s++ != ',')
+	    continue;
+	  branch= strtol(s, &s, 10);
+	  if (*s++ != ',')
+	    continue;
+	  count= (*s == '-')?-1:strtol(s, NULL, 10);
+	  add_rec(file, line, COV_R_BR, block, branch, 0, count);
+	  n++;
+	}
+    }
+  return n;
+}
+
+static class cl_names *cmp_names;
+
+static int
+cmp_cov_rec(const void *p1, const void *p2)
+{
+  const struct cov_rec *r1= (const struct cov_rec *)p1;
+  const struct cov_rec *r2= (const struct cov_rec *)p2;
+  int i;
+
+  if (r1->file != r2->file)
+    return strcmp(cmp_names->at(r1->file), cmp_names->at(r2->file));
+  if (r1->kind != r2->kind)
+    return r1->kind - r2->kind;
+  if (r1->line != r2->line)
+    return (r1->line < r2->line)?-1:1;
+  if (r1->block != r2->block)
+    return r1->block - r2->block;
+  if (r1->branch != r2->branch)
+    return r1->branch - r2->branch;
+  if ((r1->kind == COV_R_FN) &&
+      (i= strcmp(cmp_names->at(r1->name), cmp_names->at(r2->name))) != 0)
+    return i;
+  return 0;
+}
+
+/* Equal records are united. Within one run a line or branch is covered
+   if any of its records is, records of different runs are added. */
+
+void
+cl_coverage::coalesce(bool add)
+{
+  int i, n;
+
+  if (nuof_recs == 0)
+    return;
+  cmp_names= &names;
+  qsort(recs, nuof_recs, sizeof(struct cov_rec), cmp_cov_rec);
+  for (i= 1, n= 0; i < nuof_recs; i++)
+    {
+      if (cmp_cov_rec(&recs[n], &recs[i]) == 0)
+	{
+	  long c1= recs[n].count, c2= recs[i].count;
+	  if ((c1 < 0) || (c2 < 0))
+	    recs[n].count= (c1 < 0)?c2:c1;
+	  else if (add)
+	    recs[n].count= c1 + c2;
+	  else if (c2 > c1)
+	    recs[n].count= c2;
+	}
+      else
+	recs[++n]= recs[i];
+    }
+  nuof_recs= n+1;
+}
+
+void
+cl_coverage::write(FILE *f)
+{
+  int i, j, file, fnf, fnh, brf, brh, lf, lh;
+
+  for (i= 0; i < nuof_recs; i= j)
+    {
+      file= recs[i].file;
+      fnf= fnh= brf= brh= lf= lh= 0;
+      fprintf(f, "TN:\nSF:%s\n", names.at(file));
+      for (j= i; (j < nuof_recs) && (recs[j].file == file); j++)
+	if (recs[j].kind == COV_R_FN)
+	  fprintf(f, "FN:%ld,%s\n", recs[j].line, names.at(recs[j].name));
+      for (j= i; (j < nuof_recs) && (recs[j].file == file); j++)
+	if (recs[j].kind == COV_R_FN)
+	  {
+	    fprintf(f, "FNDA:%ld,%s\n", recs[j].count, names.at(recs[j].name));
+	    fnf++;
+	    if (recs[j].count > 0)
+	      fnh++;
+	  }
+      fprintf(f, "FNF:%d\nFNH:%d\n", fnf, fnh);
+      for (j= i; (j < nuof_recs) && (recs[j].file == file); j++)
+	if (recs[j].kind == COV_R_BR)
+	  {
+	    if (recs[j].count < 0)
+	      fprintf(f, "BRDA:%ld,%d,%d,-\n", recs[j].line,
+		      recs[j].block, recs[j].branch);
+	    else
+	      fprintf(f, "BRDA:%ld,%d,%d,%ld\n", recs[j].line,
+		      recs[j].block, recs[j].branch, recs[j].count);
+	    brf++;
+	    if (recs[j].count > 0)
+	      brh++;
+	  }
+      fprintf(f, "BRF:%d\nBRH:%d\n", brf, brh);
+      for (j= i; (j < nuof_recs) && (recs[j].file == file); j++)
+	if (recs[j].kind == COV_R_DA)
+	  {
+	    fprintf(f, "DA:%ld,%ld\n", recs[j].line, recs[j].count);
+	    lf++;
+	    if (recs[j].count > 0)
+	      lh++;
+	  }
+      fprintf(f, "LF:%d\nLH:%d\nend_of_record\n", lf, lh);
+    }
+}
+
+/* Coverage of this run is added to the tracefile, it is created if it
+   does not exist yet. */
+
+int
+cl_coverage::lcov(const char *fname, class cl_console_base *con)
+{
+  FILE *f;
+  const char *err= NULL;
+
+  nuof_recs= 0;
+  collect(uc->dbg_lines);
+  coalesce(false);
+  if ((f= fopen(fname, "r")) != NULL)
+    {
+      merge(f);
+      fclose(f);
+      coalesce(true);
+    }
+  if ((f= fopen(fname, "w")) == NULL)
+    err= strerror(errno);
+  else
+    {
+      write(f);
+      if (fclose(f) != 0)
+	err= strerror(errno);
+    }
+  if (err)
+    {
+      if (con)
+	con->dd_printf("Error: writing coverage to `%s': %s\n", fname, err);
+      else
+	fprintf(stderr, "Error: writing coverage to `%s': %s\n", fname, err);
+      return -1;
+    }
+  return 0;
+}
+
+void
+cl_coverage::report(class cl_console_base *con)
+{
+  t_addr a;
+  unsigned long insts= 0, branches= 0, both= 0;
+  u8_t f;
+
+  for (a= 0; a < size; a++)
+    {
+      f= map[a];
+      if (!(f & COV_EXEC))
+	continue;
+      insts++;
+      if (is_branch(start+a))
+	{
+	  branches++;
+	  if ((f & COV_JUMP) && (f & COV_NEXT))
+	    both++;
+	}
+    }
+  con->dd_printf("%lu instructions executed, %lu of %lu branches "
+		 "went both ways\n", insts, both, branches);
+  if (uc->dbg_lines == NULL)
+    con->dd_printf("No line records loaded, read the .cdb file of the "
+		   "program to export coverage\n");
+}
+
+
+/* End of sim.src/cov.cc */
@@ -0,0 +1,152 @@
+/*
+ * Simulator of microcontrollers (covcl.h)
+ *
+ * Copyright (C) 2026 Drotos Daniel
+ * 
+ * To contact author send email to dr.dkdb@gmail.com
+ *
+ */
+
+/* This file is part of microcontroller simulator: ucsim.
+
+UCSIM is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+UCSIM is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with UCSIM; see the file COPYING.  If not, write to the Free
+Software Foundation, 59 Temple Place - Suite 330, Boston, MA
+02111-1307, USA. */
+/*@1@*/
+
+#ifndef COVCL_HEADER
+#define COVCL_HEADER
+
+#include <stdio.h>
+
+#include "stypes.h"
+#include "pobjcl.h"
+#include "charscl.h"
+
+
+/*
+ * Line records of the debug information
+ *
+ * L:C (C source line), L:A (assembler line), L:X (end of function) and
+ * function start records of .cdb and .adb files, kept for coverage
+ * reports.
+ */
+
+class cl_names: public cl_base
+{
+ public:
+  char **names;
+  int count;
+ public:
+  cl_names(void);
+  virtual ~cl_names(void);
+
+  int idx(const char *name);
+  const char *at(int i) { return names[i]; }
+};
+
+struct dbg_line
+{
+  char kind;			// 'C', 'A', 'X' or 'F' (function start)
+  int file;			// index in names, name of function for 'F'
+  long line;
+  t_addr addr;
+};
+
+class cl_dbg_lines: public cl_base
+{
+ public:
+  struct dbg_line *lines;
+  int count, limit;
+  class cl_names names;
+ public:
+  cl_dbg_lines(void);
+  virtual ~cl_dbg_lines(void);
+
+  void add(char kind, const char *file, long line, t_addr addr);
+  void sort(void);
+};
+
+
+/*
+ * Code coverage
+ *
+ * One byte per code address: executed flag, the ways the instruction
+ * was left and its length, cached at first execution. Exported as lcov
+ * tracefile using the debug line records.
+ */
+
+#define COV_EXEC	0x01	// executed
+#define COV_JUMP	0x02	// left by a jump
+#define COV_NEXT	0x04	// left to the following instruction
+#define COV_LEN_SHIFT	3	// instruction length in the upper bits
+
+struct cov_rec
+{
+  int file;
+  long line;
+  int kind;			// COV_R_*
+  int block, branch;		// of branches
+  int name;			// of functions
+  long count;			// -1 if not executed (branches only)
+};
+
+enum {
+  COV_R_FN	= 0,
+  COV_R_BR	= 1,
+  COV_R_DA	= 2
+};
+
+class cl_coverage: public cl_base
+{
+ protected:
+  class cl_uc *uc;
+  t_addr start, size;
+  u8_t *map;
+  struct cov_rec *recs;
+  int nuof_recs, recs_limit;
+  class cl_names names;
+ public:
+  cl_coverage(class cl_uc *auc);
+  virtual ~cl_coverage(void);
+  virtual int init(void);
+
+  void exec(t_addr addr, t_addr next)
+  {
+    t_addr i= addr - start;
+    if (i >= size)
+      return;
+    if (!(map[i] & COV_EXEC))
+      first(addr);
+    map[i]|= (next == addr + (map[i] >> COV_LEN_SHIFT))?COV_NEXT:COV_JUMP;
+  }
+  virtual void clear(void);
+  virtual void report(class cl_console_base *con);
+  virtual int lcov(const char *fname, class cl_console_base *con);
+ protected:
+  void first(t_addr addr);
+  u8_t flags(t_addr addr);
+  bool is_branch(t_addr addr);
+  void add_rec(int file, long line, int kind, int block, int branch,
+	       int name, long count);
+  void collect(class cl_dbg_lines *dl);
+  int merge(FILE *f);
+  void coalesce(bool add);
+  void write(FILE *f);
+};
+
+
+#endif
+
+/* End of sim.src/covcl.h */
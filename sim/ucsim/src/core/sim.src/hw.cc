@@ -37,6 +37,7 @@ Software Foundation, 59 Temple Place - Suite 330, Boston, MA
 #include "globals.h"
 
 #include "hwcl.h"
+#include "statecl.h"
 
 
 /*
@@ -296,6 +297,15 @@ cl_hw::tick(int cycles)
   return(0);
 }
 
+/* Internal state which is not stored in memory cells. Elements which
+   cache register bits or count clocks should extend this. */
+
+void
+cl_hw::checkpoint(class cl_state_file *sf)
+{
+  sf->var(on);
+}
+
 void
 cl_hw::inform_partners(enum hw_event he, void *params)
 {
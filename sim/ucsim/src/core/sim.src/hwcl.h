@@ -114,6 +114,8 @@ class cl_hw: public cl_guiobj
 
   virtual int tick(int cycles);
   virtual void reset(void) {}
+  virtual void sim_stopped(void) {}
+  virtual void checkpoint(class cl_state_file *sf);
   virtual void happen(class cl_hw * /*where*/, enum hw_event /*he*/,
                       void * /*params*/) {}
   virtual void inform_partners(enum hw_event he, void *params);
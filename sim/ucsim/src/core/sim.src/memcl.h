@@ -600,6 +600,8 @@ public:
 
   virtual void *get_slot(t_addr addr);
   virtual bool is_slot(void *data_ptr, t_addr *addr_of);
+  void *get_array(void) { return array; }
+  int get_bwidth(void) { return bwidth; }
   
   virtual t_mem read(t_addr addr) { return d(addr); }
   virtual t_mem read(t_addr addr, enum hw_cath skip) { return d(addr); }
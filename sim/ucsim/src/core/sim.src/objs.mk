@@ -1,3 +1,4 @@
 OBJECTS         = stack.o mem.o sim.o itsrc.o brk.o arg.o itab.o \
 		  guiobj.o uc.o hw.o simif.o serial_hw.o port_hw.o dreg.o \
-		  iwrap.o var.o vcd.o pc16550.o
+		  iwrap.o var.o vcd.o pc16550.o state.o \
+		  prof.o cov.o
@@ -0,0 +1,357 @@
+/*
+ * Simulator of microcontrollers (prof.cc)
+ *
+ * Copyright (C) 2026 Drotos Daniel
+ * 
+ * To contact author send email to dr.dkdb@gmail.com
+ *
+ */
+
+/* This file is part of microcontroller simulator: ucsim.
+
+UCSIM is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+UCSIM is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with UCSIM; see the file COPYING.  If not, write to the Free
+Software Foundation, 59 Temple Place - Suite 330, Boston, MA
+02111-1307, USA. */
+/*@1@*/
+
+#include <stdlib.h>
+#include <string.h>
+
+// prj
+#include "globals.h"
+
+// sim
+#include "uccl.h"
+#include "varcl.h"
+
+// local
+#include "profcl.h"
+
+
+cl_profiler::cl_profiler(class cl_uc *auc):
+  cl_base()
+{
+  uc= auc;
+  funcs= NULL;
+  paths= NULL;
+  path_hash= NULL;
+  nuof_paths= 0;
+  depth= 0;
+  lost= 0;
+}
+
+cl_profiler::~cl_profiler(void)
+{
+  free(funcs);
+  free(paths);
+  free(path_hash);
+}
+
+int
+cl_profiler::init(void)
+{
+  cl_base::init();
+  funcs= (struct prof_func *)malloc(PROF_FUNCS * sizeof(struct prof_func));
+  paths= (struct prof_path *)malloc(PROF_PATHS * sizeof(struct prof_path));
+  path_hash= (int *)malloc(2 * PROF_PATHS * sizeof(int));
+  clear();
+  return 0;
+}
+
+/* Forget everything, the function which is running now becomes the root
+   of the call paths. */
+
+void
+cl_profiler::clear(void)
+{
+  int i;
+
+  memset(funcs, 0, PROF_FUNCS * sizeof(struct prof_func));
+  for (i= 0; i < 2 * PROF_PATHS; i++)
+    path_hash[i]= -1;
+  nuof_paths= 0;
+  lost= 0;
+  depth= 1;
+  stack[0].func= func_of(uc->PC);
+  stack[0].path= path_of(-1, stack[0].func);
+  stack[0].ret_addr= 0;
+  stack[0].start= uc->ticks->get_ticks();
+  stack[0].child= 0;
+  funcs[stack[0].func].active++;
+  funcs[stack[0].func].calls++;
+}
+
+/* Functions are identified by their (called) address. Slot 0 collects
+   the functions which do not fit into the table. */
+
+int
+cl_profiler::func_of(t_addr addr)
+{
+  unsigned int h= (addr * 2654435761u) & (PROF_FUNCS-1);
+  unsigned int n;
+
+  for (n= 0; n < PROF_FUNCS-1; n++)
+    {
+      if (h == 0)
+	h= 1;
+      if (!funcs[h].used)
+	{
+	  funcs[h].used= true;
+	  funcs[h].addr= addr;
+	  return h;
+	}
+      if (funcs[h].addr == addr)
+	return h;
+      h= (h+1) & (PROF_FUNCS-1);
+    }
+  funcs[0].used= true;
+  return 0;
+}
+
+/* Call paths form a tree, a path is found by its parent and the called
+   function. When the table is full, the parent collects the time. */
+
+int
+cl_profiler::path_of(int parent, int func)
+{
+  unsigned int h= ((unsigned int)(parent+1) * 40503u + func * 2654435761u) &
+    (2*PROF_PATHS-1);
+  int p;
+
+  while ((p= path_hash[h]) >= 0)
+    {
+      if (paths[p].parent == parent &&
+	  paths[p].func == func)
+	return p;
+      h= (h+1) & (2*PROF_PATHS-1);
+    }
+  if (nuof_paths >= PROF_PATHS)
+    return (parent >= 0)?parent:0;
+  p= nuof_paths++;
+  paths[p].parent= parent;
+  paths[p].func= func;
+  paths[p].calls= 0;
+  paths[p].self= 0;
+  path_hash[h]= p;
+  return p;
+}
+
+void
+cl_profiler::call(t_addr called, t_addr ret_addr)
+{
+  if (depth >= PROF_DEPTH)
+    {
+      lost++;
+      return;
+    }
+  struct prof_frame *fr= &stack[depth];
+  fr->func= func_of(called);
+  fr->path= path_of(stack[depth-1].path, fr->func);
+  fr->ret_addr= ret_addr;
+  fr->start= uc->ticks->get_ticks();
+  fr->child= 0;
+  funcs[fr->func].calls++;
+  funcs[fr->func].active++;
+  paths[fr->path].calls++;
+  depth++;
+}
+
+/* A return closes the frame which pushed the address it returns to, and
+   all frames above it (left by longjmp or stack manipulation). Returns
+   without a matching frame are jumps, they are ignored. */
+
+void
+cl_profiler::ret(t_addr to_addr)
+{
+  int i;
+  unsigned long now;
+
+  if (lost)
+    {
+      lost--;
+      return;
+    }
+  for (i= depth-1; i > 0; i--)
+    if (stack[i].ret_addr == to_addr)
+      break;
+  if (i == 0)
+    return;
+  now= uc->ticks->get_ticks();
+  while (depth > i)
+    leave(--depth, now);
+}
+
+void
+cl_profiler::leave(int frame, unsigned long now)
+{
+  struct prof_frame *fr= &stack[frame];
+  unsigned long el= now - fr->start;
+  unsigned long self= el - fr->child;
+
+  funcs[fr->func].excl+= self;
+  paths[fr->path].self+= self;
+  if (--funcs[fr->func].active == 0)
+    funcs[fr->func].incl+= el;
+  if (frame > 0)
+    stack[frame-1].child+= el;
+}
+
+/* Time of the frames which are still open, as if they returned now */
+
+void
+cl_profiler::pending(unsigned long *incl, unsigned long *excl,
+		     unsigned long *self)
+{
+  unsigned long now= uc->ticks->get_ticks(), above= 0;
+  int i;
+  int *active= (int *)calloc(PROF_FUNCS, sizeof(int));
+
+  for (i= depth-1; i >= 0; i--)
+    {
+      struct prof_frame *fr= &stack[i];
+      unsigned long el= now - fr->start;
+      unsigned long s= el - fr->child - above;
+      excl[fr->func]+= s;
+      self[fr->path]+= s;
+      above= el;
+    }
+  // inclusive time of the outermost frame of each function
+  for (i= 0; i < depth; i++)
+    {
+      struct prof_frame *fr= &stack[i];
+      if (active[fr->func]++ == 0)
+	incl[fr->func]+= now - fr->start;
+    }
+  free(active);
+}
+
+chars
+cl_profiler::func_name(int func)
+{
+  class cl_var_by_addr_list *l= &(uc->vars->by_addr);
+  t_addr a= funcs[func].addr;
+  t_index i;
+  chars s;
+
+  if (func == 0)
+    return chars("[other]");
+  if (l->search(uc->rom, a, i))
+    return chars(l->at(i)->get_name());
+  if (i > 0 &&
+      l->at(i-1)->get_mem() == uc->rom)
+    {
+      s.format("%s+0x%x", l->at(i-1)->get_name(),
+	       AU(a - l->at(i-1)->get_addr()));
+      return s;
+    }
+  s.format("0x%06x", AU(a));
+  return s;
+}
+
+static unsigned long *sort_excl;
+
+static int
+prof_cmp(const void *a, const void *b)
+{
+  unsigned long ea= sort_excl[*(const int *)a], eb= sort_excl[*(const int *)b];
+  if (ea != eb)
+    return (ea < eb)?1:-1;
+  return *(const int *)a - *(const int *)b;
+}
+
+/* Functions ordered by exclusive time */
+
+void
+cl_profiler::report(class cl_console_base *con, int lines)
+{
+  unsigned long *incl= (unsigned long *)malloc(PROF_FUNCS * sizeof(unsigned long));
+  unsigned long *excl= (unsigned long *)malloc(PROF_FUNCS * sizeof(unsigned long));
+  unsigned long *self= (unsigned long *)calloc(PROF_PATHS, sizeof(unsigned long));
+  int *order= (int *)malloc(PROF_FUNCS * sizeof(int));
+  unsigned long total= uc->ticks->get_ticks() - stack[0].start;
+  int i, n= 0;
+
+  for (i= 0; i < PROF_FUNCS; i++)
+    {
+      incl[i]= funcs[i].incl;
+      excl[i]= funcs[i].excl;
+      if (funcs[i].used)
+	order[n++]= i;
+    }
+  pending(incl, excl, self);
+  sort_excl= excl;
+  qsort(order, n, sizeof(int), prof_cmp);
+
+  con->dd_printf("%12s %6s %12s %6s %10s  %s\n",
+		 "exclusive", "%", "inclusive", "%", "calls", "function");
+  for (i= 0; i < n && (lines <= 0 || i < lines); i++)
+    {
+      int f= order[i];
+      con->dd_printf("%12lu %6.2f %12lu %6.2f %10lu  %s\n",
+		     excl[f], total?(100.0*excl[f]/total):0.0,
+		     incl[f], total?(100.0*incl[f]/total):0.0,
+		     funcs[f].calls, func_name(f).c_str());
+    }
+  con->dd_printf("%lu ticks, %d functions, %d call paths, depth %d\n",
+		 total, n, nuof_paths, depth);
+  if (lost || nuof_paths >= PROF_PATHS || funcs[0].used)
+    con->dd_printf("Warning: tables of the profiler are full, some of the "
+		   "calls are not followed\n");
+  free(incl);
+  free(excl);
+  free(self);
+  free(order);
+}
+
+/* One line for every call path: names of the functions separated by
+   semicolons, followed by the ticks spent in the last one */
+
+int
+cl_profiler::folded(FILE *f)
+{
+  unsigned long *incl= (unsigned long *)calloc(PROF_FUNCS, sizeof(unsigned long));
+  unsigned long *excl= (unsigned long *)calloc(PROF_FUNCS, sizeof(unsigned long));
+  unsigned long *self= (unsigned long *)malloc(PROF_PATHS * sizeof(unsigned long));
+  chars *names= new chars[PROF_FUNCS];
+  int p, q, i, n= 0;
+  int chain[PROF_DEPTH];
+
+  for (p= 0; p < nuof_paths; p++)
+    self[p]= paths[p].self;
+  pending(incl, excl, self);
+  for (p= 0; p < nuof_paths; p++)
+    {
+      if (!self[p])
+	continue;
+      for (i= 0, q= p; q >= 0 && i < PROF_DEPTH; q= paths[q].parent)
+	chain[i++]= paths[q].func;
+      while (i--)
+	{
+	  int fn= chain[i];
+	  if (names[fn].empty())
+	    names[fn]= func_name(fn);
+	  fprintf(f, "%s%c", names[fn].c_str(), i?';':' ');
+	}
+      fprintf(f, "%lu\n", self[p]);
+      n++;
+    }
+  delete [] names;
+  free(incl);
+  free(excl);
+  free(self);
+  return n;
+}
+
+
+/* End of sim.src/prof.cc */
@@ -0,0 +1,112 @@
+/*
+ * Simulator of microcontrollers (profcl.h)
+ *
+ * Copyright (C) 2026 Drotos Daniel
+ * 
+ * To contact author send email to dr.dkdb@gmail.com
+ *
+ */
+
+/* This file is part of microcontroller simulator: ucsim.
+
+UCSIM is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+UCSIM is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with UCSIM; see the file COPYING.  If not, write to the Free
+Software Foundation, 59 Temple Place - Suite 330, Boston, MA
+02111-1307, USA. */
+/*@1@*/
+
+#ifndef PROFCL_HEADER
+#define PROFCL_HEADER
+
+#include <stdio.h>
+
+#include "stypes.h"
+#include "pobjcl.h"
+#include "charscl.h"
+
+
+/*
+ * Call graph profiler
+ *
+ * Calls and returns reported by the simulators drive a shadow stack of
+ * fixed size. Clock ticks are accumulated per called address (inclusive
+ * and exclusive) and per distinct call path, the latter is printed as
+ * folded stacks for flame graph tools. Tables are allocated when the
+ * profiler is started, nothing is allocated while it runs.
+ */
+
+#define PROF_DEPTH	256	// depth of the shadow stack
+#define PROF_FUNCS	4096	// number of distinct functions, power of 2
+#define PROF_PATHS	16384	// number of distinct call paths, power of 2
+
+struct prof_func
+{
+  t_addr addr;
+  bool used;
+  int active;			// number of frames on the shadow stack
+  unsigned long calls;
+  unsigned long incl, excl;
+};
+
+struct prof_path
+{
+  int parent;			// -1 for the root
+  int func;
+  unsigned long calls;
+  unsigned long self;
+};
+
+struct prof_frame
+{
+  int func;
+  int path;
+  t_addr ret_addr;		// return address pushed by the call
+  unsigned long start;		// ticks at entry
+  unsigned long child;		// ticks spent in finished callees
+};
+
+class cl_profiler: public cl_base
+{
+ protected:
+  class cl_uc *uc;
+  struct prof_func *funcs;
+  struct prof_path *paths;
+  int *path_hash;		// index of paths, -1 if empty
+  int nuof_paths;
+  struct prof_frame stack[PROF_DEPTH];
+  int depth;
+  int lost;			// calls not followed because of full tables
+ public:
+  cl_profiler(class cl_uc *auc);
+  virtual ~cl_profiler(void);
+  virtual int init(void);
+
+  void call(t_addr called, t_addr ret_addr);
+  void ret(t_addr to_addr);
+
+  virtual void report(class cl_console_base *con, int lines);
+  virtual int folded(FILE *f);
+ protected:
+  void clear(void);
+  int func_of(t_addr addr);
+  int path_of(int parent, int func);
+  void leave(int frame, unsigned long now);
+  void pending(unsigned long *incl, unsigned long *excl,
+	       unsigned long *self);
+  chars func_name(int func);
+};
+
+
+#endif
+
+/* End of sim.src/profcl.h */
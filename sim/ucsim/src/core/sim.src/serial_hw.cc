@@ -34,6 +34,7 @@ Software Foundation, 59 Temple Place - Suite 330, Boston, MA
 //#include "fiocl.h"
 
 #include "serial_hwcl.h"
+#include "statecl.h"
 
 
 bool
@@ -835,6 +836,25 @@ cl_serial_hw::reset(void)
   skip_nl= 0;
 }
 
+void
+cl_serial_hw::checkpoint(class cl_state_file *sf)
+{
+  cl_hw::checkpoint(sf);
+  sf->var(s_in);
+  sf->var(s_out);
+  sf->var(s_txd);
+  sf->var(s_sending);
+  sf->var(s_receiving);
+  sf->var(s_tx_written);
+  sf->var(s_rec_bit);
+  sf->var(s_tr_bit);
+  sf->var(bits);
+  sf->var(ren);
+  sf->var(ten);
+  sf->var(cpb);
+  sf->var(mcnt);
+}
+
 bool
 cl_serial_hw::prediv_bitcnt(int cycles)
 {
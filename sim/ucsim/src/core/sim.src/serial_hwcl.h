@@ -129,6 +129,7 @@ public:
   virtual void draw_display(void) {}
   
   virtual void reset(void);
+  virtual void checkpoint(class cl_state_file *sf);
   virtual bool prediv_bitcnt(int cycles);
 };
 
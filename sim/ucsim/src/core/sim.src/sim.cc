@@ -45,6 +45,7 @@ Software Foundation, 59 Temple Place - Suite 330, Boston, MA
 //#include "simcl.h"
 //#include "appcl.h"
 #include "simifcl.h"
+#include "varcl.h"
 
 
 /*
@@ -57,6 +58,7 @@ cl_sim::cl_sim(class cl_app *the_app):
   app= the_app;
   uc= 0;
   state= SIM_NONE;
+  rgdb= NULL;
   //arguments= new cl_list(2, 2);
   //accept_args= more_args?strdup(more_args):0;
   gui= new cl_gui(this);
@@ -203,6 +205,8 @@ cl_sim::stop(int reason)
 
   state&= ~(SIM_GO|SIM_EMU);
   stop_at= dnow();
+  if (uc)
+    uc->sim_stopped();
   if (simif)
     simif->cfg_set(simif_reason, reason);
 
@@ -326,6 +330,15 @@ cl_sim::stop(int reason)
       cmd->freeze(0);
     }
 
+  if (!(state & SIM_GO) &&
+      rgdb)
+    {
+      // report stop to the gdb client which started the simulation
+      class cl_rgdb *g= rgdb;
+      rgdb= NULL;
+      g->stopped(reason);
+    }
+
   bool q_opt= false;
   if (o)
     o->get_value(&q_opt);
@@ -433,6 +446,19 @@ cl_rgdb::cl_rgdb(cl_f *fi, cl_f *fo, class cl_app *the_app, class cl_sim *asim):
   cl_console(fi, fo, the_app)
 {
   sim= asim;
+  regs= NULL;
+}
+
+cl_rgdb::~cl_rgdb(void)
+{
+  if (sim &&
+      (sim->rgdb == this))
+    sim->rgdb= NULL;
+  if (regs)
+    {
+      regs->disconn_all();
+      delete regs;
+    }
 }
 
 int
@@ -447,10 +473,43 @@ cl_rgdb::init(void)
   thread_id_reported= false;
   fin->echo(NULL);
   ack= true;
+  last_reason= resBREAKPOINT;
+  pkt_state= 0;
+  pkt_len= 0;
   //reply("S13");
   return 0;
 }
 
+static int
+hexval(int c)
+{
+  if ((c >= '0') && (c <= '9'))
+    return c - '0';
+  if ((c >= 'a') && (c <= 'f'))
+    return c - 'a' + 10;
+  if ((c >= 'A') && (c <= 'F'))
+    return c - 'A' + 10;
+  return -1;
+}
+
+/* Parse a hex number, leaves *s on the first non-hex char */
+
+static t_mem
+hexnum(const char **s)
+{
+  t_mem v= 0;
+  int d;
+  while ((d= hexval(**s)) >= 0)
+    {
+      v= (v << 4) | d;
+      (*s)++;
+    }
+  return v;
+}
+
+/* Collect one packet into pkt (escapes removed), return 1 when a
+   complete packet is received */
+
 int
 cl_rgdb::read_line(void)
 {
@@ -468,32 +527,57 @@ cl_rgdb::read_line(void)
       }
     else if (i > 0)
       {
-	if (lbuf.empty())
+	u8_t c= b[0];
+	switch (pkt_state)
 	  {
-	    if (b[0] == '$')
-	      lbuf+= (char)(b[0]);
-	    else if (b[0] == '+')
+	  case 0: // outside of packet
+	    if (c == '$')
 	      {
+		pkt_len= 0;
+		csum= 0;
+		pkt_state= 1;
 	      }
-	    else if (b[0] == '-')
+	    else if (c == 3)
 	      {
+		// Ctrl-C from gdb
+		if (sim->state & SIM_GO)
+		  sim->stop(resUSER);
 	      }
-	    else if (b[0] == 3)
+	    // '+' and '-' acks are ignored
+	    break;
+	  case 1: // payload
+	    if (c == '#')
 	      {
-		// Ctrl-C from gdb
+		pkt_state= 3;
+		break;
 	      }
-	  }
-	else
-	  {
-	    lbuf+= (char)(b[0]);
-	    int p= lbuf.pos('#');
-	    if (p >= 0)
+	    csum+= c;
+	    if (c == '}')
+	      pkt_state= 2;
+	    else if (pkt_len < (int)sizeof(pkt)-1)
+	      pkt[pkt_len++]= c;
+	    break;
+	  case 2: // escaped byte of payload
+	    csum+= c;
+	    if (pkt_len < (int)sizeof(pkt)-1)
+	      pkt[pkt_len++]= c ^ 0x20;
+	    pkt_state= 1;
+	    break;
+	  case 3: // checksum
+	    rcsum= hexval(c) << 4;
+	    pkt_state= 4;
+	    break;
+	  case 4:
+	    rcsum|= hexval(c);
+	    pkt_state= 0;
+	    pkt[pkt_len]= 0;
+	    if (ack &&
+		(rcsum != csum))
 	      {
-		if (lbuf.len() > p+2)
-		  {
-		    return 1;
-		  }
+		send("-");
+		break;
 	      }
+	    return 1;
 	  }
       }
   }
@@ -504,7 +588,6 @@ cl_rgdb::read_line(void)
 int
 cl_rgdb::proc_input(class cl_cmdset *cmdset)
 {
-  chars r;
   int i= read_line();
   if (i < 0)
     {
@@ -518,26 +601,49 @@ cl_rgdb::proc_input(class cl_cmdset *cmdset)
     {
       send("+");
     }
-  switch (lbuf.c_str()[1])
+  const char *l= (const char *)pkt;
+  switch (l[0])
     {
-    case 'q': case 'Q': procq(lbuf); break;
+    case 'q': case 'Q': procq(l); break;
+    case 'v': procv(l); break;
     case 'H': reply("OK"); break;
-    case '?': reply("S13"); break;
+    case 'T': reply("OK"); break;
+    case '?': reply(stop_reply(last_reason)); break;
     case 'g': procg(); break;
+    case 'G': procG(l+1); break;
+    case 'p': procp(l+1); break;
+    case 'P': procP(l+1); break;
+    case 'm': procm(l+1); break;
+    case 'M': procM(l+1); break;
+    case 'X': procX(pkt_len); break;
+    case 'Z': procZ(l+1, true); break;
+    case 'z': procZ(l+1, false); break;
+    case 'c': resume(false, l+1); break;
+    case 's': resume(true, l+1); break;
+    case 'C': case 'S':
+      {
+	// signal is ignored, optional address follows it
+	const char *a= strchr(l, ';');
+	resume(l[0] == 'S', a?(a+1):"");
+	break;
+      }
+    case 'D':
+      reply("OK");
+      return 1;
+    case 'k':
+      return 1;
     default:
       reply("");
       break;
     }
-  lbuf= 0;
   return 0;
 }
 
 
 int
-cl_rgdb::procq(chars l)
+cl_rgdb::procq(const char *l)
 {
-  chars q= &(l.c_str()[2]);
-  q.rrip(3);
+  chars q= &(l[1]);
   chars t= q.token(";#:");
   chars r;
 
@@ -553,36 +659,32 @@ cl_rgdb::procq(chars l)
       else
 	reply("l");
     }
-  else if (t == "C") reply("qC1");
+  else if (t == "C") reply("QC1");
   else if (t == "Attached") reply("1");
   else if (t == "Supported")
-    reply("PacketSize=7fff;QStartNoAckMode+;qXfer:features:read+");
+    reply("PacketSize=7fff;QStartNoAckMode+;qXfer:features:read+;"
+	  "qXfer:memory-map:read+;vContSupported+");
   else if (t == "TStatus") reply("");
   else if (t == "StartNoAckMode")
     {
-      ack= false;
       reply("OK");
+      ack= false;
     }
   else if (t == "Xfer")
     {
       t= q.token(";#:");
-      if (t == "features")
-	{
-	  t= q.token(";#:");
-	  if (t == "read")
-	    {
-	      chars t;
-	      t= "l<?xml version=\"1.0\"?>\n"
-		"<!DOCTYPE target SYSTEM \"gdb-target.dtd\">\n"
-		"<target>\n"
-		"<architecture>ucsim</architecture>\n"
-		"<feature name=\"ucsim_feat\">\n"
-		"<reg name=\"r\" bitsize=\"8\" type=\"int8\" regnum=\"0\"/>\n"
-		"</feature>\n"
-                "</target>\n";
-		reply(t);
-	    }	      
-	}
+      chars op= q.token(";#:");
+      chars annex= q.token(";#:");
+      chars range= q.token(";#:");
+      if (op != "read")
+	reply("E00");
+      else if ((t == "features") &&
+	       (annex == "target.xml"))
+	xfer(target_xml(), range.c_str());
+      else if (t == "memory-map")
+	xfer(memory_map_xml(), range.c_str());
+      else
+	reply("");
     }
   else
     reply("");
@@ -590,34 +692,630 @@ cl_rgdb::procq(chars l)
   return 0;
 }
 
+int
+cl_rgdb::procv(const char *l)
+{
+  if (strncmp(l, "vCont?", 6) == 0)
+    return reply("vCont;c;C;s;S;t");
+  if (strncmp(l, "vCont;", 6) == 0)
+    {
+      // only one thread exists, the first action applies to it
+      const char *a= &l[6];
+      switch (*a)
+	{
+	case 'c': case 'C': return resume(false, "");
+	case 's': case 'S': return resume(true, "");
+	case 't':
+	  if (sim->state & SIM_GO)
+	    sim->stop(resUSER);
+	  else
+	    reply("OK");
+	  return 0;
+	}
+      return reply("E01");
+    }
+  if (strncmp(l, "vMustReplyEmpty", 15) == 0)
+    return reply("");
+  return reply("");
+}
+
+
+/*
+ * Registers
+ *
+ * Register 0 is PC, others are the CPU register variables of the
+ * controller (defined by the simulator, not by the user).
+ */
+
+void
+cl_rgdb::collect_regs(void)
+{
+  class cl_uc *uc= sim->get_uc();
+  int i;
+
+  if (regs)
+    return;
+  regs= new cl_list(2, 2, "gdb registers");
+  if (!uc ||
+      !uc->vars)
+    return;
+  for (i= 0; i < uc->vars->by_name.count; i++)
+    {
+      class cl_cvar *v= uc->vars->by_name.at(i);
+      if ((strcmp(v->get_name(), "PC") == 0) &&
+	  v->get_cell())
+	regs->add(v);
+    }
+  for (i= 0; i < uc->vars->by_name.count; i++)
+    {
+      class cl_cvar *v= uc->vars->by_name.at(i);
+      if ((v->defined_by != VBY_PRE) ||
+	  v->is_mem_var() ||
+	  (v->bitnr_high >= 0) ||
+	  !v->get_cell() ||
+	  (strcmp(v->get_name(), "PC") == 0) ||
+	  (strcmp(v->get_name(), "cperiod") == 0) ||
+	  (strcmp(v->get_name(), "ccyc") == 0))
+	continue;
+      regs->add(v);
+    }
+}
+
+int
+cl_rgdb::reg_size(int nr)
+{
+  collect_regs();
+  if ((nr < 0) ||
+      (nr >= regs->count))
+    return 0;
+  class cl_cvar *v= (class cl_cvar *)(regs->at(nr));
+  return (v->get_cell()->get_width()+7)/8;
+}
+
+t_mem
+cl_rgdb::reg_get(int nr)
+{
+  collect_regs();
+  if ((nr < 0) ||
+      (nr >= regs->count))
+    return 0;
+  class cl_cvar *v= (class cl_cvar *)(regs->at(nr));
+  return v->get_cell()->get();
+}
+
+void
+cl_rgdb::reg_set(int nr, t_mem val)
+{
+  collect_regs();
+  if ((nr < 0) ||
+      (nr >= regs->count))
+    return;
+  class cl_cvar *v= (class cl_cvar *)(regs->at(nr));
+  v->write(val);
+}
 
 /* Report register values */
 
 int
 cl_rgdb::procg(void)
 {
-  reply("00");
+  chars r= "";
+  int i, j, n;
+
+  collect_regs();
+  for (i= 0; i < regs->count; i++)
+    {
+      t_mem v= reg_get(i);
+      n= reg_size(i);
+      for (j= 0; j < n; j++)
+	r.appendf("%02x", (v >> (j*8)) & 0xff);
+    }
+  if (r.empty())
+    r= "00";
+  return reply(r);
+}
+
+int
+cl_rgdb::procG(const char *l)
+{
+  int i, j, n;
+
+  collect_regs();
+  for (i= 0; i < regs->count; i++)
+    {
+      t_mem v= 0;
+      n= reg_size(i);
+      for (j= 0; j < n; j++)
+	{
+	  if (!l[0] || !l[1])
+	    return reply("E01");
+	  v|= (t_mem)((hexval(l[0]) << 4) | hexval(l[1])) << (j*8);
+	  l+= 2;
+	}
+      reg_set(i, v);
+    }
+  return reply("OK");
+}
+
+int
+cl_rgdb::procp(const char *l)
+{
+  int nr= hexnum(&l), j;
+  chars r= "";
+
+  if (reg_size(nr) == 0)
+    return reply("E01");
+  t_mem v= reg_get(nr);
+  for (j= 0; j < reg_size(nr); j++)
+    r.appendf("%02x", (v >> (j*8)) & 0xff);
+  return reply(r);
+}
+
+int
+cl_rgdb::procP(const char *l)
+{
+  int nr= hexnum(&l), j, n;
+  t_mem v= 0;
+
+  n= reg_size(nr);
+  if ((n == 0) ||
+      (*l != '='))
+    return reply("E01");
+  l++;
+  for (j= 0; (j < n) && l[0] && l[1]; j++, l+= 2)
+    v|= (t_mem)((hexval(l[0]) << 4) | hexval(l[1])) << (j*8);
+  reg_set(nr, v);
+  return reply("OK");
+}
+
+
+/*
+ * Memory
+ *
+ * ROM is mapped to gdb address 0, other address spaces follow it at
+ * 16MB boundaries in the order they are listed by "info memory".
+ */
+
+class cl_address_space *
+cl_rgdb::gdb_mem(t_addr gaddr, t_addr *addr)
+{
+  class cl_uc *uc= sim->get_uc();
+  int region= (gaddr >> 24) & 0xff, i, n= 0;
+  class cl_address_space *as= NULL;
+
+  if (!uc)
+    return NULL;
+  if (region == 0)
+    as= uc->rom;
+  else
+    for (i= 0; i < uc->address_spaces->count; i++)
+      {
+	class cl_address_space *m=
+	  (class cl_address_space *)(uc->address_spaces->at(i));
+	if (m == uc->rom)
+	  continue;
+	if (++n == region)
+	  {
+	    as= m;
+	    break;
+	  }
+      }
+  if (as && addr)
+    *addr= gaddr & 0xffffff;
+  return as;
+}
+
+t_addr
+cl_rgdb::gdb_addr(class cl_address_space *as, t_addr addr)
+{
+  class cl_uc *uc= sim->get_uc();
+  int i, n= 0;
+
+  if (as == uc->rom)
+    return addr;
+  for (i= 0; i < uc->address_spaces->count; i++)
+    {
+      class cl_address_space *m=
+	(class cl_address_space *)(uc->address_spaces->at(i));
+      if (m == uc->rom)
+	continue;
+      n++;
+      if (m == as)
+	break;
+    }
+  return ((t_addr)n << 24) | addr;
+}
+
+/* Bytes of cells wider than 8 bits are transferred in little endian
+   order, one gdb address per cell */
+
+bool
+cl_rgdb::mem_set(t_addr gaddr, u8_t val)
+{
+  t_addr a;
+  class cl_uc *uc= sim->get_uc();
+  class cl_address_space *as= gdb_mem(gaddr, &a);
+  if (!as ||
+      !as->valid_address(a))
+    return false;
+  if (as == uc->rom)
+    as->download(a, val);
+  else
+    as->write(a, val);
+  return true;
+}
+
+int
+cl_rgdb::procm(const char *l)
+{
+  t_addr addr= hexnum(&l);
+  int len, i, j, n;
+  chars r= "";
+  t_addr a;
+  class cl_address_space *as;
+
+  if (*l++ != ',')
+    return reply("E01");
+  len= hexnum(&l);
+  as= gdb_mem(addr, &a);
+  if (!as)
+    return reply("E02");
+  n= mem_unit(as);
+  for (i= 0; i < len; )
+    {
+      if (!as->valid_address(a))
+	break;
+      t_mem v= as->get(a);
+      for (j= 0; (j < n) && (i < len); j++, i++)
+	r.appendf("%02x", (v >> (j*8)) & 0xff);
+      a++;
+    }
+  if (r.empty() &&
+      (len > 0))
+    return reply("E03");
+  return reply(r);
+}
+
+int
+cl_rgdb::procM(const char *l)
+{
+  t_addr addr= hexnum(&l), a;
+  int len, i;
+  class cl_address_space *as;
+
+  if (*l++ != ',')
+    return reply("E01");
+  len= hexnum(&l);
+  if (*l++ != ':')
+    return reply("E01");
+  as= gdb_mem(addr, &a);
+  if (!as)
+    return reply("E02");
+  if (mem_unit(as) > 1)
+    return reply("E04");
+  for (i= 0; i < len; i++, l+= 2)
+    {
+      if (!l[0] || !l[1])
+	return reply("E01");
+      if (!mem_set(addr+i, (hexval(l[0]) << 4) | hexval(l[1])))
+	return reply("E03");
+    }
+  return reply("OK");
+}
+
+/* Binary download, data follows the colon unescaped (in pkt) */
+
+int
+cl_rgdb::procX(int plen)
+{
+  const char *l= (const char *)&pkt[1];
+  t_addr addr= hexnum(&l), a;
+  int len, i, data;
+  class cl_address_space *as;
+
+  if (*l++ != ',')
+    return reply("E01");
+  len= hexnum(&l);
+  if (*l++ != ':')
+    return reply("E01");
+  data= l - (const char *)pkt;
+  if (len > plen - data)
+    return reply("E01");
+  if (len == 0)
+    // probe for X support
+    return reply("OK");
+  as= gdb_mem(addr, &a);
+  if (!as)
+    return reply("E02");
+  if (mem_unit(as) > 1)
+    return reply("E04");
+  for (i= 0; i < len; i++)
+    if (!mem_set(addr+i, pkt[data+i]))
+      return reply("E03");
+  return reply("OK");
+}
+
+
+/*
+ * Breakpoints and watchpoints
+ */
+
+int
+cl_rgdb::procZ(const char *l, bool set)
+{
+  class cl_uc *uc= sim->get_uc();
+  int type= hexnum(&l), len, i;
+  t_addr addr, a;
+  class cl_address_space *as;
+
+  if (*l++ != ',')
+    return reply("E01");
+  addr= hexnum(&l);
+  if (*l++ != ',')
+    return reply("E01");
+  len= hexnum(&l);
+  as= gdb_mem(addr, &a);
+  if (!as)
+    return reply("E02");
+
+  if ((type == 0) ||
+      (type == 1))
+    {
+      // soft and hard breakpoints are both fetch breakpoints
+      if (as != uc->rom)
+	return reply("E02");
+      if (set)
+	{
+	  if (!uc->fbrk->bp_at(a))
+	    {
+	      class cl_brk *b= new cl_fetch_brk(uc->rom, uc->make_new_brknr(),
+						a, brkFIX, 1);
+	      b->init();
+	      uc->fbrk->add_bp(b);
+	    }
+	}
+      else if (uc->fbrk->bp_at(a))
+	uc->fbrk->del_bp(a);
+      return reply("OK");
+    }
+
+  if ((type < 2) ||
+      (type > 4))
+    return reply("");
+
+  const char *id= (type==2)?"write":((type==3)?"read":"access");
+  char op= (type==2)?'w':((type==3)?'r':'a');
+  if (len < 1)
+    len= 1;
+  for (i= 0; i < len; i++)
+    {
+      class cl_ev_brk *b= uc->ebrk_at(a+i, (char*)id);
+      if (set)
+	{
+	  if (b &&
+	      (b->get_mem() == as))
+	    continue;
+	  b= uc->mk_ebrk(brkFIX, as, op, a+i, 1);
+	  if (!b)
+	    return reply("E03");
+	  uc->ebrk->add_bp(b);
+	}
+      else
+	{
+	  int j;
+	  for (j= 0; j < uc->ebrk->count; j++)
+	    {
+	      b= (class cl_ev_brk *)(uc->ebrk->at(j));
+	      if ((b->get_mem() == as) &&
+		  (b->addr == a+i) &&
+		  (strcmp(b->id, id) == 0))
+		{
+		  uc->ebrk->del_bp(j, 0);
+		  break;
+		}
+	    }
+	}
+    }
+  return reply("OK");
+}
+
+
+/*
+ * Execution
+ */
+
+int
+cl_rgdb::resume(bool step, const char *l)
+{
+  class cl_uc *uc= sim->get_uc();
+
+  if (!uc)
+    return reply("E01");
+  if (*l)
+    {
+      t_addr addr= hexnum(&l);
+      uc->set_PC(addr);
+    }
+  sim->rgdb= this;
+  // reply is sent by stopped() when simulation stops
+  sim->start(NULL, step?1:0);
   return 0;
 }
 
+void
+cl_rgdb::stopped(int reason)
+{
+  last_reason= reason;
+  reply(stop_reply(reason));
+}
+
+chars
+cl_rgdb::stop_reply(int reason)
+{
+  class cl_uc *uc= sim->get_uc();
+  chars r;
+
+  switch (reason)
+    {
+    case resUSER:
+      r= "S02"; // SIGINT
+      break;
+    case resINV_INST:
+      r= "S04"; // SIGILL
+      break;
+    case resINV_ADDR: case resSTACK_OV:
+      r= "S0b"; // SIGSEGV
+      break;
+    case resEVENTBREAK:
+      {
+	r= "T05";
+	if (uc &&
+	    uc->events->count)
+	  {
+	    class cl_ev_brk *b= (class cl_ev_brk *)(uc->events->at(0));
+	    const char *w= "awatch";
+	    if (b->get_event() == brkWRITE)
+	      w= "watch";
+	    else if (b->get_event() == brkREAD)
+	      w= "rwatch";
+	    if (b->get_mem())
+	      r.appendf("%s:%x;", w, AU(gdb_addr(b->get_mem(), b->addr)));
+	  }
+	break;
+      }
+    default:
+      r= "S05"; // SIGTRAP
+      break;
+    }
+  return r;
+}
+
+
+/*
+ * qXfer documents
+ */
+
+chars
+cl_rgdb::target_xml(void)
+{
+  chars t;
+  int i;
+
+  collect_regs();
+  t= "<?xml version=\"1.0\"?>\n"
+    "<!DOCTYPE target SYSTEM \"gdb-target.dtd\">\n"
+    "<target>\n"
+    "<architecture>ucsim</architecture>\n"
+    "<feature name=\"ucsim_feat\">\n";
+  for (i= 0; i < regs->count; i++)
+    {
+      class cl_cvar *v= (class cl_cvar *)(regs->at(i));
+      t.appendf("<reg name=\"%s\" bitsize=\"%d\" type=\"%s\" regnum=\"%d\"/>\n",
+		v->get_name(), reg_size(i)*8,
+		(i==0)?"code_ptr":"int", i);
+    }
+  t+= "</feature>\n"
+    "</target>\n";
+  return t;
+}
+
+chars
+cl_rgdb::memory_map_xml(void)
+{
+  class cl_uc *uc= sim->get_uc();
+  chars t;
+  int i;
+
+  t= "<?xml version=\"1.0\"?>\n"
+    "<!DOCTYPE memory-map PUBLIC \"+//IDN gnu.org//DTD GDB Memory Map V1.0//EN\""
+    " \"http://sourceware.org/gdb/gdb-memory-map.dtd\">\n"
+    "<memory-map>\n";
+  if (uc)
+    {
+      if (uc->rom)
+	t.appendf("<memory type=\"ram\" start=\"0x%x\" length=\"0x%x\"/>\n",
+		  AU(uc->rom->get_start_address()), AU(uc->rom->get_size()));
+      for (i= 0; i < uc->address_spaces->count; i++)
+	{
+	  class cl_address_space *m=
+	    (class cl_address_space *)(uc->address_spaces->at(i));
+	  if (m == uc->rom)
+	    continue;
+	  t.appendf("<memory type=\"ram\" start=\"0x%x\" length=\"0x%x\"/>\n",
+		    AU(gdb_addr(m, m->get_start_address())),
+		    AU(m->get_size()));
+	}
+    }
+  t+= "</memory-map>\n";
+  return t;
+}
+
+/* Send requested part of a document as a qXfer reply */
+
+int
+cl_rgdb::xfer(const chars &doc, const char *range)
+{
+  t_addr offset= hexnum(&range);
+  int length;
+
+  if (*range++ != ',')
+    return reply("E01");
+  length= hexnum(&range);
+  if ((int)offset >= doc.len())
+    return reply("l");
+  if ((int)offset + length >= doc.len())
+    return reply_bin("l", doc.c_str()+offset, doc.len()-offset);
+  return reply_bin("m", doc.c_str()+offset, length);
+}
+
 
 int
 cl_rgdb::reply(const char *s)
+{
+  return reply_bin("", s, strlen(s));
+}
+
+/* Send a packet, escaping chars which are special in the protocol */
+
+int
+cl_rgdb::reply_bin(const char *prefix, const char *s, int len)
 {
   u8_t sum= 0;
   int i;
-  for (i= 0; s[i]; i++)
-    sum+= s[i];
-  chars m;
-  m.format("$%s#%02x", s, sum);
+  chars m= "$";
+
+  for (i= 0; prefix[i]; i++)
+    {
+      sum+= prefix[i];
+      m+= prefix[i];
+    }
+  for (i= 0; i < len; i++)
+    {
+      char c= s[i];
+      if ((c == '#') ||
+	  (c == '$') ||
+	  (c == '}') ||
+	  (c == '*'))
+	{
+	  sum+= '}';
+	  m+= '}';
+	  c^= 0x20;
+	}
+      sum+= c;
+      m+= c;
+    }
+  m.appendf("#%02x", sum);
   send(m.c_str());
   return 0;
 }
 
 void
-cl_rgdb::send(const char *s)
+cl_rgdb::send(const char *s, int len)
 {
-  dd_printf("%s", s);
+  class cl_f *fo= get_fout();
+  if (!fo)
+    return;
+  fo->write(s, (len<0)?strlen(s):len);
   fflush(NULL);
 }
 
@@ -60,6 +60,7 @@ public:
   unsigned long steps_done;
   unsigned long steps_todo; // use this if not 0
   u32_t         exec_limit; // max nr of instr in run/step
+  class cl_rgdb *rgdb;      // gdb client waiting for a stop reply
   
 public:
   cl_sim(class cl_app *the_app);
@@ -95,16 +96,50 @@ protected:
   class cl_sim *sim;
   bool thread_id_reported;
   bool ack;
+  int last_reason;
+  class cl_list *regs;	// cvars reported as gdb registers
+  // packet reception
+  int pkt_state;
+  int pkt_len;
+  u8_t csum, rcsum;
+  u8_t pkt[0x8000];
 public:
   cl_rgdb(cl_f *fi, cl_f *fo, class cl_app *the_app, class cl_sim *asim);
+  virtual ~cl_rgdb(void);
   virtual int init(void);
   virtual int read_line(void);
   virtual int proc_input(class cl_cmdset *cmdset);
-  virtual int procq(chars l);
+  virtual int cmd_do_print(const char *format, va_list ap) { return 0; }
+  virtual int cmd_do_cprint(const char *color_name, const char *format, va_list ap) { return 0; }
+  virtual int procq(const char *l);
+  virtual int procv(const char *l);
   virtual int procg(void);
+  virtual int procG(const char *l);
+  virtual int procp(const char *l);
+  virtual int procP(const char *l);
+  virtual int procm(const char *l);
+  virtual int procM(const char *l);
+  virtual int procX(int len);
+  virtual int procZ(const char *l, bool set);
+  virtual int resume(bool step, const char *l);
+  virtual void stopped(int reason);
   virtual int reply(const char *s);
   virtual int reply(chars s) { return reply(s.c_str()); }
-  virtual void send(const char *s);
+  virtual int reply_bin(const char *prefix, const char *s, int len);
+  virtual void send(const char *s, int len= -1);
+protected:
+  virtual void collect_regs(void);
+  virtual int reg_size(int nr);
+  virtual t_mem reg_get(int nr);
+  virtual void reg_set(int nr, t_mem val);
+  virtual class cl_address_space *gdb_mem(t_addr gaddr, t_addr *addr);
+  virtual t_addr gdb_addr(class cl_address_space *as, t_addr addr);
+  virtual int mem_unit(class cl_address_space *as) { return (as->width+7)/8; }
+  virtual bool mem_set(t_addr gaddr, u8_t val);
+  virtual chars stop_reply(int reason);
+  virtual chars target_xml(void);
+  virtual chars memory_map_xml(void);
+  virtual int xfer(const chars &doc, const char *range);
 };
 
 
@@ -0,0 +1,374 @@
+/*
+ * Simulator of microcontrollers (state.cc)
+ *
+ * Copyright (C) 2026 Drotos Daniel
+ * 
+ * To contact author send email to dr.dkdb@gmail.com
+ *
+ */
+
+/* This file is part of microcontroller simulator: ucsim.
+
+UCSIM is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+UCSIM is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with UCSIM; see the file COPYING.  If not, write to the Free
+Software Foundation, 59 Temple Place - Suite 330, Boston, MA
+02111-1307, USA. */
+/*@1@*/
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+// prj
+#include "stypes.h"
+
+// sim
+#include "uccl.h"
+#include "hwcl.h"
+#include "memcl.h"
+#include "itsrccl.h"
+
+// local
+#include "statecl.h"
+
+
+/*
+ * State file
+ */
+
+cl_state_file::cl_state_file(FILE *af, bool asaving):
+  cl_base()
+{
+  f= af;
+  saving= asaving;
+  error= false;
+}
+
+void
+cl_state_file::block(void *data, size_t len)
+{
+  if (error ||
+      !len)
+    return;
+  if (saving)
+    {
+      if (fwrite(data, 1, len, f) != len)
+	error= true;
+    }
+  else
+    {
+      if (fread(data, 1, len, f) != len)
+	error= true;
+    }
+}
+
+/* Names are stored as length and characters. Loading fails if the name
+   read from the file is not the expected one. */
+
+bool
+cl_state_file::tag(const char *name)
+{
+  u16_t l= name?strlen(name):0;
+  if (saving)
+    {
+      var(l);
+      block((void*)name, l);
+      return ok();
+    }
+  u16_t fl= 0;
+  var(fl);
+  if (error)
+    return false;
+  if (fl != l)
+    {
+      error= true;
+      return false;
+    }
+  char *s= (char*)malloc(l+1);
+  block(s, l);
+  if (!error &&
+      l &&
+      memcmp(s, name, l) != 0)
+    error= true;
+  free(s);
+  return ok();
+}
+
+bool
+cl_state_file::header(void)
+{
+  char magic[8];
+  u32_t version= STATE_VERSION;
+
+  memcpy(magic, STATE_MAGIC, 8);
+  block(magic, 8);
+  var(version);
+  if (!saving &&
+      (memcmp(magic, STATE_MAGIC, 8) != 0 ||
+       version != STATE_VERSION))
+    error= true;
+  return ok();
+}
+
+
+/*
+ * Saving and restoring state of the uc
+ */
+
+int
+cl_uc::save_state(const char *fname, class cl_console_base *con)
+{
+  return state_file(fname, true, con);
+}
+
+int
+cl_uc::load_state(const char *fname, class cl_console_base *con)
+{
+  return state_file(fname, false, con);
+}
+
+int
+cl_uc::state_file(const char *fname, bool saving, class cl_console_base *con)
+{
+  FILE *f;
+  const char *err= NULL;
+
+  if ((f= fopen(fname, saving?"wb":"rb")) == NULL)
+    err= strerror(errno);
+  else
+    {
+      class cl_state_file *sf= new cl_state_file(f, saving);
+      if (!sf->header())
+	err= "not a state file of this version";
+      else if (!sf->tag(type?type->type_str:id_string()))
+	err= "state was saved by a different CPU type";
+      else
+	{
+	  checkpoint_memory(sf);
+	  checkpoint(sf);
+	  checkpoint_hws(sf);
+	  if (!sf->ok())
+	    err= "truncated, or saved with a different configuration";
+	}
+      if (fclose(f) != 0 &&
+	  saving)
+	err= strerror(errno);
+      delete sf;
+    }
+  if (err)
+    {
+      if (con)
+	con->dd_printf("Error: %s `%s': %s\n",
+		       saving?"saving state to":"loading state from",
+		       fname, err);
+      else
+	fprintf(stderr, "Error: %s `%s': %s\n",
+		saving?"saving state to":"loading state from",
+		fname, err);
+      return -1;
+    }
+  return 0;
+}
+
+/* Chips are written as one block each, a restore is a single read into
+   the storage. Cells of address spaces which are not decoded into a chip
+   (CPU registers, data of hw elements) are saved one by one. */
+
+void
+cl_uc::checkpoint_memory(class cl_state_file *sf)
+{
+  int i;
+  u32_t n= 0, l;
+  t_addr a;
+
+  for (i= 0; i < memchips->count; i++)
+    {
+      class cl_memory_chip *c= (class cl_memory_chip *)(memchips->at(i));
+      sf->tag(c->get_name());
+      l= c->get_array()?(c->get_size() * c->get_bwidth()):0;
+      n= l;
+      sf->var(n);
+      if (n != l)
+	sf->fail();
+      else
+	sf->block(c->get_array(), l);
+    }
+
+  for (i= 0; i < address_spaces->count; i++)
+    {
+      class cl_address_space *as=
+	(class cl_address_space *)(address_spaces->at(i));
+      if (!as->is_address_space() ||
+	  as->hidden)
+	continue;
+      sf->tag(as->get_name());
+      t_addr s= as->get_start_address(), e= s + as->get_size();
+      if (sf->is_saving())
+	{
+	  n= 0;
+	  for (a= s; a < e; a++)
+	    if (!as->get_cell_flag(a, CELL_NON_DECODED) &&
+		!as->get_decoder_of(a))
+	      n++;
+	  sf->var(n);
+	  for (a= s; a < e; a++)
+	    if (!as->get_cell_flag(a, CELL_NON_DECODED) &&
+		!as->get_decoder_of(a))
+	      {
+		t_mem v= as->get_cell(a)->get();
+		sf->var(a);
+		sf->var(v);
+	      }
+	}
+      else
+	{
+	  sf->var(n);
+	  for (; n && sf->ok(); n--)
+	    {
+	      t_mem v= 0;
+	      sf->var(a);
+	      sf->var(v);
+	      if (!sf->ok() ||
+		  a < s ||
+		  a >= e)
+		{
+		  sf->fail();
+		  break;
+		}
+	      as->get_cell(a)->download(v);
+	    }
+	  // bank selector registers may have changed
+	  int d;
+	  for (d= 0; d < as->decoders->count; d++)
+	    {
+	      class cl_address_decoder *dc=
+		(class cl_address_decoder *)(as->decoders->at(d));
+	      if (dc->is_banker())
+		dc->activate(NULL);
+	    }
+	}
+    }
+}
+
+/* State of the CPU which is not visible in memory. Simulators which
+   keep registers or internal flags outside of address spaces should
+   extend this. */
+
+void
+cl_uc::checkpoint(class cl_state_file *sf)
+{
+  int i, n;
+  unsigned long t;
+  double r;
+  class cl_ticker *tickers[4]= { ticks, isr_ticks, idle_ticks, halt_ticks };
+
+  sf->tag("uc");
+  sf->var(PC);
+  sf->var(instPC);
+  sf->var(state);
+  sf->var(irq);
+  sf->var(vc);
+  sf->var(sp_most);
+  for (i= 0; i < 4; i++)
+    {
+      t= tickers[i]->get_ticks();
+      r= tickers[i]->get_rtime();
+      sf->var(t);
+      sf->var(r);
+      if (sf->is_loading())
+	tickers[i]->set(t, r);
+    }
+
+  // enabled state of interrupt sources
+  n= it_sources->count;
+  sf->var(n);
+  if (n != it_sources->count)
+    sf->fail();
+  for (i= 0; i < n && sf->ok(); i++)
+    {
+      class cl_it_src *is= (class cl_it_src *)(it_sources->at(i));
+      bool a= is->active;
+      sf->var(a);
+      is->active= a;
+    }
+
+  // stack of accepted interrupts, except the bottom one
+  n= it_levels->count - 1;
+  sf->var(n);
+  if (sf->is_loading())
+    {
+      class it_level *il= (class it_level *)(it_levels->top());
+      while (il &&
+	     il->level >= 0)
+	{
+	  il= (class it_level *)(it_levels->pop());
+	  delete il;
+	  il= (class it_level *)(it_levels->top());
+	}
+    }
+  for (i= 0; i < n && sf->ok(); i++)
+    {
+      int level= 0, src= -1;
+      uint addr= 0, pc= 0;
+      if (sf->is_saving())
+	{
+	  class it_level *il= (class it_level *)(it_levels->at(i+1));
+	  level= il->level;
+	  addr= il->addr;
+	  pc= il->PC;
+	  if (il->source)
+	    src= it_sources->index_of(il->source);
+	}
+      sf->var(level);
+      sf->var(addr);
+      sf->var(pc);
+      sf->var(src);
+      if (sf->is_loading() &&
+	  sf->ok())
+	{
+	  class cl_it_src *is= NULL;
+	  if (src >= 0 &&
+	      src < it_sources->count)
+	    is= (class cl_it_src *)(it_sources->at(src));
+	  it_levels->push(new it_level(level, addr, pc, is));
+	}
+    }
+  stack_ops->free_all();
+}
+
+void
+cl_uc::checkpoint_hws(class cl_state_file *sf)
+{
+  int i, n= hws->count;
+
+  sf->var(n);
+  if (n != hws->count)
+    {
+      sf->fail();
+      return;
+    }
+  for (i= 0; i < n && sf->ok(); i++)
+    {
+      class cl_hw *hw= (class cl_hw *)(hws->at(i));
+      int id= hw->id;
+      sf->tag(hw->id_string);
+      sf->var(id);
+      if (id != hw->id)
+	sf->fail();
+      else
+	hw->checkpoint(sf);
+    }
+}
+
+
+/* End of sim.src/state.cc */
@@ -0,0 +1,71 @@
+/*
+ * Simulator of microcontrollers (statecl.h)
+ *
+ * Copyright (C) 2026 Drotos Daniel
+ * 
+ * To contact author send email to dr.dkdb@gmail.com
+ *
+ */
+
+/* This file is part of microcontroller simulator: ucsim.
+
+UCSIM is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+UCSIM is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with UCSIM; see the file COPYING.  If not, write to the Free
+Software Foundation, 59 Temple Place - Suite 330, Boston, MA
+02111-1307, USA. */
+/*@1@*/
+
+#ifndef STATECL_HEADER
+#define STATECL_HEADER
+
+#include <stdio.h>
+
+#include "pobjcl.h"
+
+
+/*
+ * State file (checkpoint) of the simulated uc
+ *
+ * The file starts with STATE_MAGIC and STATE_VERSION followed by tagged
+ * sections. Values are stored in host byte order, the contents of memory
+ * chips as one block each.
+ */
+
+#define STATE_MAGIC	"uCsimSTA"
+#define STATE_VERSION	1
+
+class cl_state_file: public cl_base
+{
+ protected:
+  FILE *f;
+  bool saving;
+  bool error;
+ public:
+  cl_state_file(FILE *af, bool asaving);
+
+  bool is_saving(void) { return saving; }
+  bool is_loading(void) { return !saving; }
+  bool ok(void) { return !error; }
+  void fail(void) { error= true; }
+
+  // Same calls save and load, direction depends on the file
+  void block(void *data, size_t len);
+  template <class T> void var(T &v) { block(&v, sizeof(T)); }
+  bool tag(const char *name);
+  bool header(void);
+};
+
+
+#endif
+
+/* End of sim.src/statecl.h */
@@ -557,6 +557,9 @@ cl_uc::cl_uc(class cl_sim *asim):
   class it_level *il= new it_level(-1, 0, 0, 0);
   it_levels->push(il);
   stack_ops= new cl_list(2, 2, "stack operations");
+  profiler= NULL;
+  coverage= NULL;
+  dbg_lines= NULL;
   errors= new cl_list(2, 2, "errors in uc");
   events= new cl_list(2, 2, "events in uc");
   sp_most= 0;
@@ -584,6 +587,9 @@ cl_uc::~cl_uc(void)
   delete it_levels;
   delete it_sources;
   delete stack_ops;
+  delete profiler;
+  delete coverage;
+  delete dbg_lines;
   errors->free_all();
   delete errors;
   delete xtal_option;
@@ -703,6 +709,19 @@ cl_uc::reset(void)
     }
 }
 
+/* Simulation stopped, let the hardware elements catch up */
+
+void
+cl_uc::sim_stopped(void)
+{
+  int i;
+  for (i= 0; i < hws->count; i++)
+    {
+      class cl_hw *hw= (class cl_hw *)(hws->at(i));
+      hw->sim_stopped();
+    }
+}
+
 void
 cl_uc::reg_cell_var(class cl_memory_cell *cell,
 		    void *store,
@@ -824,7 +843,61 @@ cl_uc::build_cmdset(class cl_cmdset *cmdset)
   class cl_super_cmd *super_cmd;
   class cl_cmdset *cset;
 
-  cmdset->add(cmd= new cl_state_cmd("state", 0));
+  super_cmd= (class cl_super_cmd *)(cmdset->get_cmd("state"));
+  if (super_cmd)
+    cset= super_cmd->get_subcommands();
+  else
+    {
+      cset= new cl_cmdset();
+      cset->init();
+      cmdset->add(cmd= new cl_super_cmd("state", 0, cset));
+      cmd->init();
+    }
+  cset->add(cmd= new cl_state_cmd("_no_parameters_", 0));
+  cmd->init();
+  cset->add(cmd= new cl_state_save_cmd("save", 0));
+  cmd->init();
+  cset->add(cmd= new cl_state_load_cmd("load", 0));
+  cmd->init();
+
+  super_cmd= (class cl_super_cmd *)(cmdset->get_cmd("profile"));
+  if (super_cmd)
+    cset= super_cmd->get_subcommands();
+  else
+    {
+      cset= new cl_cmdset();
+      cset->init();
+      cmdset->add(cmd= new cl_super_cmd("profile", 0, cset));
+      cmd->init();
+    }
+  cset->add(cmd= new cl_profile_report_cmd("_no_parameters_", 0));
+  cmd->init();
+  cset->add(cmd= new cl_profile_start_cmd("start", 0));
+  cmd->init();
+  cset->add(cmd= new cl_profile_stop_cmd("stop", 0));
+  cmd->init();
+  cset->add(cmd= new cl_profile_report_cmd("report", 0));
+  cmd->init();
+  cset->add(cmd= new cl_profile_folded_cmd("folded", 0));
+  cmd->init();
+
+  super_cmd= (class cl_super_cmd *)(cmdset->get_cmd("coverage"));
+  if (super_cmd)
+    cset= super_cmd->get_subcommands();
+  else
+    {
+      cset= new cl_cmdset();
+      cset->init();
+      cmdset->add(cmd= new cl_super_cmd("coverage", 0, cset));
+      cmd->init();
+    }
+  cset->add(cmd= new cl_coverage_info_cmd("_no_parameters_", 0));
+  cmd->init();
+  cset->add(cmd= new cl_coverage_start_cmd("start", 0));
+  cmd->init();
+  cset->add(cmd= new cl_coverage_stop_cmd("stop", 0));
+  cmd->init();
+  cset->add(cmd= new cl_coverage_lcov_cmd("lcov", 0));
   cmd->init();
 
 #ifdef STATISTIC
@@ -1709,6 +1782,7 @@ cl_uc::read_cdb_file(cl_f *f)
 		      class cl_cvar *v;
 		      v= vars->add(n, rom, r->addr, "");
 		      v->set_by(VBY_DEBUG);
+		      dbg_line('F', n, 0, r->addr);
 		      fns->del(n);
 		      cnt++;
 		    }
@@ -1735,11 +1809,33 @@ cl_uc::read_cdb_file(cl_f *f)
 		      class cl_cvar *v;
 		      v= vars->add(n, rom, a, "");
 		      v->set_by(VBY_DEBUG);
+		      dbg_line('F', n, 0, a);
 		      cnt++;
 		    }
 		  else
 		    fns->add(new cl_cdb_rec(n, a));
 		}
+	      else if ((lc[1] == ':') &&
+		       (lc[2] == 'C' || lc[2] == 'A') &&
+		       (lc[3] == '$'))
+		{
+		  // L:C$file$line$level$block:addr, L:A$module$line:addr
+		  ln.start_parse(4);
+		  chars n= ln.token("$");
+		  chars l= ln.token("$:");
+		  const char *a= strrchr(lc, ':');
+		  if (lc[2] == 'A')
+		    n+= ".asm";
+		  dbg_line(lc[2], n, strtol(l.c_str(), 0, 10),
+			   strtol(a+1, 0, 16));
+		}
+	      else if ((lc[1] == ':') &&
+		       (lc[2] == 'X'))
+		{
+		  // L:X{G|F<module>}$func$level$block:addr
+		  const char *a= strrchr(lc, ':');
+		  dbg_line('X', "", 0, strtol(a+1, 0, 16));
+		}
 	    }
 	}
       ln= f->get_s();
@@ -1749,6 +1845,14 @@ cl_uc::read_cdb_file(cl_f *f)
   return cnt;
 }
 
+void
+cl_uc::dbg_line(char kind, const char *file, long line, t_addr addr)
+{
+  if (dbg_lines == NULL)
+    dbg_lines= new cl_dbg_lines();
+  dbg_lines->add(kind, file, line, addr);
+}
+
 static bool is_area(chars w1, chars w2, chars w3)
 {
   if (w1.empty() || w2.empty() || w3.empty())
@@ -3218,6 +3322,8 @@ cl_uc::do_inst(void)
 		  analyze(instPC);
 		}
 	    }
+	  if (coverage)
+	    coverage->exec(instPC, PC);
 	}
     }
   post_inst();
@@ -3529,6 +3635,12 @@ void
 cl_uc::stack_write(class cl_stack_op *op)
 {
   stack_check_overflow(op);
+  if (profiler &&
+      (op->get_op() & (stack_call|stack_intr)))
+    {
+      class cl_stack_call *c= (class cl_stack_call *)op;
+      profiler->call(c->get_called(), c->get_pushed());
+    }
   delete op;
   return ;
   if (op->get_op() & stack_read_operation)
@@ -3551,6 +3663,9 @@ cl_uc::stack_read(void)
 void
 cl_uc::stack_read(class cl_stack_op *op)
 {
+  if (profiler &&
+      (op->get_op() & (stack_ret|stack_iret)))
+    profiler->ret(((class cl_stack_ret *)op)->get_called());
   delete op;
   return ;
   class cl_stack_op *top= (class cl_stack_op *)(stack_ops->top());
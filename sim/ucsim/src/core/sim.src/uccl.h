@@ -40,6 +40,9 @@ Software Foundation, 59 Temple Place - Suite 330, Boston, MA
 #include "stackcl.h"
 #include "varcl.h"
 #include "itabcl.h"
+#include "statecl.h"
+#include "profcl.h"
+#include "covcl.h"
 
 
 class cl_uc;
@@ -311,6 +314,9 @@ public:
   class cl_irqs *it_sources;	// Sources of interrupts
   class cl_list *it_levels;	// Follow interrupt services
   class cl_list *stack_ops;	// Track stack operations
+  class cl_profiler *profiler;	// Call graph profiler, if started
+  class cl_coverage *coverage;	// Code coverage, if started
+  class cl_dbg_lines *dbg_lines;// Line records of .cdb files
 
   class cl_list *errors;	// Errors of instruction execution
   class cl_list *events;	// Events happened during inst exec
@@ -326,6 +332,14 @@ public:
   virtual int init(void);
   virtual const char *id_string(void);
   virtual void reset(void);
+  virtual void sim_stopped(void);
+  virtual int save_state(const char *fname, class cl_console_base *con);
+  virtual int load_state(const char *fname, class cl_console_base *con);
+  virtual int state_file(const char *fname, bool saving,
+			 class cl_console_base *con);
+  virtual void checkpoint_memory(class cl_state_file *sf);
+  virtual void checkpoint(class cl_state_file *sf);
+  virtual void checkpoint_hws(class cl_state_file *sf);
   virtual void set_PC(t_addr addr) { PC= addr; }
   virtual void reg_cell_var(class cl_memory_cell *cell,
 			    void *store,
@@ -369,6 +383,7 @@ public:
   virtual long read_p2h_file(cl_f *f, bool just_check= false);
   virtual long read_cdb_file(cl_f *f);
   virtual long read_map_file(cl_f *f);
+  virtual void dbg_line(char kind, const char *file, long line, t_addr addr);
   virtual long read_s19_file(cl_f *f);
   virtual cl_f *find_loadable_file(chars nam);
   virtual long read_file(chars nam, class cl_console_base *con, bool just_check= false);
@@ -444,6 +459,10 @@ public:
   virtual void stack_write(void);
   virtual void stack_write(t_addr sp_before);
   virtual void stack_read(class cl_stack_op *op);
+  void prof_call(t_addr called, t_addr ret_addr)
+  { if (profiler) profiler->call(called, ret_addr); }
+  void prof_ret(t_addr to_addr)
+  { if (profiler) profiler->ret(to_addr); }
   virtual void stack_read(void);
   virtual void stack_check_overflow(class cl_stack_op *op);
   virtual void stack_check_overflow(void);
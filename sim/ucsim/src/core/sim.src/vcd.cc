@@ -162,6 +162,8 @@ cl_vcd::cl_vcd(class cl_uc *auc, int aid, chars aid_string):
   paused= false;
   dobreak= false;
   modul= chars("", "ucsim_vcd_%d", id);
+  changes= NULL;
+  nchanges= 0;
 }
 
 int
@@ -365,9 +367,70 @@ cl_vcd::open_vcd(class cl_console_base *con)
 void
 cl_vcd::close_vcd(void)
 {
+  flush_changes();
   fclose(fd);
 }
 
+static char *
+put_time(char *p, i64_t t)
+{
+  char d[24];
+  int n= 0;
+  u64_t u= (t < 0) ? -(u64_t)t : t;
+
+  *p++= '#';
+  if (t < 0)
+    *p++= '-';
+  do
+    d[n++]= '0' + u % 10;
+  while (u/= 10);
+  while (n)
+    *p++= d[--n];
+  *p++= '\n';
+  return p;
+}
+
+/* Write out the changes collected by report() */
+
+void
+cl_vcd::flush_changes(void)
+{
+  char buf[16384], *p= buf;
+  int i, b;
+
+  if (!fd || !nchanges)
+    return;
+
+  for (i= 0; i < nchanges; i++)
+    {
+      struct vcd_change *c= &changes[i];
+
+      // time stamp, one value and the id take at most 24+1+32+3 bytes
+      if (p - buf > (int)sizeof(buf) - 64 - (c->bitnr_high - c->bitnr_low))
+        {
+          fwrite(buf, 1, p - buf, fd);
+          p= buf;
+        }
+      if (c->stamp)
+        p= put_time(p, c->time);
+      if (c->bitnr_low == c->bitnr_high)
+        *p++= (c->value & (1U << c->bitnr_low)) ? '1' : '0';
+      else
+        {
+          *p++= 'b';
+          for (b= c->bitnr_high; b >= c->bitnr_low; b--)
+            *p++= (c->value & (1U << b)) ? '1' : '0';
+          *p++= ' ';
+        }
+      *p++= c->var_id;
+      *p++= '\n';
+    }
+  fwrite(buf, 1, p - buf, fd);
+  nchanges= 0;
+  if (!filename || filename[0] == '|')
+    fflush(fd);
+}
+
 bool
 cl_vcd::parse_header(cl_console_base *con)
 {
@@ -852,6 +915,7 @@ cl_vcd::set_cmd(class cl_cmdline *cmdline, class cl_console_base *con)
                       double d =  now - event;
                       d = event + (pausetime >= 0 && d > pausetime ? pausetime : d);
                       starttime = now - (d - starttime);
+                      flush_changes();
                       fprintf(fd, "#%.0f\n", (now - starttime) * timescale);
                       if (started)
                         {
@@ -865,6 +929,7 @@ cl_vcd::set_cmd(class cl_cmdline *cmdline, class cl_console_base *con)
                       event = now;
                       for (class cl_vcd_var *var = vars; var; var = var->next_var)
                         report(var, var->cell->get());
+                      flush_changes();
                       fprintf(fd, "$end\n");
                       if (!filename || filename[0] == '|') fflush(fd);
                     }
@@ -896,6 +961,7 @@ cl_vcd::set_cmd(class cl_cmdline *cmdline, class cl_console_base *con)
                   if (state == -1)
                     {
                       event = uc->ticks->get_rtime();
+                      flush_changes();
                       fprintf(fd, "#%.0f\n$comment Paused $end\n$dumpoff\n", (event - starttime) * timescale);
                       for (class cl_vcd_var *var = vars; var; var = var->next_var)
                         {
@@ -931,7 +997,10 @@ cl_vcd::set_cmd(class cl_cmdline *cmdline, class cl_console_base *con)
                   if (fd)
                     {
                       if (state == -1)
-                        fprintf(fd, "#%.0f\n", (uc->ticks->get_rtime() - starttime) * timescale);
+                        {
+                          flush_changes();
+                          fprintf(fd, "#%.0f\n", (uc->ticks->get_rtime() - starttime) * timescale);
+                        }
                       close_vcd();
                     }
                   fd= NULL;
@@ -988,25 +1057,29 @@ cl_vcd::report(class cl_vcd_var *var, t_mem v)
   double now = uc->ticks->get_rtime();
   //uc->sim->app->debug("vcd[%d]: '%c' changed at %.15f\n",
   //                    cl_hw::id, var->var_id, uc->ticks->get_rtime());
-  if (event != now)
-    {
-      event = now;
-      fprintf(fd, "#%.0f\n", (event - starttime) * timescale);
-    }
+  if (!changes)
+    changes= (struct vcd_change *)malloc(VCD_CHANGES * sizeof(struct vcd_change));
+  else if (nchanges == VCD_CHANGES)
+    flush_changes();
 
-  if (var->bitnr_low == var->bitnr_high)
+  struct vcd_change *c= &changes[nchanges++];
+  if ((c->stamp= (event != now)))
     {
-      fprintf(fd, "%c%c\n", ((v & var->bitmask) ? '1' : '0'), var->var_id);
-    }
-  else
-    {
-      putc('b', fd);
-      for (int i = var->bitnr_high; i >= var->bitnr_low; i--)
-        putc((v & (1U << i)) ? '1' : '0', fd);
-      fprintf(fd, " %c\n", var->var_id);
+      // rounded like "%.0f" does
+      double t= (now - starttime) * timescale;
+      i64_t i= (i64_t)t;
+      double f= t - i;
+      event = now;
+      if (f > 0.5 || (f == 0.5 && (i & 1)))
+        i++;
+      else if (f < -0.5 || (f == -0.5 && (i & 1)))
+        i--;
+      c->time= i;
     }
-
-  fflush(fd);
+  c->value= v;
+  c->bitnr_high= var->bitnr_high;
+  c->bitnr_low= var->bitnr_low;
+  c->var_id= var->var_id;
 }
 
 int
@@ -1023,6 +1096,7 @@ cl_vcd::tick(int cycles)
         on = false;
       else if (!filename || filename[0] == '|')
         {
+          flush_changes();
           fprintf(fd, "#%.0f\n", (now - starttime) * timescale);
           fflush(fd);
         }
@@ -33,6 +33,18 @@ Software Foundation, 59 Temple Place - Suite 330, Boston, MA
 
 class cl_vcd_var;
 
+// Changes are collected and written out in blocks
+#define VCD_CHANGES	16384
+
+struct vcd_change
+{
+  i64_t time;		// in units of the timescale, if stamp is set
+  t_mem value;
+  int bitnr_high, bitnr_low;
+  char var_id;
+  bool stamp;		// a new time starts with this change
+};
+
 class cl_vcd: public cl_hw
 {
  private:
@@ -45,6 +57,8 @@ class cl_vcd: public cl_hw
   bool started, paused, dobreak;
   chars modul;
   char word[64];
+  struct vcd_change *changes;
+  int nchanges;
 
  public:
   cl_vcd(class cl_uc *auc, int aid, chars aid_string);
@@ -60,6 +74,7 @@ class cl_vcd: public cl_hw
   virtual int tick(int cycles);
 
   virtual void report(class cl_vcd_var *var, t_mem v);
+  virtual void sim_stopped(void) { flush_changes(); }
   virtual void print_info(class cl_console_base *con);
 
  private:
@@ -75,6 +90,7 @@ class cl_vcd: public cl_hw
 
   FILE *open_vcd(class cl_console_base *con);
   void close_vcd(void);
+  void flush_changes(void);
 
   bool read_word(unsigned int i);
   void clear_vars(void);
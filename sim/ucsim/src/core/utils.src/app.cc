@@ -141,6 +141,47 @@ cl_app::read_input_files(void)
     }
 }
 
+void
+cl_app::load_state_file(void)
+{
+  if (state_load_file.nempty() &&
+      sim &&
+      (sim->uc != NULL))
+    sim->uc->load_state(state_load_file, NULL);
+}
+
+void
+cl_app::save_state_file(void)
+{
+  if (state_save_file.nempty() &&
+      sim &&
+      (sim->uc != NULL))
+    sim->uc->save_state(state_save_file, NULL);
+}
+
+void
+cl_app::start_coverage(void)
+{
+  if (coverage_file.nempty() &&
+      sim &&
+      (sim->uc != NULL))
+    {
+      class cl_uc *uc= sim->uc;
+      uc->coverage= new cl_coverage(uc);
+      uc->coverage->init();
+    }
+}
+
+void
+cl_app::write_coverage(void)
+{
+  if (coverage_file.nempty() &&
+      sim &&
+      (sim->uc != NULL) &&
+      (sim->uc->coverage != NULL))
+    sim->uc->coverage->lcov(coverage_file, NULL);
+}
+
 void
 cl_app::exec_startup_cmd(void)
 {
@@ -225,6 +266,8 @@ cl_app::run(void)
   cperiod.set(cperiod_value());
   read_conf_file();
   read_input_files();
+  load_state_file();
+  start_coverage();
   exec_startup_cmd();
   check_con_hw();
   check_start_options();
@@ -258,6 +301,8 @@ cl_app::run(void)
 	}
       //commander->check();
     }
+  save_state_file();
+  write_coverage();
     
   return(0);
 }
@@ -340,7 +385,8 @@ print_help(const char *name)
 #endif
   printf("%s: %s\n", name, VERSIONSTR);
   printf("Usage: %s [-bBEgGhHlPqVvw] [-a nr] [-c file] [-C cfg_file] " DOPT "\n"
-	 "       [-e command] [-I if_optionlist] " KOPT " [-o colorlist]\n"
+	 "       [-D file] [-e command] [-I if_optionlist] " KOPT " [-L file]\n"
+	 "       [-o colorlist] [-O file]\n"
 	 "       [-p prompt] [-R seed] [-s file] [-S optionlist]\n"
 	 "       [-t CPU] [-U uartnr] [-u hw] [-X freq[k|M]] " ZOPT "\n"
 	 "\n"
@@ -357,7 +403,8 @@ print_help(const char *name)
      "  -B           Beep on breakpoints\n"
      "  -c file      Open command console on `file' (use `-' for std in/out)\n"
      "  -C cfg_file  Read initial commands from `cfg_file' and execute them\n"
-   //"  -d portnum   Act as gdbserver, listen on portnum for gdb connections\n"
+     "  -d portnum   Act as gdbserver, listen on portnum for gdb connections\n"
+     "  -D file      Save state of the simulated uc into `file' at exit\n"
      "  -e command   Execute command on startup\n"
      "  -E           Go, start simulation in emulation mode\n"
      "  -g           Go, start simulation\n"
@@ -371,9 +418,11 @@ print_help(const char *name)
      "                 out=file            specify output file for IO\n"
      "  -k portnum   Listen portnum for serial I/O (obsolete, use -S)\n"
      "  -l           Use light theme (default is dark)\n"
+     "  -L file      Restore state of the simulated uc from `file' (see -D)\n"
      "  -o colors    `colors' is a list of color specification: what=colspec,...\n"
      "               where colspec is : separated list of color options\n"
      "               e.g.: prompt=b:white:black (bold white on black)\n"
+     "  -O file      Collect code coverage, add it to lcov tracefile `file' at exit\n"
      "  -p prompt    Specify string for prompt\n"
      "  -P           Prompt is a null ('\\0') character\n"
      "  -q           Quiet mode (implies -b)\n"
@@ -446,7 +495,7 @@ cl_app::proc_arguments(int argc, char *argv[])
   bool /*s_done= false,*/ k_done= false;
   //bool S_i_done= false, S_o_done= false;
 
-  strcpy(opts, "qc:C:e:p:PX:vVt:s:S:I:a:whHgGEJo:blBR:U:u:_");
+  strcpy(opts, "qc:C:e:p:PX:vVt:s:S:I:a:whHgGEJo:blBR:U:u:D:L:O:_");
 #ifdef SOCKET_AVAIL
   strcat(opts, "Z:r:k:z:d:");
 #endif
@@ -510,6 +559,15 @@ cl_app::proc_arguments(int argc, char *argv[])
       case 'R':
         srnd(atoi(optarg));
         break;
+      case 'L':
+	state_load_file= optarg;
+	break;
+      case 'D':
+	state_save_file= optarg;
+	break;
+      case 'O':
+	coverage_file= optarg;
+	break;
 #ifdef SOCKET_AVAIL
       case 'z':
 	{
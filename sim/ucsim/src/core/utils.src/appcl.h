@@ -93,6 +93,8 @@ public:
   int going;
   long expr_result;
   chars startup_command;
+  chars state_load_file, state_save_file;
+  chars coverage_file;
   class cl_mc32 cperiod, ccyc;
   u32_t period, cyc, acyc;
   bool quiet;
@@ -109,6 +111,10 @@ public:
   virtual int init(int argc , char *argv[]);
   virtual void read_conf_file(void);
   virtual void read_input_files(void);
+  virtual void load_state_file(void);
+  virtual void save_state_file(void);
+  virtual void start_coverage(void);
+  virtual void write_coverage(void);
   virtual void exec_startup_cmd(void);
   virtual void check_con_hw(void);
   virtual int check_start_options(void);
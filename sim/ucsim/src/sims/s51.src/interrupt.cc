@@ -122,6 +122,17 @@ cl_interrupt::reset(void)
   was_reti= false;
 }
 
+void
+cl_interrupt::checkpoint(class cl_state_file *sf)
+{
+  cl_hw::checkpoint(sf);
+  sf->var(was_reti);
+  sf->var(bit_IT0);
+  sf->var(bit_IT1);
+  sf->var(bit_INT0);
+  sf->var(bit_INT1);
+}
+
 void
 cl_interrupt::happen(class cl_hw *where, enum hw_event he, void *params)
 {
@@ -55,6 +55,7 @@ public:
 
   virtual int tick(int cycles);
   virtual void reset(void);
+  virtual void checkpoint(class cl_state_file *sf);
   virtual void happen(class cl_hw *where, enum hw_event he, void *params);
 
   virtual void print_info(class cl_console_base *con);
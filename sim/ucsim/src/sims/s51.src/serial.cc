@@ -362,6 +362,22 @@ cl_serial::reset(void)
   s_tr_bit   = 0;
 }
 
+void
+cl_serial::checkpoint(class cl_state_file *sf)
+{
+  cl_serial_hw::checkpoint(sf);
+  sf->var(t2_baud);
+  sf->var(s_rec_t1);
+  sf->var(s_tr_t1);
+  sf->var(s_rec_tick);
+  sf->var(s_tr_tick);
+  sf->var(_mode);
+  sf->var(_bmREN);
+  sf->var(_bmSMOD);
+  sf->var(_bits);
+  sf->var(_divby);
+}
+
 void
 cl_serial::happen(class cl_hw *where, enum hw_event he, void *params)
 {
@@ -203,6 +203,20 @@ cl_timer0::mem_cell_changed(class cl_m *mem, t_addr addr)
   //if (addr == addr_th) cell_th= sfr->get_cell(addr_th);
 }*/
 
+/* Mode and control bits are cached from TMOD and TCON writes */
+
+void
+cl_timer0::checkpoint(class cl_state_file *sf)
+{
+  cl_hw::checkpoint(sf);
+  sf->var(mode);
+  sf->var(GATE);
+  sf->var(C_T);
+  sf->var(TR);
+  sf->var(INT);
+  sf->var(T_edge);
+}
+
 int
 cl_timer0::tick(int cycles)
 {
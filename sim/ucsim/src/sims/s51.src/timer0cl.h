@@ -60,6 +60,7 @@ public:
   //virtual void mem_cell_changed(class cl_mem *mem, t_addr addr);
 
   virtual int tick(int cycles);
+  virtual void checkpoint(class cl_state_file *sf);
   virtual int do_mode0(int cycles);
   virtual int do_mode1(int cycles);
   virtual int do_mode2(int cycles);
@@ -142,6 +142,20 @@ cl_timer2::write(class cl_memory_cell *cell, t_mem *val)
     T_edge= t2ex_edge= 0;
 }
 
+void
+cl_timer2::checkpoint(class cl_state_file *sf)
+{
+  cl_timer0::checkpoint(sf);
+  sf->var(RCLK);
+  sf->var(TCLK);
+  sf->var(CP_RL2);
+  sf->var(EXEN2);
+  sf->var(t2ex_edge);
+  sf->var(bit_dcen);
+  sf->var(bit_t2oe);
+  sf->var(bit_t2ex);
+}
+
 int
 cl_timer2::tick(int cycles)
 { 
@@ -76,6 +76,7 @@ public:
   //virtual void mem_cell_changed(class cl_mem *mem, t_addr addr);
 
   virtual int  tick(int cycles);
+  virtual void checkpoint(class cl_state_file *sf);
   virtual int  do_t2_baud(int cycles);
   virtual void do_t2_capture(int cycles);
   virtual void do_t2_reload(int cycles);
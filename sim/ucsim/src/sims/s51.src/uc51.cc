@@ -1692,6 +1692,17 @@ cl_51core::reset(void)
   //was_reti= false;
 }
 
+void
+cl_51core::checkpoint(class cl_state_file *sf)
+{
+  cl_uc::checkpoint(sf);
+  sf->tag("51core");
+  sf->var(prev_p1);
+  sf->var(prev_p3);
+  sf->var(p3_int0_edge);
+  sf->var(p3_int1_edge);
+}
+
 
 /*
  * Setting up SFR area to reset value
@@ -1911,6 +1922,8 @@ cl_51core::do_inst(void)
 	  if (result == resGO && !inst_at(PCsave))
 	    analyze(PCsave);
 	}
+      if (coverage)
+	coverage->exec(PCsave, PC);
       post_inst();
     }
   else
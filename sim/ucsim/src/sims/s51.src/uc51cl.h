@@ -123,6 +123,7 @@ public:
   virtual void   baddr_name(t_addr addr, chars *buf);
   
   virtual void   reset(void);
+  virtual void   checkpoint(class cl_state_file *sf);
   virtual void   clear_sfr(void);
   virtual void   analyze(t_addr addr);
 
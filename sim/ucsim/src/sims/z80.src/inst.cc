@@ -1295,6 +1295,7 @@ cl_z80::inst_rst(t_mem code)
       return(resINV_INST);
       break;
     }
+  prof_call(PC, instPC+1);
   return(resGO);
 }
 
@@ -1384,6 +1385,8 @@ cl_z80::inst_ret(t_mem code)
       return(resINV_INST);
       break;
     }
+  if (PC != instPC+1)
+    prof_ret(PC);
   return(resGO);
 }
 
@@ -1499,6 +1502,8 @@ cl_z80::inst_call(t_mem code)
       break;
     }
   
+  if (PC != instPC+3)
+    prof_call(PC, instPC+3);
   return(resGO);
 }
 
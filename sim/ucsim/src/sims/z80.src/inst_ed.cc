@@ -124,6 +124,7 @@ int  cl_z80::inst_ed_(t_mem code)
       
     case 0x45: // RETN (return from non-maskable interrupt)
       pop2(PC);
+      prof_ret(PC);
       IFF1= IFF2;
       IFF2= false;
       vc.rd+= 2;      
@@ -175,6 +176,7 @@ int  cl_z80::inst_ed_(t_mem code)
       
     case 0x4D: // RETI (return from interrupt)
       pop2(PC);
+      prof_ret(PC);
       IFF1= IFF2;
       IFF2= false;
       vc.rd+= 2;
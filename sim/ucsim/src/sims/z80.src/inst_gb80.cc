@@ -314,6 +314,7 @@ int cl_gb80::inst_reti  (t_mem code) {
   PC=get2(regs.SP);
   regs.SP+=2;
   vc.rd+= 2;
+  prof_ret(PC);
   
   return resGO;
 }
@@ -113,6 +113,18 @@ cl_z80::reset(void)
   imode= 0;
 }
 
+void
+cl_z80::checkpoint(class cl_state_file *sf)
+{
+  cl_uc::checkpoint(sf);
+  sf->tag("z80");
+  sf->var(regs);
+  sf->var(IFF1);
+  sf->var(IFF2);
+  sf->var(imode);
+  sf->var(iblock);
+}
+
 const char *
 cl_z80::id_string(void)
 {
@@ -70,6 +70,7 @@ public:
   cl_z80(struct cpu_entry *Itype, class cl_sim *asim);
   virtual int init(void);
   virtual void reset(void);
+  virtual void checkpoint(class cl_state_file *sf);
   virtual const char *id_string(void);
   
   //virtual t_addr get_mem_size(enum mem_class type);
@@ -39,6 +39,7 @@ struct _dumpFiles dumpFiles[] = {
   {DUMP_LOOP, ".dumploop", NULL},
   {DUMP_LOOPG, ".dumploopg", NULL},
   {DUMP_LOOPD, ".dumploopd", NULL},
+  {DUMP_UNROLL, ".dumpunroll", NULL},
   {DUMP_LOSPRE, ".dumplospre", NULL},
   {DUMP_GENCONSTPROP, ".dumpgenconstprop", NULL},
   {DUMP_RANGE, ".dumprange", NULL},
@@ -69,7 +70,7 @@ neweBBlock ()
 {
   eBBlock *ebb;
 
-  ebb = Safe_alloc (sizeof (eBBlock));
+  ebb = regionAlloc (&funcRegion, sizeof (eBBlock));
   return ebb;
 }
 
@@ -81,7 +82,7 @@ newEdge (eBBlock * from, eBBlock * to)
 {
   edge *ep;
 
-  ep = Safe_alloc (sizeof (edge));
+  ep = regionAlloc (&funcRegion, sizeof (edge));
 
   ep->from = from;
   ep->to = to;
@@ -572,7 +573,7 @@ iCodeBreakDown (iCode * ic)
   iCode *loop = ic;
   ebbIndex *ebbi;
 
-  ebbi = Safe_alloc (sizeof (ebbIndex));
+  ebbi = regionAlloc (&funcRegion, sizeof (ebbIndex));
   ebbi->count = 0;
   ebbi->dfOrder = NULL;         /* no depth first order information yet */
 
@@ -1624,6 +1624,78 @@ gatherAutoInit (symbol * autoChain)
   return init;
 }
 
+/* the literal strings in statsg, hashed by their contents */
+#define STRLIT_HTAB_SIZE 1024
+static hTab *strLitTab;
+
+static int
+strLitKey (const char *s, unsigned int size)
+{
+  unsigned long h = 2166136261ul;
+
+  while (size--)
+    h = (h ^ (unsigned char) *s++) * 16777619ul;
+  return (h & 0xfffffffful) % STRLIT_HTAB_SIZE;
+}
+
+static int
+strLitCompare (const void *v, const void *s)
+{
+  const value *val = v;
+  const symbol *sym = s;
+  unsigned int size = getSize (val->type);
+
+  return size == getSize (sym->type) &&
+         !memcmp (SPEC_CVAL (sym->etype).v_char, SPEC_CVAL (val->etype).v_char, size);
+}
+
+static void
+strLitAdd (int key, symbol *sym)
+{
+  if (!strLitTab)
+    strLitTab = newHashTable (STRLIT_HTAB_SIZE);
+  hTabAddItemLong (&strLitTab, key, sym, sym);
+}
+
+/*-----------------------------------------------------------------*/
+/* addStringSymbol - make a literal string in statsg available to  */
+/*                   stringToSymbol again                          */
+/*-----------------------------------------------------------------*/
+void
+addStringSymbol (symbol *sym)
+{
+  value *val = symbolVal (sym);
+  int key = strLitKey (SPEC_CVAL (sym->etype).v_char, getSize (sym->type));
+
+  if (!hTabFindByKey (strLitTab, key, val, strLitCompare))
+    strLitAdd (key, sym);
+  Safe_free (val);
+}
+
+/*-----------------------------------------------------------------*/
+/* removeStringSymbol - a literal string left statsg               */
+/*-----------------------------------------------------------------*/
+void
+removeStringSymbol (symbol *sym)
+{
+  if (strLitTab)
+    hTabDeleteByKey (&strLitTab, strLitKey (SPEC_CVAL (sym->etype).v_char, getSize (sym->type)), sym, NULL);
+}
+
+/*-----------------------------------------------------------------*/
+/* clearStringSymbols - statsg has been emitted                    */
+/*-----------------------------------------------------------------*/
+void
+clearStringSymbols (void)
+{
+  if (strLitTab)
+    {
+      hTabDeleteAll (strLitTab);
+      Safe_free (strLitTab);
+      strLitTab = NULL;
+    }
+}
+
 /*-----------------------------------------------------------------*/
 /* freeStringSymbol - delete a literal string if no more usage     */
 /*-----------------------------------------------------------------*/
@@ -1638,6 +1710,8 @@ freeStringSymbol (symbol *sym)
       if (segment)
         {
           deleteSetItem (&segment->syms, sym);
+          if (segment == statsg)
+            removeStringSymbol (sym);
         }
     }
 }
@@ -1651,21 +1725,14 @@ stringToSymbol (value *val)
   struct dbuf_s dbuf;
   static int charLbl = 0;
   symbol *sym;
-  set *sp;
-  unsigned int size;
+  int key = strLitKey (SPEC_CVAL (val->etype).v_char, getSize (val->type));
 
   // have we heard this before?
-  for (sp = statsg->syms; sp; sp = sp->next)
+  if ((sym = hTabFindByKey (strLitTab, key, val, strLitCompare)))
     {
-      sym = sp->item;
-      size = getSize (sym->type);
-      if (sym->isstrlit && size == getSize (val->type) &&
-          !memcmp (SPEC_CVAL (sym->etype).v_char, SPEC_CVAL (val->etype).v_char, size))
-        {
-          // yes, this is old news. Don't publish it again.
-          sym->isstrlit++;      // but raise the usage count
-          return symbolVal (sym);
-        }
+      // yes, this is old news. Don't publish it again.
+      sym->isstrlit++;          // but raise the usage count
+      return symbolVal (sym);
     }
 
   dbuf_init (&dbuf, 128);
@@ -1699,6 +1766,8 @@ stringToSymbol (value *val)
       addSet (&strSym, sym);
       addSet (&statsg->syms, sym);
     }
+  if (SPEC_OCLS (sym->etype) == statsg)
+    strLitAdd (key, sym);
   sym->ival = NULL;
   return symbolVal (sym);
 }
@@ -3456,14 +3525,14 @@ rewriteStructAssignment (ast *tree)
 }
 
 /*--------------------------------------------------------------------*/
-/* decorateType - compute type for this tree, also does type checking.*/
+/* decorateTree - compute type for this tree, also does type checking.*/
 /* This is done bottom up, since type has to flow upwards.            */
 /* resultType flows top-down and forces e.g. char-arithmetic, if the  */
 /* result is a char and the operand(s) are int's.                     */
 /* It also does constant folding, and parameter checking.             */
 /*--------------------------------------------------------------------*/
-ast *
-decorateType (ast *tree, RESULT_TYPE resultType, bool reduceTypeAllowed)
+static ast *
+decorateTree (ast *tree, RESULT_TYPE resultType, bool reduceTypeAllowed)
 {
   int parmNumber;
   sym_link *p;
@@ -5972,6 +6041,23 @@ errorTreeReturn:
   return tree;
 }
 
+/*-----------------------------------------------------------------*/
+/* decorateType - decorateTree, timed as a phase of its own        */
+/*-----------------------------------------------------------------*/
+ast *
+decorateType (ast *tree, RESULT_TYPE resultType, bool reduceTypeAllowed)
+{
+  int phase;
+
+  if (reportCurrentPhase () == PHASE_DECORATE)
+    return decorateTree (tree, resultType, reduceTypeAllowed);
+
+  phase = reportPhase (PHASE_DECORATE);
+  tree = decorateTree (tree, resultType, reduceTypeAllowed);
+  reportPhase (phase);
+  return tree;
+}
+
 /*-----------------------------------------------------------------*/
 /* sizeofOp - processes size of operation                          */
 /*-----------------------------------------------------------------*/
@@ -7669,7 +7755,7 @@ createFunction (symbol * name, ast * body)
   processBlockVars (body, &stack, ALLOCATE);
 
   /* name needs to be mangled */
-  SNPRINTF (name->rname, sizeof (name->rname), "%s%s", port->fun_prefix, name->name);
+  SNPRINTF (name->rname, sizeof (name->rname), "%s%s", port->fun_prefix, linkName (name));
 
   body = resolveSymbols (body); /* resolve the symbols */
   body = decorateType (body, RESULT_TYPE_NONE, true); /* propagateType & do semantic checks */
@@ -7704,6 +7790,8 @@ createFunction (symbol * name, ast * body)
   /* create the node & generate intermediate code */
   GcurMemmap = code;
   codeOutBuf = &code->oBuf;
+  if (options.split_areas && options.code_seg && !SPEC_ABSA (fetype))
+    emitSplitArea (codeOutBuf, options.code_seg, name->rname, true);
   piCode = iCodeFromAst (ex);
   name->generated = 1;
 
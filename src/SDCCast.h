@@ -232,6 +232,9 @@ ast *initAggregates (symbol *, initList *, ast *);
 bool astHasVolatile (ast *tree);
 bool hasSEFcalls (ast *);
 void addSymToBlock (symbol *, ast *);
+void addStringSymbol (symbol *);
+void removeStringSymbol (symbol *);
+void clearStringSymbols (void);
 void freeStringSymbol (symbol *);
 value *stringToSymbol (value *val);
 DEFSETFUNC (resetParmKey);
@@ -0,0 +1,621 @@
+/*-------------------------------------------------------------------------
+  SDCCcache.c - cache of compilation results
+
+   This program is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the
+   Free Software Foundation; either version 2, or (at your option) any
+   later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+-------------------------------------------------------------------------*/
+
+/* The cache keeps the output files of a compilation in an entry
+   named after a digest of the preprocessed source and of everything
+   else that can change the output: the sdcc version, the port, the
+   module name, the command line options and the extra peephole rules.
+   File names and the options only the preprocessor sees are left out,
+   since the preprocessed source already reflects them.
+
+   Each entry is one file in the cache directory. The file "index"
+   in the same directory counts hits and misses, and lists the entries
+   with their size and the time of their last use. When the entries
+   together grow beyond the size given with --cache-size, the least
+   recently used ones are removed. */
+
+#include <time.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "common.h"
+#include "SDCCcache.h"
+#include "dbuf_string.h"
+
+#define CACHE_MAGIC "sdcc-cache 1\n"
+
+/* the output files of a compilation */
+enum
+{
+  OUT_ASM,
+  OUT_REL,
+  OUT_LST,
+  OUT_SYM,
+  OUT_ADB,
+  OUT_COUNT
+};
+
+static const char *const outRole[OUT_COUNT] = { "asm", "rel", "lst", "sym", "adb" };
+
+typedef struct cacheEntry
+{
+  char name[33];                /* hex digest, also the file name */
+  unsigned long size;           /* size of the entry file in bytes */
+  unsigned long used;           /* time of the last store or hit */
+}
+cacheEntry;
+
+typedef struct cacheIndex
+{
+  unsigned long hits;
+  unsigned long misses;
+  unsigned int count;
+  unsigned int alloc;
+  cacheEntry *entries;
+}
+cacheIndex;
+
+static struct
+{
+  bool active;                  /* the preprocessed source went through the cache */
+  bool hit;
+  int cppStatus;                /* exit status of the preprocessor */
+  FILE *input;                  /* the preprocessed source on a miss */
+  time_t start;
+  char name[33];
+  struct dbuf_s key;
+}
+cache;
+
+/*-----------------------------------------------------------------*/
+/* cachePath - returns the name of a file in the cache directory   */
+/*-----------------------------------------------------------------*/
+static const char *
+cachePath (const char *file)
+{
+  static struct dbuf_s path;
+
+  if (dbuf_is_initialized (&path))
+    dbuf_set_length (&path, 0);
+  else
+    dbuf_init (&path, PATH_MAX);
+  dbuf_makePath (&path, options.cache_dir, file);
+  return dbuf_c_str (&path);
+}
+
+/*-----------------------------------------------------------------*/
+/* readFile - appends the contents of a file to a buffer           */
+/*-----------------------------------------------------------------*/
+static bool
+readFile (const char *name, struct dbuf_s *buf)
+{
+  char chunk[4096];
+  size_t n;
+  FILE *fp;
+
+  if (!(fp = fopen (name, "rb")))
+    return false;
+  while ((n = fread (chunk, 1, sizeof (chunk), fp)) > 0)
+    dbuf_append (buf, chunk, n);
+  fclose (fp);
+  return true;
+}
+
+/*-----------------------------------------------------------------*/
+/* sameString - compare function for isinSetWith                   */
+/*-----------------------------------------------------------------*/
+static int
+sameString (void *s1, void *s2)
+{
+  return !strcmp (s1, s2);
+}
+
+/*-----------------------------------------------------------------*/
+/* cacheOptionsKey - appends what besides the preprocessed source  */
+/*                   can change the output of a compilation        */
+/*-----------------------------------------------------------------*/
+void
+cacheOptionsKey (struct dbuf_s *key, int argc, char **argv)
+{
+  /* options that only name files or are for the preprocessor,
+     followed by their argument or with the argument attached */
+  static const char *const skip[] =
+    { "-o", "-I", "-D", "-U", "--cache-dir", "--cache-size", "--create-pch", "--use-pch", "--time-trace", NULL };
+  int i;
+
+  dbuf_printf (key, "%s #%s\n%s\n", SDCC_VERSION_STR, getBuildNumber (), port->target);
+
+  for (i = 1; i < argc; i++)
+    {
+      const char *const *s;
+
+      for (s = skip; *s; s++)
+        if (startsWith (argv[i], *s))
+          break;
+      if (*s)
+        {
+          if (!strcmp (argv[i], *s))
+            i++;
+          continue;
+        }
+
+      if ((fullSrcFileName && !strcmp (argv[i], fullSrcFileName)) || !strcmp (argv[i], "--cache-stats") ||
+        !strcmp (argv[i], "--mem-report") || !strcmp (argv[i], "--time-report") ||
+        isinSetWith (relFilesSet, argv[i], sameString) || isinSetWith (libFilesSet, argv[i], sameString))
+        continue;
+
+      dbuf_printf (key, "%s\n", argv[i]);
+    }
+
+  if (options.peep_file)
+    readFile (options.peep_file, key);
+}
+
+/*-----------------------------------------------------------------*/
+/* cacheHashInit, cacheHashAdd, cacheHashName - digest of a        */
+/*   sequence of buffers: two independent 64 bit hashes, FNV-1a    */
+/*   and a multiplicative one                                      */
+/*-----------------------------------------------------------------*/
+void
+cacheHashInit (cacheHash *h)
+{
+  h->h1 = 0xcbf29ce484222325ull;
+  h->h2 = 0x9e3779b97f4a7c15ull;
+}
+
+void
+cacheHashAdd (cacheHash *h, const void *data, size_t len)
+{
+  const unsigned char *p = data;
+
+  while (len--)
+    {
+      h->h1 = (h->h1 ^ *p) * 0x100000001b3ull;
+      h->h2 = (h->h2 + *p++) * 0xff51afd7ed558ccdull;
+      h->h2 ^= h->h2 >> 29;
+    }
+  /* keep "ab" + "c" apart from "a" + "bc" */
+  h->h1 = (h->h1 ^ 0xff) * 0x100000001b3ull;
+  h->h2 = (h->h2 + 0x100) * 0xff51afd7ed558ccdull;
+}
+
+void
+cacheHashName (const cacheHash *h, char *name)
+{
+  SNPRINTF (name, 33, "%016llx%016llx", h->h1, h->h2);
+}
+
+/*-----------------------------------------------------------------*/
+/* outputName - the name the given output file has this time       */
+/*-----------------------------------------------------------------*/
+static bool
+outputName (struct dbuf_s *path, int role)
+{
+  switch (role)
+    {
+    case OUT_ASM:
+      if (options.no_assemble && fullDstFileName)
+        dbuf_append_str (path, fullDstFileName);
+      else
+        dbuf_printf (path, "%s%s", dstFileName, port->assembler.file_ext);
+      return true;
+
+    case OUT_REL:
+      if (options.no_assemble)
+        return false;
+      if (options.cc_only && fullDstFileName)
+        dbuf_append_str (path, fullDstFileName);
+      else
+        dbuf_printf (path, "%s%s", dstFileName, port->linker.rel_ext);
+      return true;
+
+    case OUT_ADB:
+      if (!options.debug)
+        return false;
+      break;
+
+    default:
+      if (options.no_assemble)
+        return false;
+      break;
+    }
+
+  dbuf_printf (path, "%s.%s", dstFileName, outRole[role]);
+  return true;
+}
+
+/*-----------------------------------------------------------------*/
+/* readIndex - reads the statistics and the list of entries        */
+/*-----------------------------------------------------------------*/
+static void
+readIndex (cacheIndex *idx)
+{
+  cacheEntry e;
+  FILE *fp;
+
+  memset (idx, 0, sizeof (*idx));
+  if (!(fp = fopen (cachePath ("index"), "r")))
+    return;
+
+  if (fscanf (fp, "hits %lu misses %lu\n", &idx->hits, &idx->misses) == 2)
+    while (fscanf (fp, "%32s %lu %lu\n", e.name, &e.size, &e.used) == 3)
+      {
+        if (idx->count == idx->alloc)
+          {
+            idx->alloc = idx->alloc ? 2 * idx->alloc : 64;
+            idx->entries = Safe_realloc (idx->entries, idx->alloc * sizeof (cacheEntry));
+          }
+        idx->entries[idx->count++] = e;
+      }
+  fclose (fp);
+}
+
+/*-----------------------------------------------------------------*/
+/* writeIndex - replaces the index, and frees the list of entries  */
+/*-----------------------------------------------------------------*/
+static void
+writeIndex (cacheIndex *idx)
+{
+  char tmp[64];
+  unsigned int i;
+  FILE *fp;
+
+  SNPRINTF (tmp, sizeof (tmp), "index.%lu", (unsigned long) getpid ());
+  if ((fp = fopen (cachePath (tmp), "w")))
+    {
+      fprintf (fp, "hits %lu misses %lu\n", idx->hits, idx->misses);
+      for (i = 0; i < idx->count; i++)
+        fprintf (fp, "%s %lu %lu\n", idx->entries[i].name, idx->entries[i].size, idx->entries[i].used);
+      fclose (fp);
+
+      /* rename () does not replace an existing file on Windows */
+#ifdef _WIN32
+      remove (cachePath ("index"));
+#endif
+      {
+        char *from = Safe_strdup (cachePath (tmp));
+        rename (from, cachePath ("index"));
+        Safe_free (from);
+      }
+    }
+
+  Safe_free (idx->entries);
+  idx->entries = NULL;
+}
+
+/*-----------------------------------------------------------------*/
+/* findEntry - returns the index entry with the given name         */
+/*-----------------------------------------------------------------*/
+static cacheEntry *
+findEntry (cacheIndex *idx, const char *name)
+{
+  unsigned int i;
+
+  for (i = 0; i < idx->count; i++)
+    if (!strcmp (idx->entries[i].name, name))
+      return &idx->entries[i];
+  return NULL;
+}
+
+/*-----------------------------------------------------------------*/
+/* checkEntry - does the entry file belong to this compilation?    */
+/*-----------------------------------------------------------------*/
+static bool
+checkEntry (FILE *fp)
+{
+  char line[64];
+  unsigned long len;
+  bool same;
+  char *key;
+
+  /* read the header lines with fgets (), since a "\n" in the format of
+     fscanf () would also skip white space at the start of the data */
+  if (!fgets (line, sizeof (line), fp) || strcmp (line, CACHE_MAGIC) ||
+    !fgets (line, sizeof (line), fp) || sscanf (line, "%lu", &len) != 1 || len != dbuf_get_length (&cache.key))
+    return false;
+
+  key = Safe_malloc (len);
+  same = fread (key, 1, len, fp) == len && !memcmp (key, dbuf_get_buf (&cache.key), len);
+  Safe_free (key);
+  return same;
+}
+
+/*-----------------------------------------------------------------*/
+/* cacheLookup - reads the preprocessed source from yyin and looks */
+/*               for the outputs of an earlier compilation of it.  */
+/*               On a miss yyin is replaced by a copy of the source*/
+/*-----------------------------------------------------------------*/
+bool
+cacheLookup (int argc, char **argv)
+{
+  struct dbuf_s input;
+  cacheIndex idx;
+  cacheEntry *e;
+  cacheHash h;
+  char chunk[4096];
+  size_t n;
+  FILE *fp;
+
+  if (!options.cache_dir || options.c1mode || options.whole_program || options.syntax_only || options.pch_create)
+    return false;
+
+  time (&cache.start);
+  dbuf_init (&cache.key, 1024);
+  dbuf_printf (&cache.key, "%s\n", moduleName);
+  cacheOptionsKey (&cache.key, argc, argv);
+
+  dbuf_init (&input, 65536);
+  while ((n = fread (chunk, 1, sizeof (chunk), yyin)) > 0)
+    dbuf_append (&input, chunk, n);
+  cache.cppStatus = sdcc_pclose (yyin);
+  cache.active = true;
+
+  cacheHashInit (&h);
+  cacheHashAdd (&h, dbuf_get_buf (&cache.key), dbuf_get_length (&cache.key));
+  cacheHashAdd (&h, dbuf_get_buf (&input), dbuf_get_length (&input));
+  cacheHashName (&h, cache.name);
+
+#ifdef _WIN32
+  _mkdir (options.cache_dir);
+#else
+  mkdir (options.cache_dir, 0777);
+#endif
+
+  if (!cache.cppStatus && (fp = fopen (cachePath (cache.name), "rb")))
+    {
+      cache.hit = checkEntry (fp);
+      fclose (fp);
+    }
+
+  readIndex (&idx);
+  if (cache.hit)
+    {
+      idx.hits++;
+      if ((e = findEntry (&idx, cache.name)))
+        e->used = (unsigned long) cache.start;
+    }
+  else
+    idx.misses++;
+  writeIndex (&idx);
+
+  if (options.verbose)
+    printf ("sdcc: cache %s %s\n", cache.hit ? "hit" : "miss", cache.name);
+
+  if (!cache.hit)
+    {
+      /* hand the preprocessed source on to the parser */
+      if (!(cache.input = tmpfile ()))
+        {
+          werror (E_OUTPUT_FILE_OPEN_ERR, "tmpfile", strerror (errno));
+          exit (EXIT_FAILURE);
+        }
+      fwrite (dbuf_get_buf (&input), 1, dbuf_get_length (&input), cache.input);
+      rewind (cache.input);
+      yyin = cache.input;
+    }
+
+  dbuf_destroy (&input);
+  return cache.hit;
+}
+
+/*-----------------------------------------------------------------*/
+/* cachePclose - closes the preprocessed source                    */
+/*-----------------------------------------------------------------*/
+int
+cachePclose (FILE *fp)
+{
+  if (!cache.active || fp != cache.input)
+    return sdcc_pclose (fp);
+
+  fclose (fp);
+  cache.input = NULL;
+  return cache.cppStatus;
+}
+
+/*-----------------------------------------------------------------*/
+/* restoreEntry - writes the output files kept in the entry        */
+/*-----------------------------------------------------------------*/
+static void
+restoreEntry (void)
+{
+  struct dbuf_s path;
+  char line[64], role[8];
+  unsigned long size;
+  FILE *fp, *out;
+
+  if (!(fp = fopen (cachePath (cache.name), "rb")))
+    return;
+
+  if (checkEntry (fp))
+    while (fgets (line, sizeof (line), fp) && sscanf (line, "%7s %lu", role, &size) == 2)
+      {
+        int r;
+
+        for (r = 0; r < OUT_COUNT; r++)
+          if (!strcmp (role, outRole[r]))
+            break;
+
+        dbuf_init (&path, PATH_MAX);
+        out = NULL;
+        if (r < OUT_COUNT && outputName (&path, r) && !(out = fopen (dbuf_c_str (&path), "wb")))
+          werror (E_OUTPUT_FILE_OPEN_ERR, dbuf_c_str (&path), strerror (errno));
+        dbuf_destroy (&path);
+
+        while (size)
+          {
+            char chunk[4096];
+            size_t n = fread (chunk, 1, size < sizeof (chunk) ? size : sizeof (chunk), fp);
+
+            if (!n)
+              break;
+            if (out)
+              fwrite (chunk, 1, n, out);
+            size -= n;
+          }
+        if (out)
+          fclose (out);
+      }
+  fclose (fp);
+}
+
+/*-----------------------------------------------------------------*/
+/* storeEntry - keeps the output files of this compilation that    */
+/*              were written since it started                      */
+/*-----------------------------------------------------------------*/
+static void
+storeEntry (void)
+{
+  struct dbuf_s path, data;
+  char tmp[64];
+  cacheIndex idx;
+  cacheEntry *e;
+  unsigned long total;
+  unsigned int i;
+  long size;
+  FILE *fp;
+  int r;
+
+  SNPRINTF (tmp, sizeof (tmp), "%s.%lu", cache.name, (unsigned long) getpid ());
+  if (!(fp = fopen (cachePath (tmp), "wb")))
+    return;
+
+  fputs (CACHE_MAGIC, fp);
+  fprintf (fp, "%lu\n", (unsigned long) dbuf_get_length (&cache.key));
+  fwrite (dbuf_get_buf (&cache.key), 1, dbuf_get_length (&cache.key), fp);
+
+  for (r = 0; r < OUT_COUNT; r++)
+    {
+      struct stat st;
+
+      dbuf_init (&path, PATH_MAX);
+      dbuf_init (&data, 4096);
+      if (outputName (&path, r) && !stat (dbuf_c_str (&path), &st) && st.st_mtime >= cache.start &&
+        readFile (dbuf_c_str (&path), &data))
+        {
+          fprintf (fp, "%s %lu\n", outRole[r], (unsigned long) dbuf_get_length (&data));
+          fwrite (dbuf_get_buf (&data), 1, dbuf_get_length (&data), fp);
+        }
+      dbuf_destroy (&data);
+      dbuf_destroy (&path);
+    }
+
+  size = ftell (fp);
+  if (fclose (fp) || size < 0)
+    {
+      remove (cachePath (tmp));
+      return;
+    }
+
+  {
+    char *from = Safe_strdup (cachePath (tmp));
+#ifdef _WIN32
+    remove (cachePath (cache.name));
+#endif
+    rename (from, cachePath (cache.name));
+    Safe_free (from);
+  }
+
+  readIndex (&idx);
+  if (!(e = findEntry (&idx, cache.name)))
+    {
+      if (idx.count == idx.alloc)
+        {
+          idx.alloc = idx.alloc ? 2 * idx.alloc : 64;
+          idx.entries = Safe_realloc (idx.entries, idx.alloc * sizeof (cacheEntry));
+        }
+      e = &idx.entries[idx.count++];
+      strncpyz (e->name, cache.name, sizeof (e->name));
+    }
+  e->size = (unsigned long) size;
+  e->used = (unsigned long) cache.start;
+
+  /* evict the least recently used entries beyond the size limit */
+  for (;;)
+    {
+      unsigned int oldest = 0;
+
+      for (total = 0, i = 0; i < idx.count; i++)
+        {
+          total += idx.entries[i].size;
+          if (idx.entries[i].used < idx.entries[oldest].used)
+            oldest = i;
+        }
+      if (idx.count <= 1 || total / 1024 <= (unsigned long) options.cache_size)
+        break;
+
+      remove (cachePath (idx.entries[oldest].name));
+      idx.entries[oldest] = idx.entries[--idx.count];
+    }
+
+  writeIndex (&idx);
+}
+
+/*-----------------------------------------------------------------*/
+/* cacheFinish - restores the output files on a hit, or keeps the  */
+/*               ones of a successful compilation on a miss        */
+/*-----------------------------------------------------------------*/
+void
+cacheFinish (void)
+{
+  if (!cache.active)
+    return;
+
+  if (cache.hit)
+    restoreEntry ();
+  else if (!fatalError && !cache.cppStatus)
+    storeEntry ();
+
+  dbuf_destroy (&cache.key);
+  cache.active = false;
+}
+
+/*-----------------------------------------------------------------*/
+/* cachePrintStats - prints hits, misses and size of the cache     */
+/*-----------------------------------------------------------------*/
+void
+cachePrintStats (void)
+{
+  cacheIndex idx;
+  unsigned long total = 0;
+  unsigned int i;
+
+  if (!options.cache_dir)
+    {
+      printf ("no cache directory given\n");
+      return;
+    }
+
+  readIndex (&idx);
+  for (i = 0; i < idx.count; i++)
+    total += idx.entries[i].size;
+
+  printf ("cache directory: %s\n", options.cache_dir);
+  printf ("hits: %lu\n", idx.hits);
+  printf ("misses: %lu\n", idx.misses);
+  printf ("entries: %u\n", idx.count);
+  printf ("size: %lu of %lu kbytes\n", (total + 1023) / 1024, (unsigned long) options.cache_size);
+
+  Safe_free (idx.entries);
+}
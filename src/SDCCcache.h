@@ -0,0 +1,47 @@
+/*-------------------------------------------------------------------------
+  SDCCcache.h - cache of compilation results
+
+   This program is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the
+   Free Software Foundation; either version 2, or (at your option) any
+   later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+-------------------------------------------------------------------------*/
+
+#ifndef SDCCCACHE_H
+#define SDCCCACHE_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "dbuf.h"
+
+/* default upper bound of the cache size in kbytes */
+#define CACHE_DEFAULT_SIZE (64 * 1024)
+
+bool cacheLookup (int argc, char **argv);
+int cachePclose (FILE *fp);
+void cacheFinish (void);
+void cachePrintStats (void);
+
+/* also used for precompiled headers */
+typedef struct cacheHash
+{
+  unsigned long long h1, h2;
+}
+cacheHash;
+
+void cacheOptionsKey (struct dbuf_s *key, int argc, char **argv);
+void cacheHashInit (cacheHash *h);
+void cacheHashAdd (cacheHash *h, const void *data, size_t len);
+void cacheHashName (const cacheHash *h, char *name);
+
+#endif
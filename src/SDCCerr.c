@@ -691,6 +691,10 @@ struct
      "declaration within selection header requires ISO C2y or later", 0 },
   { E_COMPLIT_SCLASS_C23, ERROR_LEVEL_ERROR,
     "compound literals with storage class specifier require ISO C23 or later", 0},
+  { W_PCH_NOT_USED, ERROR_LEVEL_WARNING,
+    "precompiled header '%s' not used: %s", 0},
+  { E_PCH_CREATE, ERROR_LEVEL_ERROR,
+    "cannot create precompiled header '%s': %s", 0},
 };
 
 /* -------------------------------------------------------------------------------
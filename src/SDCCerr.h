@@ -341,6 +341,8 @@ enum {
   E_INVALID_OCTAL               = 311, /* \o{...} used without valid octal digits */
   E_SELECTION_DECLARATION_C2Y   = 312, /* declaration within selection header requires ISO C2y or later */
   E_COMPLIT_SCLASS_C23          = 313, /* compound literals with storage class specifier require ISO C23 or later */
+  W_PCH_NOT_USED                = 314, /* precompiled header does not fit the source */
+  E_PCH_CREATE                  = 315, /* precompiled header cannot be written */
 
   /* don't touch this! */
   NUMBER_OF_ERROR_MESSAGES             /* Number of error messages */
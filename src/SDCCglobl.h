@@ -205,6 +205,7 @@ struct optimize
     int label4;
     int loopInvariant;
     int loopInduction;
+    int loopUnroll;
     int noLoopReverse;
     int codeSpeed;
     int codeSize;
@@ -212,6 +213,7 @@ struct optimize
     int genconstprop;
     int allow_unsafe_read;
     int noStdLibCall;
+    int noClobberSummary;
   };
 
 /** Build model.
@@ -259,6 +261,7 @@ struct options
     int dump_ast;               /* dump front-end tree before lowering to iCode */
     int dump_i_code;            /* dump iCode at various stages */
     int dump_graphs;            /* Dump graphs in .dot format (control-flow, conflict, etc) */
+    int lospre_report;          /* Report per-function lospre statistics and time */
     int syntax_only;            /* Parse and check syntax only, generate no output files */
     int no_assemble;            /* Do not assemble, stop after code generation, generate asm */
     int cc_only;                /* compile and assemble only, generate asm and rel object */
@@ -323,6 +326,16 @@ struct options
     char *code_seg;             /* segment name to use instead of CSEG */
     char *const_seg;            /* segment name to use instead of CONST */
     char *data_seg;             /* segment name to use instead of DATA */
+    int split_areas;            /* put each function and constant object into an area of its own */
+    int whole_program;          /* compile all source files as one program into one module */
+    char *cache_dir;            /* directory of the compilation result cache */
+    int cache_size;             /* upper bound of the cache size in kbytes */
+    int cache_stats;            /* print the statistics of the cache */
+    char *pch_create;           /* precompiled header to be written */
+    char *pch_use;              /* precompiled header to be loaded */
+    int mem_report;             /* print the memory used by the phases of the compiler */
+    int time_report;            /* print the time used by the phases of the compiler */
+    char *time_trace;           /* file for the time used, in the Chrome trace event format */
     int dependencyFileOpt;      /* write dependencies to given file */
     /* sets */
     set *calleeSavesSet;        /* list of functions using callee save */
@@ -348,6 +361,7 @@ extern const char *fullDstFileName; /* full name for the output file; */
 extern const char *dstFileName; /* destination file name without extension */
 extern const char *moduleName;  /* module name is source file without path and extension */
                                 /* can be NULL while linking without compiling */
+extern int translationUnit;     /* number of the source file with --whole-program */
 extern int seqPointNo;          /* current sequence point */
 extern FILE *yyin;              /* */
 extern FILE *asmFile;           /* assembly output file */
@@ -396,6 +410,7 @@ enum {
   DUMP_LOOP,
   DUMP_LOOPG,
   DUMP_LOOPD,
+  DUMP_UNROLL,
   DUMP_LOSPRE,
   DUMP_GENCONSTPROP,
   DUMP_RANGE,
@@ -299,7 +299,10 @@ emitRegularMap (memmap *map, bool addPublics, bool arFlag)
                     if (!strstr (tmpBuf.buf, ps->name) && isinSet (strSym, ps))
                       addSet (&tmpSym, ps);
                   for (ps = setFirstItem (tmpSym); ps; ps = setNextItem (tmpSym))
-                    deleteSetItem (&statsg->syms, ps);
+                    {
+                      deleteSetItem (&statsg->syms, ps);
+                      removeStringSymbol (ps);
+                    }
 
                   deleteSet (&tmpSym);
                   dbuf_destroy (&tmpBuf);
@@ -1651,6 +1654,7 @@ printIvalCharPtr (symbol * sym, sym_link * type, value * val, struct dbuf_s *oBu
   if (!noInit && val->sym && val->sym->isstrlit && !isinSet (statsg->syms, val->sym))
     {
       addSet (&statsg->syms, val->sym);
+      addStringSymbol (val->sym);
     }
 
   return 1;
@@ -1881,6 +1885,196 @@ ilist_done:
     }
 }
 
+/*-----------------------------------------------------------------*/
+/* emitSplitArea - switch to the area of its own of a function or  */
+/*                 constant object, named seg.rname, so the linker */
+/*                 can leave it out when nothing refers to it      */
+/*-----------------------------------------------------------------*/
+void
+emitSplitArea (struct dbuf_s *oBuf, const char *seg, const char *rname, bool code)
+{
+  struct dbuf_s name;
+  size_t len = strcspn (seg, " \t(");
+
+  /* keep any area flags, as in "CSEG    (CODE)" */
+  dbuf_init (&name, 64);
+  dbuf_append (&name, seg, len);
+  dbuf_printf (&name, ".%s%s", rname, seg + len);
+  dbuf_tprintf (oBuf, code ? "\t!areacode\n" : "\t!area\n", dbuf_c_str (&name));
+  dbuf_destroy (&name);
+}
+
+/* a literal string emitted as the tail of a longer one */
+typedef struct strTail
+{
+  symbol *sym;
+  symbol *host;
+  int offset;
+} strTail;
+
+/*-----------------------------------------------------------------*/
+/* isTailLiteral - a literal string that may share its bytes       */
+/*-----------------------------------------------------------------*/
+static bool
+isTailLiteral (const symbol *sym)
+{
+  return sym->isstrlit && !sym->ival && !SPEC_ABSA (sym->etype) && !IS_EXTERN (sym->etype) &&
+         IS_ARRAY (sym->type) && IS_CHAR (sym->type->next) && SPEC_CVAL (sym->etype).v_char;
+}
+
+/*-----------------------------------------------------------------*/
+/* tailCompare - orders literal strings by their reversed contents */
+/*-----------------------------------------------------------------*/
+static int
+tailCompare (const void *a, const void *b)
+{
+  const symbol *sa = *(const symbol * const *) a;
+  const symbol *sb = *(const symbol * const *) b;
+  int la = getSize (sa->type);
+  int lb = getSize (sb->type);
+  const unsigned char *pa = (const unsigned char *) SPEC_CVAL (sa->etype).v_char + la;
+  const unsigned char *pb = (const unsigned char *) SPEC_CVAL (sb->etype).v_char + lb;
+
+  for (; la && lb; la--, lb--)
+    if (*--pa != *--pb)
+      return *pa - *pb;
+  if (la != lb)
+    return la - lb;
+  return strcmp (sa->rname, sb->rname);
+}
+
+static int
+tailSymCompare (const void *a, const void *b)
+{
+  const strTail *ta = a, *tb = b;
+
+  return ta->sym < tb->sym ? -1 : ta->sym > tb->sym;
+}
+
+static int
+tailHostCompare (const void *a, const void *b)
+{
+  const strTail *ta = a, *tb = b;
+
+  if (ta->host != tb->host)
+    return ta->host < tb->host ? -1 : 1;
+  if (ta->offset != tb->offset)
+    return ta->offset - tb->offset;
+  return strcmp (ta->sym->rname, tb->sym->rname);
+}
+
+/*-----------------------------------------------------------------*/
+/* findStrTails - finds the literal strings of map that are the    */
+/*                tail of a longer one, e.g. "error" of "fatal     */
+/*                error", and returns how many there are. *tails   */
+/*                gets them sorted by symbol, *hosts sorted by     */
+/*                their host and offset                            */
+/*-----------------------------------------------------------------*/
+static int
+findStrTails (memmap *map, strTail **tails, strTail **hosts)
+{
+  symbol *sym, **lits;
+  symbol **host;
+  set *keep = NULL;
+  int n = 0, m = 0, i;
+
+  *tails = *hosts = NULL;
+  for (sym = setFirstItem (map->syms); sym; sym = setNextItem (map->syms))
+    {
+      if (isTailLiteral (sym))
+        n++;
+      /* a literal initializing a char array may be freed while the map is emitted */
+      else if (sym->ival && IS_ARRAY (sym->type) && IS_CHAR (sym->type->next) &&
+               IS_AST_SYM_VALUE (list2expr (sym->ival)) && list2val (sym->ival, TRUE)->sym->isstrlit)
+        addSet (&keep, list2val (sym->ival, TRUE)->sym);
+    }
+  if (n < 2)
+    {
+      deleteSet (&keep);
+      return 0;
+    }
+
+  lits = Safe_malloc (n * sizeof (symbol *));
+  host = Safe_calloc (n, sizeof (symbol *));
+  n = 0;
+  for (sym = setFirstItem (map->syms); sym; sym = setNextItem (map->syms))
+    if (isTailLiteral (sym))
+      lits[n++] = sym;
+  qsort (lits, n, sizeof (symbol *), tailCompare);
+
+  /* a literal is a tail of another one iff it is one of the next in this order */
+  for (i = n - 2; i >= 0; i--)
+    {
+      int size = getSize (lits[i]->type);
+      int next = getSize (lits[i + 1]->type);
+
+      if (next < size ||
+          memcmp (SPEC_CVAL (lits[i]->etype).v_char, SPEC_CVAL (lits[i + 1]->etype).v_char + next - size, size))
+        continue;
+      if (host[i + 1])
+        host[i] = host[i + 1];
+      else if (!isinSet (keep, lits[i + 1]))
+        host[i] = lits[i + 1];
+      if (host[i])
+        m++;
+    }
+
+  if (m)
+    {
+      *tails = Safe_malloc (m * sizeof (strTail));
+      *hosts = Safe_malloc (m * sizeof (strTail));
+      m = 0;
+      for (i = 0; i < n; i++)
+        if (host[i])
+          {
+            (*tails)[m].sym = lits[i];
+            (*tails)[m].host = host[i];
+            (*tails)[m].offset = getSize (host[i]->type) - getSize (lits[i]->type);
+            m++;
+          }
+      memcpy (*hosts, *tails, m * sizeof (strTail));
+      qsort (*tails, m, sizeof (strTail), tailSymCompare);
+      qsort (*hosts, m, sizeof (strTail), tailHostCompare);
+    }
+
+  Safe_free (lits);
+  Safe_free (host);
+  deleteSet (&keep);
+  return m;
+}
+
+/*-----------------------------------------------------------------*/
+/* printStrTails - prints a literal string with the labels of the  */
+/*                 literal strings that are its tail               */
+/*-----------------------------------------------------------------*/
+static void
+printStrTails (struct dbuf_s *oBuf, symbol *sym, int size, const strTail *hosts, int n)
+{
+  const char *s = SPEC_CVAL (sym->etype).v_char;
+  int lo = 0, hi = n, done = 0;
+
+  while (lo < hi)
+    {
+      int mid = (lo + hi) / 2;
+      if (hosts[mid].host < sym)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+  for (; lo < n && hosts[lo].host == sym; lo++)
+    {
+      printChar (oBuf, s + done, hosts[lo].offset - done);
+      done = hosts[lo].offset;
+      if (options.debug)
+        {
+          emitDebugSym (oBuf, hosts[lo].sym);
+          dbuf_printf (oBuf, " == .\n");
+        }
+      dbuf_printf (oBuf, "%s:\n", hosts[lo].sym->rname);
+    }
+  printChar (oBuf, s + done, size - done);
+}
+
 /*-----------------------------------------------------------------*/
 /* emitStaticSeg - emitcode for the static segment                 */
 /*-----------------------------------------------------------------*/
@@ -1889,6 +2083,8 @@ emitStaticSeg (memmap *map, struct dbuf_s *oBuf)
 {
   symbol *sym;
   set *tmpSet = NULL;
+  strTail *tails, *hosts;
+  int ntails;
 
   /* fprintf(out, "\t.area\t%s\n", map->sname); */
 //printf("emitStaticSeg %s\n", map->sname);
@@ -1896,6 +2092,9 @@ emitStaticSeg (memmap *map, struct dbuf_s *oBuf)
   for (sym = setFirstItem (map->syms); sym; sym = setNextItem (map->syms))
     addSet (&tmpSet, sym);
 
+  /* literal strings that are the tail of another one are emitted with it */
+  ntails = findStrTails (map, &tails, &hosts);
+
   /* for all variables in this segment do */
   for (sym = setFirstItem (map->syms); sym; sym = setNextItem (map->syms))
     {//printf("emit symbol %s\n", sym->name);
@@ -1916,6 +2115,14 @@ emitStaticSeg (memmap *map, struct dbuf_s *oBuf)
             continue;
         }
 
+      if (ntails && isTailLiteral (sym))
+        {
+          strTail key;
+          key.sym = sym;
+          if (bsearch (&key, tails, ntails, sizeof (strTail), tailSymCompare))
+            continue;
+        }
+
       /* if it is not static add it to the public table */
       if (!IS_STATIC (sym->etype))
         {
@@ -1935,11 +2142,14 @@ emitStaticSeg (memmap *map, struct dbuf_s *oBuf)
       else
         {
           int size = getSize (sym->type);
+          bool split = options.split_areas && map == statsg && !SPEC_ABSA (sym->etype);
 
           if (size == 0)
             {
               werrorfl (sym->fileDef, sym->lineDef, E_UNKNOWN_SIZE, sym->name);
             }
+          if (split)
+            emitSplitArea (oBuf, options.const_seg ? options.const_seg : options.code_seg, sym->rname, !options.const_seg);
           /* if it has an initial value */
           if (sym->ival)
             {//printf("ival.\n");
@@ -1947,7 +2157,7 @@ emitStaticSeg (memmap *map, struct dbuf_s *oBuf)
                 {
                   dbuf_tprintf (oBuf, "\t!org\n", SPEC_ADDR (sym->etype));
                 }
-              else if (options.const_seg && map != xinit && map != initializer)
+              else if (options.const_seg && !split && map != xinit && map != initializer)
                 dbuf_tprintf(&code->oBuf, "\t!area\n", options.const_seg);
               if (options.debug)
                 {
@@ -1983,11 +2193,11 @@ emitStaticSeg (memmap *map, struct dbuf_s *oBuf)
                  IS_INT (sym->type->next) && !IS_LONG (sym->type->next) && SPEC_CVAL (sym->etype).v_char16 ||
                  IS_INT (sym->type->next) && IS_LONG (sym->type->next) && SPEC_CVAL (sym->etype).v_char32))
                 {
-                  if (options.const_seg)
+                  if (options.const_seg && !split)
                     dbuf_tprintf(&code->oBuf, "\t!area\n", options.const_seg);
                   dbuf_printf (oBuf, "%s:\n", sym->rname);
                   if (IS_CHAR (sym->type->next))
-                    printChar (oBuf, SPEC_CVAL (sym->etype).v_char, size);
+                    printStrTails (oBuf, sym, size, hosts, ntails);
                   else if (IS_INT (sym->type->next) && !IS_LONG (sym->type->next))
                     printChar16 (oBuf, SPEC_CVAL (sym->etype).v_char16, size / 2);
                   else if (IS_INT (sym->type->next) && IS_LONG (sym->type->next))
@@ -2008,6 +2218,8 @@ emitStaticSeg (memmap *map, struct dbuf_s *oBuf)
 
   if (tmpSet)
     deleteSet (&tmpSet);
+  Safe_free (tails);
+  Safe_free (hosts);
   if (ccpStr)
     {
       char *p;
@@ -2091,8 +2303,9 @@ flushStatics (void)
 
   emitStaticSeg (statsg, codeOutBuf);
   statsg->syms = 0;
+  clearStringSymbols ();
 
-  if (options.const_seg)
+  if (options.const_seg || options.split_areas && options.code_seg)
     dbuf_tprintf (&code->oBuf, "\t!area\n", options.code_seg);
 }
 
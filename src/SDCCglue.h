@@ -31,6 +31,7 @@ void glue (void);
 const char *aopLiteral (value *, int offset);
 const char *aopLiteralLong (value *val, int offset, int size);
 void flushStatics (void);
+void emitSplitArea (struct dbuf_s *oBuf, const char *seg, const char *rname, bool code);
 int printIvalCharPtr (symbol *, sym_link *, value *, struct dbuf_s *);
 
 extern symbol *interrupts[];
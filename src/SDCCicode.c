@@ -37,6 +37,7 @@ int iTempNum = 0;
 int iTempLblNum = 0;
 int operandKey = 0;
 int iCodeKey = 0;
+allocRegion funcRegion;          /* iCodes and basic blocks of the function being compiled */
 char *filename;                 /* current file name */
 int lineno = 1;                 /* current line number */
 int block;
@@ -606,7 +607,7 @@ newiCode (int op, operand *left, operand *right)
 {
   iCode *ic;
 
-  ic = Safe_alloc (sizeof (iCode));
+  ic = regionAlloc (&funcRegion, sizeof (iCode));
 
   ic->seqPoint = seqPoint;
   ic->filename = filename;
@@ -4196,6 +4197,480 @@ geniCodeJumpTable (operand * cond, value * caseVals, ast * tree)
   return 1;
 }
 
+/*-----------------------------------------------------------------*/
+/* Switch lowering for switches too sparse for a single jump table */
+/* The case values are partitioned into clusters, each of which is */
+/* a single value, a range of values with a common target, a bit   */
+/* test or a jump table.  The clusters are then dispatched by a    */
+/* binary search over their bounds.                                */
+/*-----------------------------------------------------------------*/
+enum swClusterKind
+{
+  SWC_SINGLE,
+  SWC_RANGE,
+  SWC_BITTEST,
+  SWC_TABLE
+};
+
+/* bit tests use an unsigned char mask */
+#define SW_BITTEST_SPAN 8
+#define SW_BITTEST_TARGETS 3
+
+typedef struct swCase
+{
+  long long val;                /* value, converted to the type of the condition */
+  symbol *label;                /* the _case_ label */
+  void *target;                 /* statement the label leads to */
+} swCase;
+
+typedef struct swCluster
+{
+  enum swClusterKind kind;
+  int first, last;              /* indices into the case array */
+} swCluster;
+
+typedef struct swLower
+{
+  operand *cond;
+  sym_link *cetype;
+  int sizeIndex;
+  swCase *cases;
+  int *runStart;                /* first case of the run of consecutive values with this target */
+  symbol *defaultLabel;
+  int leafSize;                 /* clusters tested linearly at a leaf of the search tree */
+} swLower;
+
+/*-----------------------------------------------------------------*/
+/* swFindTargets - maps labels to the statement they lead to, so   */
+/*                 cases sharing a body can be recognized          */
+/*-----------------------------------------------------------------*/
+static void
+swFindTargets (ast *tree, hTab **targets)
+{
+  while (tree && tree->type == EX_OP)
+    {
+      if (tree->opval.op == LABEL && IS_AST_SYM_VALUE (tree->left))
+        {
+          ast *stmt = tree->right;
+
+          while (stmt && stmt->type == EX_OP && stmt->opval.op == LABEL)
+            stmt = stmt->right;
+          if (stmt)
+            hTabAddItem (targets, AST_SYMBOL (tree->left)->key, stmt);
+        }
+      swFindTargets (tree->left, targets);
+      tree = tree->right;
+    }
+}
+
+/*-----------------------------------------------------------------*/
+/* swWrap - converts a value to an integer type of the given size  */
+/*-----------------------------------------------------------------*/
+static long long
+swWrap (unsigned long long v, int size, bool isUnsigned)
+{
+  if (size < 8)
+    {
+      unsigned long long mask = (1ull << (8 * size)) - 1;
+
+      v &= mask;
+      if (!isUnsigned && (v & (1ull << (8 * size - 1))))
+        v |= ~mask;
+    }
+  return (long long) v;
+}
+
+static int
+swCaseCompare (const void *a, const void *b)
+{
+  const swCase *ca = a, *cb = b;
+
+  return (ca->val > cb->val) - (ca->val < cb->val);
+}
+
+/*-----------------------------------------------------------------*/
+/* swClusterCost - size cost of a cluster, -1 if not possible      */
+/*-----------------------------------------------------------------*/
+static int
+swClusterCost (const swLower *sw, int first, int last, enum swClusterKind kind)
+{
+  const swCase *c = sw->cases;
+  long long span = c[last].val - c[first].val + 1;
+  int cnt = last - first + 1;
+  int i, j, targets;
+
+  switch (kind)
+    {
+    case SWC_SINGLE:
+      return cnt == 1 ? port->jumptableCost.sizeofMatchJump[sw->sizeIndex] : -1;
+
+    case SWC_RANGE:
+      if (cnt < 2 || sw->runStart[last] > first)
+        return -1;
+      return 2 * port->jumptableCost.sizeofRangeCompare[sw->sizeIndex];
+
+    case SWC_BITTEST:
+      if (cnt < 3 || span > SW_BITTEST_SPAN)
+        return -1;
+      for (targets = 0, i = first; i <= last; i++)
+        {
+          for (j = first; j < i && c[j].target != c[i].target; j++)
+            ;
+          if (j == i)
+            targets++;
+        }
+      if (targets > SW_BITTEST_TARGETS)
+        return -1;
+      /* the shift takes the place of the table dispatch */
+      return port->jumptableCost.sizeofSubtract + 2 * port->jumptableCost.sizeofRangeCompare[sw->sizeIndex] +
+        port->jumptableCost.sizeofDispatch + targets * port->jumptableCost.sizeofMatchJump[sw->sizeIndex];
+
+    case SWC_TABLE:
+      if (cnt < 2 || span > port->jumptableCost.maxCount)
+        return -1;
+      return span * port->jumptableCost.sizeofElement + port->jumptableCost.sizeofDispatch +
+        2 * port->jumptableCost.sizeofRangeCompare[sw->sizeIndex] + (c[first].val ? port->jumptableCost.sizeofSubtract : 0);
+    }
+  return -1;
+}
+
+/*-----------------------------------------------------------------*/
+/* swPartition - splits the sorted cases into clusters of minimal  */
+/*               total cost, returns the number of clusters        */
+/*-----------------------------------------------------------------*/
+static int
+swPartition (swLower *sw, int n, swCluster *clusters)
+{
+  int *best = Safe_alloc ((n + 1) * sizeof (int));
+  int *from = Safe_alloc ((n + 1) * sizeof (int));
+  enum swClusterKind *kind = Safe_alloc ((n + 1) * sizeof (enum swClusterKind));
+  long long window = port->jumptableCost.maxCount > SW_BITTEST_SPAN ? port->jumptableCost.maxCount : SW_BITTEST_SPAN;
+  /* every cluster adds a compare to the search tree; when optimizing */
+  /* for speed, favour fewer, larger clusters */
+  int overhead = port->jumptableCost.sizeofMatchJump[sw->sizeIndex] * (optimize.codeSpeed ? 2 : 1);
+  int i, j, k;
+
+  sw->runStart = Safe_alloc (n * sizeof (int));
+  for (i = 0; i < n; i++)
+    sw->runStart[i] = (i && sw->cases[i].val == sw->cases[i - 1].val + 1 &&
+                       sw->cases[i].target == sw->cases[i - 1].target) ? sw->runStart[i - 1] : i;
+
+#define SW_TRY(start, k) \
+  do \
+    { \
+      int cost = swClusterCost (sw, (start), j - 1, (k)); \
+      if (cost >= 0 && best[start] + cost + overhead < best[j]) \
+        { \
+          best[j] = best[start] + cost + overhead; \
+          from[j] = (start); \
+          kind[j] = (k); \
+        } \
+    } \
+  while (0)
+
+  best[0] = 0;
+  for (j = 1; j <= n; j++)
+    {
+      best[j] = INT_MAX;
+      /* a range is best taken as a whole */
+      SW_TRY (sw->runStart[j - 1], SWC_RANGE);
+      for (i = j - 1; i >= 0 && sw->cases[j - 1].val - sw->cases[i].val < window; i--)
+        {
+          SW_TRY (i, SWC_SINGLE);
+          SW_TRY (i, SWC_BITTEST);
+          SW_TRY (i, SWC_TABLE);
+        }
+    }
+#undef SW_TRY
+
+  /* walk back to collect the clusters, then put them in order */
+  for (k = 0, j = n; j > 0; j = from[j], k++)
+    {
+      clusters[k].kind = kind[j];
+      clusters[k].first = from[j];
+      clusters[k].last = j - 1;
+    }
+  for (i = 0; i < k / 2; i++)
+    {
+      swCluster t = clusters[i];
+      clusters[i] = clusters[k - 1 - i];
+      clusters[k - 1 - i] = t;
+    }
+
+  Safe_free (best);
+  Safe_free (from);
+  Safe_free (kind);
+  Safe_free (sw->runStart);
+  return k;
+}
+
+static operand *
+swLiteral (const swLower *sw, long long v)
+{
+  return operandFromValue (valCastLiteral (sw->cetype, (double) v, (TYPE_TARGET_ULONGLONG) v), false);
+}
+
+/*-----------------------------------------------------------------*/
+/* swIndex - condition minus the low bound, as table or shift index */
+/*-----------------------------------------------------------------*/
+static operand *
+swIndex (const swLower *sw, long long lo, long long span)
+{
+  operand *index = sw->cond;
+
+  if (lo)
+    {
+      index = geniCodeSubtract (sw->cond, operandFromLit ((double) lo), span <= 256 ? RESULT_TYPE_CHAR : RESULT_TYPE_INT);
+      if (!IS_LITERAL (getSpec (operandType (index))))
+        setOperandType (index, span <= 256 ? UCHARTYPE : UINTTYPE);
+    }
+  return index;
+}
+
+/*-----------------------------------------------------------------*/
+/* swEmitCluster - tests for one cluster; falls through if the     */
+/*                 condition is outside of it                      */
+/*-----------------------------------------------------------------*/
+static void
+swEmitCluster (const swLower *sw, const swCluster *cl, long long knownLo, long long knownHi)
+{
+  const swCase *c = sw->cases;
+  long long lo = c[cl->first].val, hi = c[cl->last].val;
+  symbol *skipLabel = NULL;
+  iCode *ic;
+  int i, j;
+
+  if (cl->kind == SWC_SINGLE)
+    {
+      if (knownLo == lo && knownHi == lo)
+        geniCodeGoto (c[cl->first].label);
+      else
+        {
+          ic = newiCodeCondition (geniCodeLogic (sw->cond, swLiteral (sw, lo), EQ_OP, NULL), c[cl->first].label, NULL);
+          ADDTOCHAIN (ic);
+        }
+      return;
+    }
+
+  /* bounds already established by the search tree need no test */
+  if (knownLo < lo)
+    {
+      skipLabel = newiTempLabel (NULL);
+      ic = newiCodeCondition (geniCodeLogic (sw->cond, swLiteral (sw, lo), '<', NULL), skipLabel, NULL);
+      ADDTOCHAIN (ic);
+    }
+  if (knownHi > hi)
+    {
+      operand *above = geniCodeLogic (sw->cond, swLiteral (sw, hi), '>', NULL);
+
+      if (cl->kind == SWC_RANGE)
+        {
+          ic = newiCodeCondition (above, NULL, c[cl->first].label);
+          ADDTOCHAIN (ic);
+          if (skipLabel)
+            geniCodeLabel (skipLabel);
+          return;
+        }
+      if (!skipLabel)
+        skipLabel = newiTempLabel (NULL);
+      ic = newiCodeCondition (above, skipLabel, NULL);
+      ADDTOCHAIN (ic);
+    }
+
+  switch (cl->kind)
+    {
+    case SWC_RANGE:
+      geniCodeGoto (c[cl->first].label);
+      break;
+
+    case SWC_BITTEST:
+      {
+        operand *bit = geniCodeLeftShift (operandFromValue (valCastLiteral (UCHARTYPE, 1, 1), false),
+                                          swIndex (sw, lo, hi - lo + 1), RESULT_TYPE_CHAR);
+
+        for (i = cl->first; i <= cl->last; i++)
+          {
+            unsigned char mask = 0;
+
+            /* one test per target, at its first case */
+            for (j = cl->first; j < i && c[j].target != c[i].target; j++)
+              ;
+            if (j < i)
+              continue;
+            for (j = i; j <= cl->last; j++)
+              if (c[j].target == c[i].target)
+                mask |= 1 << (c[j].val - lo);
+            ic = newiCodeCondition (geniCodeBitwise (bit, operandFromValue (valCastLiteral (UCHARTYPE, mask, mask), false),
+                                                     BITWISEAND, UCHARTYPE), c[i].label, NULL);
+            ADDTOCHAIN (ic);
+          }
+        geniCodeGoto (sw->defaultLabel);
+      }
+      break;
+
+    case SWC_TABLE:
+      {
+        set *labels = NULL;
+        long long v;
+
+        for (i = cl->first, v = lo; v <= hi; v++)
+          if (c[i].val == v)
+            addSet (&labels, c[i++].label);
+          else
+            addSet (&labels, sw->defaultLabel);
+
+        ic = newiCode (JUMPTABLE, NULL, NULL);
+        IC_JTCOND (ic) = swIndex (sw, lo, hi - lo + 1);
+        IC_JTLABELS (ic) = labels;
+        ADDTOCHAIN (ic);
+      }
+      break;
+
+    default:
+      break;
+    }
+
+  if (skipLabel)
+    geniCodeLabel (skipLabel);
+}
+
+/*-----------------------------------------------------------------*/
+/* swEmitTree - binary search over the clusters first .. last,     */
+/*              the condition is known to be in knownLo .. knownHi */
+/*-----------------------------------------------------------------*/
+static void
+swEmitTree (const swLower *sw, const swCluster *clusters, int first, int last, long long knownLo, long long knownHi)
+{
+  int i, mid;
+  long long pivot;
+  symbol *lowLabel;
+  iCode *ic;
+
+  if (last - first < sw->leafSize)
+    {
+      for (i = first; i <= last; i++)
+        swEmitCluster (sw, clusters + i, knownLo, knownHi);
+      geniCodeGoto (sw->defaultLabel);
+      return;
+    }
+
+  mid = (first + last + 1) / 2;
+  pivot = sw->cases[clusters[mid].first].val;
+  lowLabel = newiTempLabel (NULL);
+  ic = newiCodeCondition (geniCodeLogic (sw->cond, swLiteral (sw, pivot), '<', NULL), lowLabel, NULL);
+  ADDTOCHAIN (ic);
+  swEmitTree (sw, clusters, mid, last, pivot, knownHi);
+  geniCodeLabel (lowLabel);
+  swEmitTree (sw, clusters, first, mid - 1, knownLo, pivot - 1);
+}
+
+/*-----------------------------------------------------------------*/
+/* geniCodeSwitchTree - lowers a switch into clusters joined by a  */
+/*                      binary search; returns 0 if the plain      */
+/*                      compare chain should be used instead       */
+/*-----------------------------------------------------------------*/
+static int
+geniCodeSwitchTree (operand * cond, value * caseVals, ast * tree)
+{
+  swLower sw;
+  swCluster *clusters;
+  hTab *targets = NULL;
+  void *defaultTarget = NULL;
+  const char *suffix = tree->values.switchVals.swSuffix ? tree->values.switchVals.swSuffix : "";
+  sym_link *ctype = operandType (cond);
+  int size = getSize (ctype);
+  bool isUnsigned;
+  long long typeMin, typeMax;
+  struct dbuf_s dbuf;
+  value *vch;
+  int n, i, k, cnt;
+
+  if (IS_BOOL (ctype) || (size != 1 && size != 2 && size != 4))
+    return 0;
+  for (cnt = 0, vch = caseVals; vch; vch = vch->next)
+    cnt++;
+  if (cnt < 4)
+    return 0;
+
+  sw.cond = cond;
+  sw.cetype = getSpec (ctype);
+  sw.sizeIndex = size == 1 ? 0 : (size == 2 ? 1 : 2);
+  sw.leafSize = optimize.codeSize ? INT_MAX : (optimize.codeSpeed ? 2 : 3);
+  isUnsigned = IS_UNSIGNED (sw.cetype);
+  typeMin = isUnsigned ? 0 : -(1ll << (8 * size - 1));
+  typeMax = isUnsigned ? (long long) ((1ull << (8 * size)) - 1) : (1ll << (8 * size - 1)) - 1;
+
+  dbuf_init (&dbuf, 128);
+  if (tree->values.switchVals.swDefault)
+    dbuf_printf (&dbuf, "_default_%d%s", tree->values.switchVals.swNum, suffix);
+  else
+    dbuf_printf (&dbuf, "_swBrk_%d%s", tree->values.switchVals.swNum, suffix);
+  sw.defaultLabel = newiTempLabel (dbuf_c_str (&dbuf));
+  dbuf_destroy (&dbuf);
+
+  swFindTargets (tree->right, &targets);
+  if (tree->values.switchVals.swDefault)
+    defaultTarget = hTabItemWithKey (targets, sw.defaultLabel->key);
+
+  sw.cases = Safe_alloc (cnt * sizeof (swCase));
+  for (n = 0, vch = caseVals; vch; vch = vch->next)
+    {
+      /* the case value is converted to the promoted type of the condition */
+      long long val = size < INTSIZE ? swWrap (ullFromVal (vch), INTSIZE, false) : swWrap (ullFromVal (vch), size, isUnsigned);
+      symbol *label;
+
+      dbuf_init (&dbuf, 128);
+      dbuf_printf (&dbuf, "_case_%d_%d%s", tree->values.switchVals.swNum, (int) ulFromVal (vch), suffix);
+      label = newiTempLabel (dbuf_c_str (&dbuf));
+      dbuf_destroy (&dbuf);
+
+      /* cases that can never match, or that share the default body, need no test */
+      if (val < typeMin || val > typeMax)
+        continue;
+      sw.cases[n].target = hTabItemWithKey (targets, label->key);
+      if (defaultTarget && sw.cases[n].target == defaultTarget)
+        continue;
+      if (!sw.cases[n].target)
+        sw.cases[n].target = label;
+      sw.cases[n].val = val;
+      sw.cases[n].label = label;
+      n++;
+    }
+  hTabDeleteAll (targets);
+
+  qsort (sw.cases, n, sizeof (swCase), swCaseCompare);
+  for (i = k = 0; i < n; i++)
+    if (!k || sw.cases[i].val != sw.cases[k - 1].val)
+      sw.cases[k++] = sw.cases[i];
+  n = k;
+
+  if (!n)
+    {
+      geniCodeGoto (sw.defaultLabel);
+      Safe_free (sw.cases);
+      return 1;
+    }
+
+  clusters = Safe_alloc (n * sizeof (swCluster));
+  k = swPartition (&sw, n, clusters);
+
+  /* a short chain of single values is what the compare chain does anyway */
+  for (i = 0; i < k && clusters[i].kind == SWC_SINGLE; i++)
+    ;
+  if (i == k && k <= sw.leafSize && n == cnt)
+    {
+      Safe_free (clusters);
+      Safe_free (sw.cases);
+      return 0;
+    }
+
+  swEmitTree (&sw, clusters, 0, k - 1, typeMin, typeMax);
+
+  Safe_free (clusters);
+  Safe_free (sw.cases);
+  return 1;
+}
+
 /*-----------------------------------------------------------------*/
 /* geniCodeSwitch - changes a switch to a if statement             */
 /*-----------------------------------------------------------------*/
@@ -4255,6 +4730,10 @@ geniCodeSwitch (ast * tree, int lvl)
   if (geniCodeJumpTable (cond, caseVals, tree))
     goto jumpTable;             /* no need for the comparison */
 
+  /* otherwise try clusters joined by a binary search */
+  if (geniCodeSwitchTree (cond, caseVals, tree))
+    goto jumpTable;
+
   /* for the cases defined do */
   while (caseVals)
     {
@@ -4853,10 +5332,13 @@ ast2iCode (ast * tree, int lvl)
 iCode *
 iCodeFromAst (ast * tree)
 {
+  int phase = reportPhase (PHASE_ICODE);
+
   returnLabel = newiTempLabel ("_return");
   entryLabel = newiTempLabel ("_entry");
   iCodeChain = 0;
   ast2iCode (tree, 0);
+  reportPhase (phase);
   return (iCodeChain);
 }
 
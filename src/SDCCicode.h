@@ -23,6 +23,7 @@
 -------------------------------------------------------------------------*/
 #include "SDCCbitv.h"
 #include "SDCCset.h"
+#include "newalloc.h"
 
 #ifndef SDCCICODE_H
 #define SDCCICODE_H 1
@@ -30,6 +31,7 @@
 extern symbol *returnLabel;
 extern symbol *entryLabel;
 extern int iCodeKey;
+extern allocRegion funcRegion;
 extern int operandKey;
 
 enum
@@ -33,6 +33,7 @@ extern hTab *labelDef;
 extern int labelKey;
 
 iCode *iCodeLabelOptimize (iCode *);
+void buildLabelRefTable (iCode *);
 
 
 #endif
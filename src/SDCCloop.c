@@ -1429,3 +1429,451 @@ loopOptimizations (hTab * orderedLoops, ebbIndex * ebbi)
 
   return change;
 }
+
+/*-----------------------------------------------------------------*/
+/* unrollWrap - reduce a value to the range of an integer type     */
+/*-----------------------------------------------------------------*/
+static long long
+unrollWrap (long long val, sym_link *type)
+{
+  int bits = getSize (type) * 8;
+  unsigned long long uval = (unsigned long long) val & ((1ull << bits) - 1);
+
+  if (!IS_UNSIGNED (getSpec (type)) && (uval >> (bits - 1)))
+    return (long long) uval - (1ll << bits);
+  return (long long) uval;
+}
+
+/*-----------------------------------------------------------------*/
+/* unrollTest - evaluate the loop condition for known operands     */
+/*-----------------------------------------------------------------*/
+static bool
+unrollTest (int op, long long left, long long right)
+{
+  switch (op)
+    {
+    case '<':
+      return left < right;
+    case '>':
+      return left > right;
+    case LE_OP:
+      return left <= right;
+    case GE_OP:
+      return left >= right;
+    case EQ_OP:
+      return left == right;
+    default:
+      return left != right;
+    }
+}
+
+/*-----------------------------------------------------------------*/
+/* unrollSwapOp - the relation with its operands swapped           */
+/*-----------------------------------------------------------------*/
+static int
+unrollSwapOp (int op)
+{
+  switch (op)
+    {
+    case '<':
+      return '>';
+    case '>':
+      return '<';
+    case LE_OP:
+      return GE_OP;
+    case GE_OP:
+      return LE_OP;
+    default:
+      return op;
+    }
+}
+
+/*-----------------------------------------------------------------*/
+/* unrollInBody - all keys set in bv belong to iCodes of the body  */
+/*-----------------------------------------------------------------*/
+static bool
+unrollInBody (const bitVect *bv, const bitVect *bodyKeys)
+{
+  int i;
+
+  for (i = 0; bv && i < bv->size; i++)
+    if (bitVectBitValue (bv, i) && !bitVectBitValue (bodyKeys, i))
+      return FALSE;
+  return TRUE;
+}
+
+/*-----------------------------------------------------------------*/
+/* unrollRenameable - find the iTemps local to one straight-line   */
+/*                    piece of the body, each copy gets its own    */
+/*-----------------------------------------------------------------*/
+static bitVect *
+unrollRenameable (iCode *first, iCode *end, const bitVect *bodyKeys)
+{
+  hTab *segOf = NULL;
+  bitVect *bad = NULL, *ok = NULL;
+  iCode *seg = first, *ic;
+
+  for (ic = first; ic != end; ic = ic->next)
+    {
+      operand *uses[3];
+      int i;
+
+      if (ic->op == LABEL)
+        {
+          seg = ic;
+          continue;
+        }
+
+      uses[0] = IC_LEFT (ic);
+      uses[1] = IC_RIGHT (ic);
+      uses[2] = POINTER_SET (ic) ? IC_RESULT (ic) : NULL;
+      for (i = 0; i < 3; i++)
+        if (IS_ITEMP (uses[i]) && hTabItemWithKey (segOf, uses[i]->key) != seg)
+          bad = bitVectSetBit (bad, uses[i]->key);
+
+      if (IS_ITEMP (IC_RESULT (ic)) && !POINTER_SET (ic))
+        {
+          iCode *s = hTabItemWithKey (segOf, IC_RESULT (ic)->key);
+          if (!s)
+            hTabAddItem (&segOf, IC_RESULT (ic)->key, seg);
+          else if (s != seg)
+            bad = bitVectSetBit (bad, IC_RESULT (ic)->key);
+        }
+    }
+
+  for (ic = first; ic != end; ic = ic->next)
+    {
+      operand *op = IC_RESULT (ic);
+
+      if (ic->op == LABEL || !IS_ITEMP (op) || POINTER_SET (ic) || OP_SYMBOL (op)->isreqv)
+        continue;
+      if (bitVectBitValue (bad, op->key) || bitVectBitValue (ok, op->key))
+        continue;
+      if (unrollInBody (OP_DEFS (op), bodyKeys) && unrollInBody (OP_USES (op), bodyKeys))
+        ok = bitVectSetBit (ok, op->key);
+    }
+
+  hTabDeleteAll (segOf);
+  freeBitVect (bad);
+  return ok;
+}
+
+/*-----------------------------------------------------------------*/
+/* unrollOperand - operand of a copy of the loop body              */
+/*-----------------------------------------------------------------*/
+static operand *
+unrollOperand (operand *op, hTab **opMap, const bitVect *renameable)
+{
+  operand *nop;
+
+  if (!IS_ITEMP (op) || !bitVectBitValue (renameable, op->key))
+    return operandFromOperand (op);
+
+  if (!(nop = hTabItemWithKey (*opMap, op->key)))
+    {
+      nop = newiTempFromOp (op);
+      hTabAddItem (opMap, op->key, nop);
+    }
+  nop = operandFromOperand (nop);
+  nop->isaddr = op->isaddr;
+  return nop;
+}
+
+/*-----------------------------------------------------------------*/
+/* unrollCopy - insert a copy of first .. last before end          */
+/*-----------------------------------------------------------------*/
+static void
+unrollCopy (iCode *first, iCode *last, iCode *end, const bitVect *renameable)
+{
+  hTab *lblMap = NULL, *opMap = NULL;
+  iCode *ic;
+
+  /* labels inside the body get a fresh name in each copy */
+  for (ic = first;; ic = ic->next)
+    {
+      if (ic->op == LABEL)
+        hTabAddItem (&lblMap, IC_LABEL (ic)->key, newiTempLabel (NULL));
+      if (ic == last)
+        break;
+    }
+
+  for (ic = first;; ic = ic->next)
+    {
+      iCode *nic = copyiCode (ic);
+      symbol *lbl;
+
+      nic->seqPoint = ic->seqPoint;
+      nic->inlined = ic->inlined;
+      nic->argreg = ic->argreg;
+      nic->builtinSEND = ic->builtinSEND;
+      nic->tree = ic->tree;
+
+      switch (ic->op)
+        {
+        case LABEL:
+        case GOTO:
+          lbl = hTabItemWithKey (lblMap, IC_LABEL (ic)->key);
+          IC_LABEL (nic) = lbl ? lbl : IC_LABEL (ic);
+          break;
+        case IFX:
+          IC_COND (nic) = unrollOperand (IC_COND (ic), &opMap, renameable);
+          if (IC_TRUE (ic) && (lbl = hTabItemWithKey (lblMap, IC_TRUE (ic)->key)))
+            IC_TRUE (nic) = lbl;
+          if (IC_FALSE (ic) && (lbl = hTabItemWithKey (lblMap, IC_FALSE (ic)->key)))
+            IC_FALSE (nic) = lbl;
+          break;
+        default:
+          if (IC_LEFT (ic))
+            IC_LEFT (nic) = unrollOperand (IC_LEFT (ic), &opMap, renameable);
+          if (IC_RIGHT (ic))
+            IC_RIGHT (nic) = unrollOperand (IC_RIGHT (ic), &opMap, renameable);
+          if (IC_RESULT (ic))
+            IC_RESULT (nic) = unrollOperand (IC_RESULT (ic), &opMap, renameable);
+          break;
+        }
+
+      /* keep the def / use chains up to date for cse */
+      if (IS_SYMOP (IC_RESULT (nic)))
+        {
+          if (POINTER_SET (nic))
+            OP_USES (IC_RESULT (nic)) = bitVectSetBit (OP_USES (IC_RESULT (nic)), nic->key);
+          else
+            OP_DEFS (IC_RESULT (nic)) = bitVectSetBit (OP_DEFS (IC_RESULT (nic)), nic->key);
+        }
+      if (IS_SYMOP (IC_LEFT (nic)))
+        OP_USES (IC_LEFT (nic)) = bitVectSetBit (OP_USES (IC_LEFT (nic)), nic->key);
+      if (IS_SYMOP (IC_RIGHT (nic)))
+        OP_USES (IC_RIGHT (nic)) = bitVectSetBit (OP_USES (IC_RIGHT (nic)), nic->key);
+      hTabAddItem (&iCodehTab, nic->key, nic);
+
+      nic->prev = end->prev;
+      nic->next = end;
+      end->prev->next = nic;
+      end->prev = nic;
+
+      if (ic == last)
+        break;
+    }
+
+  hTabDeleteAll (lblMap);
+  hTabDeleteAll (opMap);
+}
+
+/*-----------------------------------------------------------------*/
+/* unrollLoop - unroll the loop closed by a backward conditional   */
+/*-----------------------------------------------------------------*/
+/* The loops handled are those the front end generates for        */
+/* counted for loops (after loop reversal):                        */
+/*                                                                 */
+/*           v := lit                                              */
+/*    hdr:   body, containing the only def of v, v = v +/- lit     */
+/*           [cmp:  t = v relop lit]                               */
+/*           if t (or v) goto hdr                                  */
+/*                                                                 */
+/* The trip count is found by simulation. The loop is either       */
+/* replaced by copies of its body, or its body is repeated a few   */
+/* times, with the test done once per round.                       */
+/*-----------------------------------------------------------------*/
+static int
+unrollLoop (iCode *ifx)
+{
+  symbol *hlbl = IC_TRUE (ifx) ? IC_TRUE (ifx) : IC_FALSE (ifx);
+  iCode *hic = hTabItemWithKey (labelDef, hlbl->key);
+  iCode *cmp, *end, *last, *upd = NULL, *ic;
+  operand *v, *k = NULL;
+  sym_link *vtype, *ktype;
+  bitVect *bodyKeys = NULL, *renameable;
+  long long init, step, kval = 0, val;
+  int relop = NE_OP, bodySize = 0, trips, factor, budget, i;
+
+  /* the only way into the loop is falling into the header */
+  if (!hic || hic->seq >= ifx->seq || hTabFirstItemWK (labelRef, hlbl->key) != ifx || hTabNextItemWK (labelRef))
+    return 0;
+
+  /* find the induction variable and the bound */
+  cmp = ifx->prev;
+  if (cmp != hic && IS_CONDITIONAL (cmp) && IS_ITEMP (IC_RESULT (cmp)) &&
+      IC_RESULT (cmp)->key == IC_COND (ifx)->key && bitVectnBitsOn (OP_USES (IC_COND (ifx))) == 1)
+    {
+      if (IS_OP_LITERAL (IC_RIGHT (cmp)))
+        {
+          v = IC_LEFT (cmp);
+          k = IC_RIGHT (cmp);
+          relop = cmp->op;
+        }
+      else
+        {
+          v = IC_RIGHT (cmp);
+          k = IC_LEFT (cmp);
+          relop = unrollSwapOp (cmp->op);
+        }
+      if (!IS_OP_LITERAL (k))
+        return 0;
+      kval = (long long) operandLitValue (k);
+      end = cmp;
+    }
+  else
+    {
+      v = IC_COND (ifx);
+      cmp = NULL;
+      end = ifx;
+    }
+
+  if (!IS_ITEMP (v) || IS_OP_VOLATILE (v))
+    return 0;
+  vtype = operandType (v);
+  ktype = k ? operandType (k) : vtype;
+  if (!IS_INTEGRAL (vtype) || IS_BOOLEAN (vtype) || getSize (vtype) > 4)
+    return 0;
+
+  /* check the body */
+  for (ic = hic->next; ic != end; ic = ic->next)
+    {
+      if (ic->op == INLINEASM || ic->op == JUMPTABLE)
+        return 0;
+
+      if (ic->op == LABEL)
+        {
+          iCode *ref;
+
+          /* no jumps into the middle of the body */
+          for (ref = hTabFirstItemWK (labelRef, IC_LABEL (ic)->key); ref; ref = hTabNextItemWK (labelRef))
+            if (ref->seq <= hic->seq || ref->seq >= ifx->seq)
+              return 0;
+          continue;
+        }
+
+      bodySize++;
+      bodyKeys = bitVectSetBit (bodyKeys, ic->key);
+
+      if (IC_RESULT (ic) && !POINTER_SET (ic) && isOperandEqual (IC_RESULT (ic), v))
+        {
+          if (upd)
+            return 0;
+          upd = ic;
+        }
+    }
+
+  /* the update has to run on every path to the test */
+  if (!upd || (upd->op != '+' && upd->op != '-'))
+    return 0;
+  if (isOperandEqual (IC_LEFT (upd), v) && IS_OP_LITERAL (IC_RIGHT (upd)))
+    step = (long long) operandLitValue (IC_RIGHT (upd));
+  else if (upd->op == '+' && isOperandEqual (IC_RIGHT (upd), v) && IS_OP_LITERAL (IC_LEFT (upd)))
+    step = (long long) operandLitValue (IC_LEFT (upd));
+  else
+    return 0;
+  if (upd->op == '-')
+    step = -step;
+  for (ic = upd->next; ic != end; ic = ic->next)
+    if (ic->op == LABEL)
+      return 0;
+
+  /* the value on entry */
+  for (ic = hic->prev;; ic = ic->prev)
+    {
+      if (!ic || ic->op == GOTO || ic->op == RETURN || ic->op == JUMPTABLE || ic->op == FUNCTION)
+        return 0;
+      if (ic->op == LABEL)
+        {
+          if (hTabItemWithKey (labelRef, IC_LABEL (ic)->key))
+            return 0;
+          continue;
+        }
+      if (IC_RESULT (ic) && !POINTER_SET (ic) && isOperandEqual (IC_RESULT (ic), v))
+        break;
+    }
+  if (ic->op != '=' || !IS_OP_LITERAL (IC_RIGHT (ic)))
+    return 0;
+  init = (long long) operandLitValue (IC_RIGHT (ic));
+
+  /* count the trips */
+  val = unrollWrap (init, vtype);
+  for (trips = 1;; trips++)
+    {
+      bool stay;
+
+      if (trips > 1024)
+        return 0;
+      val = unrollWrap (val + step, vtype);
+      if ((val < 0 || kval < 0) && (IS_UNSIGNED (getSpec (vtype)) || IS_UNSIGNED (getSpec (ktype))))
+        return 0;
+      stay = unrollTest (relop, val, kval);
+      if (stay != !!IC_TRUE (ifx))
+        break;
+    }
+
+  /* weigh the growth against what is saved per iteration */
+  budget = optimize.codeSize ? 0 : (optimize.codeSpeed ? 64 : 24);
+  if (hic->count >= 16)
+    budget *= 2;
+  else if (hic->count < 2)
+    budget /= 2;
+
+  if ((long) (trips - 1) * bodySize - (cmp ? 2 : 1) <= budget)
+    factor = trips;
+  else if (optimize.codeSpeed)
+    {
+      for (factor = 8; factor > 1; factor /= 2)
+        if (!(trips % factor) && (factor - 1) * bodySize <= budget)
+          break;
+      if (factor == 1)
+        return 0;
+    }
+  else
+    return 0;
+
+  renameable = unrollRenameable (hic->next, end, bodyKeys);
+  for (i = 1, last = end->prev; i < factor; i++)
+    unrollCopy (hic->next, last, end, renameable);
+  freeBitVect (renameable);
+  freeBitVect (bodyKeys);
+
+  /* fully unrolled: the test is gone */
+  if (factor == trips)
+    {
+      if (cmp)
+        {
+          unsetDefsAndUses (cmp);
+          cmp->prev->next = cmp->next;
+          cmp->next->prev = cmp->prev;
+        }
+      unsetDefsAndUses (ifx);
+      ifx->prev->next = ifx->next;
+      if (ifx->next)
+        ifx->next->prev = ifx->prev;
+    }
+
+  return 1;
+}
+
+/*-----------------------------------------------------------------*/
+/* loopUnroll - unroll loops with a constant trip count            */
+/*-----------------------------------------------------------------*/
+int
+loopUnroll (iCode *fic, ebbIndex *ebbi)
+{
+  iCode *ic, *next;
+  int change = 0;
+  int seq = 0;
+
+  for (ic = fic; ic; ic = ic->next)
+    ic->seq = seq++;
+  buildLabelRefTable (fic);
+  guessCounts (fic, ebbi);
+
+  /* inner loops close first */
+  for (ic = fic; ic; ic = next)
+    {
+      next = ic->next;
+      if (ic->op != IFX || !unrollLoop (ic))
+        continue;
+
+      change++;
+      for (seq = 0, ic = fic; ic; ic = ic->next)
+        ic->seq = seq++;
+      buildLabelRefTable (fic);
+    }
+
+  return change;
+}
@@ -53,5 +53,6 @@ induction;
 
 int loopOptimizations (hTab *, ebbIndex *);
 hTab *createLoopRegions (ebbIndex *);
+int loopUnroll (iCode *, ebbIndex *);
 
 #endif
@@ -22,6 +22,9 @@
 // #define DEBUG_LOSPRE // Uncomment to get debug messages while doing lospre.
 // #define DEBUG_LOSPRE_ASS // Uncomment to get debug messages on considered assignmentd while doing lospre.
 
+#include <unordered_map>
+#include <chrono>
+
 #include "SDCClospre.hpp"
 
 // A quick-and-dirty function to get the CFG from sdcc (a simplified version of the function from SDCCralloc.hpp).
@@ -338,29 +341,57 @@ lospre (iCode *sic, ebbIndex *ebbi)
 
   int lkey = operandKey;
 
+  std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+  unsigned int rounds = 0, candidates = 0, implemented = 0;
+
   for (bool change = true; change;)
     {
       change = false;
+      rounds++;
 
       std::set<int> candidate_set;
       get_candidate_set (&candidate_set, sic, lkey);
 
+      // Index iCodes by key, so we don't need to search the function for each candidate.
+      // Implementing an assignment inserts new iCodes, but leaves the existing ones (and their keys) in place,
+      // so the index stays valid for the candidates of this round.
+      std::unordered_map<int, const iCode *> key_to_ic;
+      key_to_ic.reserve (boost::num_vertices (control_flow_graph));
+      for (const iCode *ic = sic; ic; ic = ic->next)
+        key_to_ic[ic->key] = ic;
+
       std::set<int>::iterator ci, ci_end;
       for (ci = candidate_set.begin(), ci_end = candidate_set.end(); ci != ci_end; ++ci)
         {
-          const iCode *ic;
-          for (ic = sic; ic && ic->key != *ci; ic = ic->next);
+          std::unordered_map<int, const iCode *>::const_iterator ki = key_to_ic.find (*ci);
+          const iCode *ic = (ki != key_to_ic.end ()) ? ki->second : 0;
 
           if (!ic || !candidate_expression (ic, lkey))
             continue;
 
+          candidates++;
+
           bool safety = setup_cfg_for_expression (&control_flow_graph, ic);
 
           if (safety && tree_dec_safety (tree_decomposition, control_flow_graph, ic) < 0)
             continue;
 
-          change |= (tree_dec_lospre (tree_decomposition, control_flow_graph, ic) > 0);
+          if (tree_dec_lospre (tree_decomposition, control_flow_graph, ic) > 0)
+            {
+              change = true;
+              implemented++;
+            }
         }
     }
-}
 
+  if (options.lospre_report && currFunc)
+    {
+      std::chrono::duration<double> t = std::chrono::steady_clock::now() - start_time;
+      unsigned int w = 0;
+      for (unsigned int i = 0; i < boost::num_vertices (tree_decomposition); i++)
+        w = std::max (w, (unsigned int)(tree_decomposition[i].bag.size ()));
+      fprintf (stderr, "lospre: %s: %u iCodes, tree-decomposition width %u, %u candidates in %u rounds, %u implemented, %.3f s\n",
+        currFunc->rname, (unsigned int)(boost::num_vertices (control_flow_graph)), w ? w - 1 : 0,
+        candidates, rounds, implemented, t.count ());
+    }
+}
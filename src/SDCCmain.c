@@ -36,6 +36,8 @@
 #include "SDCCerr.h"
 #include "SDCCmacro.h"
 #include "SDCCargs.h"
+#include "SDCCcache.h"
+#include "SDCCpch.h"
 
 #ifdef _WIN32
 #include <process.h>
@@ -47,6 +49,7 @@
 
 /* REMOVE ME!!! */
 extern int yyparse (void);
+extern void yyrestart (FILE *);
 
 FILE *srcFile;                  /* source file */
 const char *fullSrcFileName;    /* full name for the source file; */
@@ -56,6 +59,7 @@ const char *fullDstFileName;    /* full name for the output file; */
 const char *dstFileName;        /* destination file name without extension */
 const char *moduleName;         /* module name is same as module name base, but with all */
                                 /* non-alphanumeric characters replaced with underscore */
+int translationUnit;            /* number of the source file with --whole-program */
 int currRegBank = 0;
 int RegBankUsed[4] = { 1, 0, 0, 0 };    /*JCF: Reg Bank 0 used by default */
 
@@ -70,6 +74,7 @@ set *linkOptionsSet2 = NULL;    /* set of linker options that must be passed on
 set *libFilesSet = NULL;
 set *libPathsSet = NULL;
 set *relFilesSet = NULL;
+static set *moreSrcFilesSet = NULL; /* further source files for --whole-program */
 set *dataDirsSet = NULL;        /* list of data search directories */
 set *includeDirsSet = NULL;     /* list of include search directories */
 set *userIncDirsSet = NULL;     /* list of user include directories */
@@ -122,6 +127,7 @@ char buffer[PATH_MAX * 2];
 #define OPTION_NO_LABEL_OPT         "--nolabelopt"
 #define OPTION_NO_LOOP_INV          "--noinvariant"
 #define OPTION_NO_LOOP_IND          "--noinduction"
+#define OPTION_NO_LOOP_UNROLL       "--nounroll"
 #define OPTION_LESS_PEDANTIC        "--less-pedantic"
 #define OPTION_DISABLE_WARNING      "--disable-warning"
 #define OPTION_WERROR               "--Werror"
@@ -153,8 +159,14 @@ char buffer[PATH_MAX * 2];
 #define OPTION_DUMP_AST             "--dump-ast"
 #define OPTION_DUMP_I_CODE          "--dump-i-code"
 #define OPTION_DUMP_GRAPHS          "--dump-graphs"
+#define OPTION_LOSPRE_REPORT        "--lospre-report"
 #define OPTION_INCLUDE              "--include"
 #define OPTION_NO_GENCONSTPROP      "--nogenconstprop"
+#define OPTION_CACHE_DIR            "--cache-dir"
+#define OPTION_CACHE_SIZE           "--cache-size"
+#define OPTION_CREATE_PCH           "--create-pch"
+#define OPTION_USE_PCH              "--use-pch"
+#define OPTION_TIME_TRACE           "--time-trace"
 
 #define OPTION_SMALL_MODEL          "--model-small"
 #define OPTION_MEDIUM_MODEL         "--model-medium"
@@ -183,6 +195,11 @@ static const OPTION optionsTable[] = {
   {'o', NULL, NULL, "Place the output into the given path resp. file"},
   {'x', NULL, NULL, "Optional file type override (c, c-header or none), valid until the next -x"},
   {0,   OPTION_PRINT_SEARCH_DIRS, &options.printSearchDirs, "display the directories in the compiler's search path"},
+  {0,   OPTION_CACHE_DIR, &options.cache_dir, "<dir> Reuse the results of earlier compilations kept in this directory", CLAT_STRING},
+  {0,   OPTION_CACHE_SIZE, &options.cache_size, "<kbytes> Upper bound of the size of the cache directory", CLAT_INTEGER},
+  {0,   "--cache-stats", &options.cache_stats, "Display the hits, misses and size of the cache"},
+  {0,   OPTION_CREATE_PCH, &options.pch_create, "<file> Save the declarations of the header the source file includes", CLAT_STRING},
+  {0,   OPTION_USE_PCH, &options.pch_use, "<file> Load the declarations of the first header from a precompiled header", CLAT_STRING},
   {0,   OPTION_MSVC_ERROR_STYLE, &options.vc_err_style, "messages are compatible with Micro$oft visual studio"},
   {0,   OPTION_USE_STDOUT, NULL, "send errors to stdout instead of stderr"},
   {0,   "--nostdlib", &options.nostdlib, "Do not include the standard library directory in the search path"},
@@ -192,6 +209,9 @@ static const OPTION optionsTable[] = {
   {0,   OPTION_WERROR, NULL, "Treat the warnings as errors"},
   {0,   OPTION_DEBUG, NULL, "Enable debugging symbol output"},
   {0,   "--cyclomatic", &options.cyclomatic, "Display complexity of compiled functions"},
+  {0,   "--mem-report", &options.mem_report, "Display the memory allocated in each phase and the peak memory use"},
+  {0,   "--time-report", &options.time_report, "Display the time used in each phase and the slowest functions"},
+  {0,   OPTION_TIME_TRACE, &options.time_trace, "<file> Write the time used by each phase and function in the Chrome trace event format", CLAT_STRING},
   {0,   OPTION_STD, NULL, "Determine the language standard (c90, c99, c11, c23, c2y, sdcc89 etc.)"},
   {0,   OPTION_DOLLARS_IN_IDENT, &options.dollars_in_ident, "Permit '$' as an identifier character"},
   {0,   OPTION_SIGNED_CHAR, &options.signed_char, "Make \"char\" signed by default"},
@@ -215,6 +235,7 @@ static const OPTION optionsTable[] = {
   {0,   OPTION_CODE_SEG, NULL, "<name> use this name for the code segment"},
   {0,   OPTION_CONST_SEG, NULL, "<name> use this name for the const segment"},
   {0,   OPTION_DATA_SEG, NULL, "<name> use this name for the data segment"},
+  {0,   "--split-areas", &options.split_areas, "Put each function and constant object into an area of its own"},
 
   {0,   NULL, NULL, "Optimization options"},
   {0,   OPTION_OPT_CODE_SPEED, NULL, "Optimize for code speed rather than size"},
@@ -230,17 +251,21 @@ static const OPTION optionsTable[] = {
   {0,   OPTION_NO_LOOP_INV, NULL, "Disable optimisation of invariants"},
   {0,   OPTION_NO_LOOP_IND, NULL, "Disable loop variable induction"},
   {0,   "--noloopreverse", &optimize.noLoopReverse, "Disable the loop reverse optimisation"},
+  {0,   OPTION_NO_LOOP_UNROLL, NULL, "Disable unrolling of loops with a constant trip count"},
+  {0,   "--noclobbersummary", &optimize.noClobberSummary, "Disable saving only the registers a called function writes"},
   {0,   "--no-peep", &options.nopeep, "Disable the peephole assembly file optimisation"},
   {0,   "--peep-asm", &options.asmpeep, "Enable peephole optimization on inline assembly"},
   {0,   OPTION_PEEP_RETURN, NULL, "Enable peephole optimization for return instructions"},
   {0,   OPTION_NO_PEEP_RETURN, NULL, "Disable peephole optimization for return instructions"},
   {0,   OPTION_PEEP_FILE, &options.peep_file, "<file> use this extra peephole file", CLAT_STRING},
   {0,   OPTION_ALLOW_UNSAFE_READ, NULL, "Allow optimizations to read any memory location anytime"},
+  {0,   "--whole-program", &options.whole_program, "Compile all source files as one program into a single module"},
 
   {0,   NULL, NULL, "Internal debugging options"},
   {0,   OPTION_DUMP_AST, &options.dump_ast, "Dump front-end AST before generating i-code"},
   {0,   OPTION_DUMP_I_CODE, &options.dump_i_code, "Dump the i-code structure at all stages"},
   {0,   OPTION_DUMP_GRAPHS, &options.dump_graphs, "Dump graphs (control-flow, conflict, etc)"},
+  {0,   OPTION_LOSPRE_REPORT, &options.lospre_report, "Report candidates, rounds and time of lospre for each function"},
   {0,   OPTION_ICODE_IN_ASM, &options.iCodeInAsm, "Include i-code as comments in the asm file"},
   {0,   OPTION_VERBOSE_ASM, &options.verboseAsm, "Include code generator comments in the asm output"},
 
@@ -660,6 +685,7 @@ setDefaultOptions (void)
   options.stack10bit = 0;
   options.out_fmt = 0;
   options.dump_graphs = 0;
+  options.lospre_report = 0;
   options.dependencyFileOpt = 0;
   options.sdcccall = port->sdcccall;
 
@@ -672,7 +698,9 @@ setDefaultOptions (void)
   optimize.label4 = 1;
   optimize.loopInvariant = 1;
   optimize.loopInduction = 1;
+  optimize.loopUnroll = 1;
   options.max_allocs_per_node = 3000;
+  options.cache_size = CACHE_DEFAULT_SIZE;
   optimize.lospre = 1;
   optimize.allow_unsafe_read = 0;
   optimize.genconstprop = 1;
@@ -717,10 +745,11 @@ processFile (char *s)
       dbuf_destroy (&ext);
 
       /* source file name : not if we already have a
-         source file */
+         source file, then it is either part of a whole
+         program or one too many */
       if (fullSrcFileName)
         {
-          werror (W_TOO_MANY_SRC, s);
+          addSet (&moreSrcFilesSet, Safe_strdup (s));
 
           dbuf_destroy (&path);
 
@@ -1211,6 +1240,12 @@ parseCmdLine (int argc, char **argv)
               continue;
             }
 
+          if (strcmp (argv[i], OPTION_NO_LOOP_UNROLL) == 0)
+            {
+              optimize.loopUnroll = 0;
+              continue;
+            }
+
           if (strcmp (argv[i], OPTION_OPT_CODE_SPEED) == 0)
             {
               optimize.codeSpeed = 1;
@@ -1681,8 +1716,13 @@ parseCmdLine (int argc, char **argv)
         {
           werror (W_NO_FILE_ARG_IN_C1, s);
         }
+      for (s = setFirstItem (moreSrcFilesSet); s != NULL; s = setNextItem (moreSrcFilesSet))
+        {
+          werror (W_NO_FILE_ARG_IN_C1, s);
+        }
       deleteSet (&relFilesSet);
       deleteSet (&libFilesSet);
+      deleteSet (&moreSrcFilesSet);
 
       if (options.cc_only || options.no_assemble || options.syntax_only || preProcOnly)
         {
@@ -1705,6 +1745,16 @@ parseCmdLine (int argc, char **argv)
           moduleName = m;
         }
     }
+  /* more than one source file only makes sense for a whole program */
+  if (!options.whole_program)
+    {
+      const char *s;
+
+      for (s = setFirstItem (moreSrcFilesSet); s != NULL; s = setNextItem (moreSrcFilesSet))
+        werror (W_TOO_MANY_SRC, s);
+      deleteSet (&moreSrcFilesSet);
+    }
+
   /* if no dstFileName given with -o, we've to find one: */
   if (!dstFileName)
     {
@@ -2467,6 +2517,35 @@ preProcess (char **envp)
   return 0;
 }
 
+/*-----------------------------------------------------------------*/
+/* preProcessNext - spawns the preprocessor for a further source   */
+/*                  file of a whole program, with the arguments    */
+/*                  preProcess has set up for the first one        */
+/*-----------------------------------------------------------------*/
+static void
+preProcessNext (const char *src)
+{
+  char *s, *buf;
+
+  s = shell_escape (src);
+  setMainValue ("fullsrcfilename", s);
+  Safe_free (s);
+
+  if (options.verbose)
+    printf ("sdcc: Calling preprocessor...\n");
+  buf = buildMacros (_preCmd);
+  buf = setPrefixSuffix (buf);
+  if (options.verbose)
+    printf ("sdcc: %s\n", buf);
+
+  yyin = sdcc_popen (buf);
+  if (yyin == NULL)
+    {
+      perror ("Preproc file not found");
+      exit (EXIT_FAILURE);
+    }
+}
+
 /* Set bin paths */
 static void
 setBinPaths (const char *argv0)
@@ -2839,10 +2918,13 @@ main (int argc, char **argv, char **envp)
   if (options.printSearchDirs)
     doPrintSearchDirs ();
 
+  if (options.cache_stats)
+    cachePrintStats ();
+
   /* if no input then printUsage & exit */
   if (!options.c1mode && !fullSrcFileName && peekSet (relFilesSet) == NULL)
     {
-      if (options.printSearchDirs)
+      if (options.printSearchDirs || options.cache_stats)
         exit (EXIT_SUCCESS);
       printUsage (TRUE);
       exit (EXIT_FAILURE);
@@ -2869,35 +2951,77 @@ main (int argc, char **argv, char **envp)
 
   if (fullSrcFileName || options.c1mode)
     {
+      reportPhase (PHASE_PREPROCESS);
       preProcess (envp);
+      reportPhase (PHASE_PARSE);
+    }
 
+  /* on a cache hit the output files are restored below */
+  if ((fullSrcFileName || options.c1mode) && !cacheLookup (argc, argv))
+    {
       initSymt ();
       initiCode ();
       initCSupport ();
       initBuiltIns ();
       initPeepHole ();
+      pchBegin (argc, argv);
 
       if (options.verbose)
         printf ("sdcc: Generating code...\n");
 
-      yyparse ();
-
-      if (options.syntax_only)
-        exit (fatalError ? EXIT_FAILURE : EXIT_SUCCESS);
+      /* each source file of a whole program starts out
+         with the options from the command line */
+      struct options unitOptions = options;
+      struct optimize unitOptimize = optimize;
+      const char *src = setFirstItem (moreSrcFilesSet);
 
-      if (!options.c1mode)
+      translationUnit = options.whole_program;
+      for (;;)
         {
-          int cl = sdcc_pclose (yyin);
-          if (cl)
+          yyparse ();
+
+          if (!options.c1mode)
             {
-              fprintf(stderr, "subprocess error %d\n", cl);
-              fatalError = 1;
+              int cl = pchPclose (yyin);
+              if (cl)
+                {
+                  fprintf(stderr, "subprocess error %d\n", cl);
+                  fatalError = 1;
+                }
             }
+
+          if (!src || fatalError)
+            break;
+
+          /* the identifiers with internal linkage, the typedefs and
+             the tags of a source file are not visible in the next one */
+          cleanUpFileScope ();
+          options = unitOptions;
+          optimize = unitOptimize;
+          translationUnit++;
+
+          reportPhase (PHASE_PREPROCESS);
+          preProcessNext (src);
+          reportPhase (PHASE_PARSE);
+          yyrestart (yyin);
+          src = setNextItem (moreSrcFilesSet);
+        }
+
+      if (options.pch_create && !fatalError)
+        {
+          pchWrite ();
+          exit (EXIT_SUCCESS);
         }
 
+      if (options.syntax_only)
+        exit (fatalError ? EXIT_FAILURE : EXIT_SUCCESS);
+
       if (fatalError)
         exit (EXIT_FAILURE);
 
+      reportPreprocessor ();
+
+      reportPhase (PHASE_GLUE);
       if (port->general.do_glue != NULL)
         (*port->general.do_glue) ();
       else
@@ -2915,6 +3039,7 @@ main (int argc, char **argv, char **envp)
         {
           if (options.verbose)
             printf ("sdcc: Calling assembler...\n");
+          reportPhase (PHASE_ASSEMBLE);
           assemble (envp);
         }
     }
@@ -2923,18 +3048,23 @@ main (int argc, char **argv, char **envp)
   if (options.debug && debugFile)
     debugFile->closeFile ();
 
+  cacheFinish ();
+
   if (!options.cc_only && !fatalError && !options.no_assemble && !options.c1mode &&
       (fullSrcFileName || peekSet (relFilesSet) != NULL))
     {
       if (options.verbose)
         printf ("sdcc: Calling linker...\n");
 
+      reportPhase (PHASE_LINK);
       if (port->linker.do_link)
         port->linker.do_link ();
       else
         linkEdit (envp);
     }
 
+  reportPrint ();
+
   return 0;
 }
 
@@ -523,7 +523,7 @@ allocGlobal (symbol *sym)
   /* symbol name is internal name  */
   if (!sym->level)              /* local statics can come here */
     SNPRINTF (sym->rname, sizeof(sym->rname),
-              "%s%s", port->fun_prefix, sym->name);
+              "%s%s", port->fun_prefix, linkName (sym));
 
   /* add it to the operandKey reset */
   if (!isinSet (operKeyReset, sym))
@@ -711,7 +711,7 @@ allocParms (value *val, bool smallc)
           /* allocate them in the automatic space */
           /* generate a unique name               */
           SNPRINTF (lval->sym->rname, sizeof(lval->sym->rname),
-                    "%s%s_PARM_%d", port->fun_prefix, currFunc->name, pNum);
+                    "%s%s_PARM_%d", port->fun_prefix, linkName (currFunc), pNum);
           strncpyz (lval->name, lval->sym->rname, sizeof(lval->name));
 
           /* if declared in specific storage */
@@ -822,7 +822,7 @@ allocLocal (symbol *sym)
   SNPRINTF (sym->rname, sizeof(sym->rname),
             "%s%s_%s_%d_%d",
             port->fun_prefix,
-            currFunc->name, sym->name, sym->level, sym->block);
+            linkName (currFunc), sym->name, sym->level, sym->block);
 
   if (!sym->ismyparm && IS_ARRAY(sym->type) && DCL_ARRAY_VLA (sym->type))
     {
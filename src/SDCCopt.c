@@ -3365,11 +3365,18 @@ eBBlockFromiCode (iCode *ic)
   int lchange = 0;
   int kchange = 0;
   hTab *loops;
+  int key;
+  int phase;
 
   /* if nothing passed then return nothing */
   if (!ic)
     return NULL;
 
+  phase = reportPhase (PHASE_OPTIMIZE);
+  reportFunctionBegin (currFunc ? currFunc->name : NULL);
+  for (iCode *lic = ic; lic; lic = lic->next)
+    reportCount (COUNT_ICODES, 1);
+
   eBBNum = 0;
 
   /* optimize the chain for labels & gotos
@@ -3419,7 +3426,9 @@ eBBlockFromiCode (iCode *ic)
   killDeadCode (ebbi);
 
   /* do common subexpression elimination for each block */
+  reportPhase (PHASE_CSE);
   change = cseAllBlocks (ebbi, FALSE);
+  reportPhase (PHASE_OPTIMIZE);
 
   /* dumpraw if asked for */
   if (options.dump_i_code)
@@ -3437,7 +3446,9 @@ eBBlockFromiCode (iCode *ic)
   /* global common subexpression elimination  */
   if (optimize.global_cse)
     {
+      reportPhase (PHASE_GCSE);
       change += cseAllBlocks (ebbi, FALSE);
+      reportPhase (PHASE_OPTIMIZE);
       if (options.dump_i_code)
         dumpEbbsToFileExt (DUMP_GCSE, ebbi);
     }
@@ -3459,7 +3470,9 @@ eBBlockFromiCode (iCode *ic)
   optimizeCastCast (ebbi->bbOrder, ebbi->count);
 
   /* do loop optimizations */
+  reportPhase (PHASE_LOOP);
   change += (lchange = loopOptimizations (loops, ebbi));
+  reportPhase (PHASE_OPTIMIZE);
   if (options.dump_i_code)
     dumpEbbsToFileExt (DUMP_LOOP, ebbi);
 
@@ -3473,7 +3486,9 @@ eBBlockFromiCode (iCode *ic)
   if (lchange || kchange)
     {
       computeDataFlow (ebbi);
+      reportPhase (PHASE_GCSE);
       change += cseAllBlocks (ebbi, FALSE);
+      reportPhase (PHASE_OPTIMIZE);
       if (options.dump_i_code)
         dumpEbbsToFileExt (DUMP_LOOPG, ebbi);
 
@@ -3487,6 +3502,30 @@ eBBlockFromiCode (iCode *ic)
         dumpEbbsToFileExt (DUMP_LOOPD, ebbi);
     }
 
+  /* unroll loops with a constant trip count, then let cse
+     fold the induction variable into the copies */
+  if (optimize.loopUnroll && hTabFirstItem (loops, &key))
+    {
+      ic = iCodeLabelOptimize (iCodeFromeBBlock (ebbi->bbOrder, ebbi->count));
+      reportPhase (PHASE_LOOP);
+      lchange = loopUnroll (ic, ebbi);
+      reportPhase (PHASE_OPTIMIZE);
+      if (lchange)
+        ic = iCodeLabelOptimize (ic);
+      freeeBBlockData (ebbi);
+      ebbi = iCodeBreakDown (ic);
+      computeControlFlow (ebbi);
+      loops = createLoopRegions (ebbi);
+      computeDataFlow (ebbi);
+      if (lchange)
+        {
+          change += cseAllBlocks (ebbi, FALSE);
+          killDeadCode (ebbi);
+          if (options.dump_i_code)
+            dumpEbbsToFileExt (DUMP_UNROLL, ebbi);
+        }
+    }
+
   offsetFoldGet (ebbi->bbOrder, ebbi->count);
   optimizeCastCast (ebbi->bbOrder, ebbi->count);
   computeControlFlow (ebbi);
@@ -3498,8 +3537,10 @@ eBBlockFromiCode (iCode *ic)
   if (optimize.genconstprop)
     {
       ic = iCodeLabelOptimize (iCodeFromeBBlock (ebbi->bbOrder, ebbi->count));
+      reportPhase (PHASE_GENCONSTPROP);
       recomputeValinfos (ic, ebbi, "_0");
       optimizeValinfo (ic);
+      reportPhase (PHASE_OPTIMIZE);
       freeeBBlockData (ebbi);
       ebbi = iCodeBreakDown (ic);
       computeControlFlow (ebbi);
@@ -3519,7 +3560,9 @@ eBBlockFromiCode (iCode *ic)
   guessCounts (ic, ebbi);
   if (optimize.lospre && (TARGET_Z80_LIKE || TARGET_HC08_LIKE || TARGET_IS_STM8 || TARGET_F8_LIKE)) /* For mcs51, we get a code size regression with lospre enabled, since the backend can't deal well with the added temporaries */
     {
+      reportPhase (PHASE_LOSPRE);
       lospre (ic, ebbi);
+      reportPhase (PHASE_OPTIMIZE);
       if (options.dump_i_code)
         dumpEbbsToFileExt (DUMP_LOSPRE, ebbi);
 
@@ -3559,8 +3602,10 @@ eBBlockFromiCode (iCode *ic)
      (but assume that it can happen in other functions) */
   adjustIChain (ebbi->bbOrder, ebbi->count);
   ic = iCodeLabelOptimize (iCodeFromeBBlock (ebbi->bbOrder, ebbi->count));
+  reportPhase (PHASE_NADDR);
   if (!currFunc || switchAddressSpacesOptimally (ic, ebbi))
     switchAddressSpaces (ic); /* Fallback. Very unlikely to be triggered, unless --max-allocs-per-node is set to very small values or very weird control-flow graphs */
+  reportPhase (PHASE_OPTIMIZE);
 
   /* Break down again and redo some steps to not confuse live range analysis. */
   freeeBBlockData (ebbi);
@@ -3614,8 +3659,10 @@ eBBlockFromiCode (iCode *ic)
       computeDataFlow (ebbi);
       recomputeLiveRanges (ebbi->bbOrder, ebbi->count, false);
       ic = iCodeLabelOptimize (iCodeFromeBBlock (ebbi->bbOrder, ebbi->count));
+      reportPhase (PHASE_GENCONSTPROP);
       recomputeValinfos (ic, ebbi, "_1");
       optimizeValinfo (ic);
+      reportPhase (PHASE_OPTIMIZE);
       freeeBBlockData (ebbi);
       ebbi = iCodeBreakDown (ic);
       computeControlFlow (ebbi);
@@ -3663,12 +3710,20 @@ eBBlockFromiCode (iCode *ic)
 
   /* allocate registers & generate code */
   if (!options.syntax_only)
-    port->assignRegisters (ebbi);
+    {
+      reportPhase (PHASE_RALLOC);
+      port->assignRegisters (ebbi);
+    }
 
   /* throw away blocks */
   setToNull ((void *) &graphEdges);
   freeeBBlockData (ebbi);
 
+  /* the code is out, the iCodes and the blocks can go */
+  reportFunctionEnd (funcRegion.size);
+  freeRegion (&funcRegion);
+  reportPhase (phase);
+
   return NULL;
 }
 
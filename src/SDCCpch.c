@@ -0,0 +1,1204 @@
+/*-------------------------------------------------------------------------
+  SDCCpch.c - precompiled headers
+
+   This program is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the
+   Free Software Foundation; either version 2, or (at your option) any
+   later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+-------------------------------------------------------------------------*/
+
+/* A precompiled header keeps what the front end knows after parsing
+   the first header a source file includes: the symbols, typedefs,
+   struct and enum tags the header declares, and the symbols it put
+   into the memory maps.
+
+   With --create-pch the source file may only include the header. The
+   header part of the preprocessed source is the text from the line
+   marker entering the header to the one returning to the source. Its
+   digest is kept in the precompiled header, together with the options.
+
+   With --use-pch the header part of the preprocessed source is looked
+   up the same way. If its digest and the options are the same, the
+   tables are loaded from the precompiled header and the parser only
+   gets the rest of the source. The header is still preprocessed, so
+   its macros are right, and a different define or a changed header
+   gives a different digest.
+
+   The objects the front end has before the source is parsed (the
+   support routines and builtins) are referred to by their position
+   in a walk over the tables, which is the same whenever the options
+   are the same. A digest of them is kept as well. Only headers that
+   just declare things can be precompiled: function definitions,
+   initializers and pragmas are refused. */
+
+#include <stdint.h>
+#include <errno.h>
+
+#include "common.h"
+#include "dbuf_string.h"
+#include "SDCCcache.h"
+#include "SDCCpch.h"
+
+#define PCH_MAGIC "sdcc-pch 1\n"
+
+/* kinds of objects */
+enum
+{
+  K_SYMBOL,
+  K_LINK,
+  K_STRUCT,
+  K_VALUE,
+  K_STRING,
+  K_MEMMAP,
+  K_AST
+};
+
+static const size_t kindSize[] = { sizeof (symbol), sizeof (sym_link), sizeof (structdef), sizeof (value) };
+
+/* the tables the header can add to */
+static bucket **const tables[] = { SymbolTab, StructTab, TypedefTab, enumTab, AddrspaceTab };
+
+#define NTABLES (sizeof (tables) / sizeof (tables[0]))
+
+/* the memory maps symbols can be put into */
+static memmap **const maps[] =
+{
+  &xstack, &istack, &code, &data, &initialized, &initializer, &pdata, &xdata, &xidata, &xinit, &idata, &bit,
+  &statsg, &c_abs, &x_abs, &i_abs, &d_abs, &sfr, &reg, &sfrbit, &generic, &overlay, &eeprom, &home
+};
+
+#define NMAPS (sizeof (maps) / sizeof (maps[0]))
+
+/* the sets of symbols the header can add to: the symbols of the
+   memory maps, then operKeyReset and publics */
+#define NSETS (NMAPS + 2)
+
+/* changes to the tables and the sets */
+enum
+{
+  PCH_DELETE_SYM,
+  PCH_ADD_SYM,
+  PCH_DELETE_ITEM,
+  PCH_ADD_ITEM
+};
+
+typedef union
+{
+  symbol sym;
+  sym_link link;
+  structdef sdef;
+  value val;
+}
+pchCopy;
+
+typedef struct pchObject
+{
+  int kind;
+  void *ptr;
+}
+pchObject;
+
+typedef struct pchObjects
+{
+  pchObject *obj;
+  unsigned int count;
+  unsigned int alloc;
+}
+pchObjects;
+
+/* from pointers to codes, open addressing */
+typedef struct ptrMap
+{
+  const void **keys;
+  uintptr_t *vals;
+  unsigned int cap;
+  unsigned int count;
+}
+ptrMap;
+
+static struct
+{
+  FILE *input;                  /* the preprocessed source handed to the parser */
+  int cppStatus;                /* exit status of the preprocessor */
+  char digest[33];              /* of the header part of the preprocessed source */
+  char *header;                 /* name of the header */
+  struct dbuf_s key;            /* options and layout of the objects */
+
+  /* what was there before the header was parsed */
+  pchObjects known;
+  char knownDigest[33];
+  ptrMap codes;
+  ptrMap buckets;
+  set *oldBuckets[NTABLES];
+  set *oldItems[NSETS];
+  size_t bufLength[NMAPS];
+  symbol *interrupts[INTNO_MAX + 1];
+  namedspacemap *namedspacemaps;
+}
+pch;
+
+/* how relocate () maps the pointer fields of an object */
+static enum
+{
+  R_KNOWN,                      /* to codes, unknown objects become known */
+  R_CHECK,                      /* to codes of known objects only */
+  R_SAVE,                       /* to codes, unknown objects go to robjects */
+  R_LOAD                        /* from codes back to objects */
+}
+rmode;
+
+static pchObjects *robjects;    /* the objects of the header */
+static const char *unsupported; /* why the header cannot be precompiled */
+
+/*-----------------------------------------------------------------*/
+/* ptrHash - start of the probe sequence for a pointer             */
+/*-----------------------------------------------------------------*/
+static unsigned int
+ptrHash (const ptrMap *m, const void *key)
+{
+  return (unsigned int) (((uintptr_t) key >> 4) * 2654435761u) & (m->cap - 1);
+}
+
+/*-----------------------------------------------------------------*/
+/* ptrMapGet - returns the code for a pointer, 0 if there is none  */
+/*-----------------------------------------------------------------*/
+static uintptr_t
+ptrMapGet (const ptrMap *m, const void *key)
+{
+  unsigned int i;
+
+  if (!m->cap)
+    return 0;
+
+  for (i = ptrHash (m, key); m->keys[i]; i = (i + 1) & (m->cap - 1))
+    if (m->keys[i] == key)
+      return m->vals[i];
+  return 0;
+}
+
+/*-----------------------------------------------------------------*/
+/* ptrMapPut - sets the code for a pointer                         */
+/*-----------------------------------------------------------------*/
+static void
+ptrMapPut (ptrMap *m, const void *key, uintptr_t val)
+{
+  unsigned int i;
+
+  if (2 * (m->count + 1) > m->cap)
+    {
+      ptrMap old = *m;
+
+      m->cap = old.cap ? 2 * old.cap : 1024;
+      m->count = 0;
+      m->keys = Safe_calloc (m->cap, sizeof (*m->keys));
+      m->vals = Safe_calloc (m->cap, sizeof (*m->vals));
+      for (i = 0; i < old.cap; i++)
+        if (old.keys[i])
+          ptrMapPut (m, old.keys[i], old.vals[i]);
+      Safe_free (old.keys);
+      Safe_free (old.vals);
+    }
+
+  for (i = ptrHash (m, key); m->keys[i]; i = (i + 1) & (m->cap - 1))
+    if (m->keys[i] == key)
+      break;
+  if (!m->keys[i])
+    m->count++;
+  m->keys[i] = key;
+  m->vals[i] = val;
+}
+
+/*-----------------------------------------------------------------*/
+/* addObject - appends an object to a list and returns its code:   */
+/*             known objects have odd codes, the others even codes */
+/*-----------------------------------------------------------------*/
+static uintptr_t
+addObject (pchObjects *list, int kind, void *ptr)
+{
+  if (list->count == list->alloc)
+    {
+      list->alloc = list->alloc ? 2 * list->alloc : 1024;
+      list->obj = Safe_realloc (list->obj, list->alloc * sizeof (pchObject));
+    }
+  list->obj[list->count].kind = kind;
+  list->obj[list->count].ptr = ptr;
+  list->count++;
+  return ((uintptr_t) list->count << 1) | (list == &pch.known);
+}
+
+/*-----------------------------------------------------------------*/
+/* relocatePtr - maps one pointer as rmode says                    */
+/*-----------------------------------------------------------------*/
+static void *
+relocatePtr (void *p, int kind)
+{
+  uintptr_t c;
+  unsigned int i;
+
+  if (!p)
+    return NULL;
+
+  /* an array size, only the value of which is kept */
+  if (kind == K_AST)
+    return rmode == R_LOAD ? p : (void *) 1;
+
+  if (kind == K_MEMMAP)
+    {
+      if (rmode == R_LOAD)
+        return (uintptr_t) p <= NMAPS ? *maps[(uintptr_t) p - 1] : NULL;
+      for (i = 0; i < NMAPS; i++)
+        if (*maps[i] == p)
+          return (void *) (uintptr_t) (i + 1);
+      unsupported = "named address space";
+      return NULL;
+    }
+
+  if (rmode == R_LOAD)
+    {
+      pchObjects *list = ((uintptr_t) p & 1) ? &pch.known : robjects;
+
+      c = (uintptr_t) p >> 1;
+      return c && c <= list->count ? list->obj[c - 1].ptr : NULL;
+    }
+
+  if (!(c = ptrMapGet (&pch.codes, p)))
+    {
+      if (rmode == R_CHECK)
+        {
+          unsupported = "header changes a predefined symbol";
+          return NULL;
+        }
+      c = addObject (rmode == R_KNOWN ? &pch.known : robjects, kind, p);
+      ptrMapPut (&pch.codes, p, c);
+    }
+  return (void *) c;
+}
+
+/*-----------------------------------------------------------------*/
+/* relocate - maps the pointer in a field of an object             */
+/*-----------------------------------------------------------------*/
+static void
+relocate (void *field, int kind)
+{
+  void *p;
+
+  memcpy (&p, field, sizeof (p));
+  p = relocatePtr (p, kind);
+  memcpy (field, &p, sizeof (p));
+}
+
+/*-----------------------------------------------------------------*/
+/* relocateObject - maps the pointer fields of an object           */
+/*-----------------------------------------------------------------*/
+static void
+relocateObject (int kind, void *obj)
+{
+  switch (kind)
+    {
+    case K_SYMBOL:
+      {
+        symbol *sym = obj;
+
+        relocate (&sym->type, K_LINK);
+        relocate (&sym->etype, K_LINK);
+        relocate (&sym->next, K_SYMBOL);
+        relocate (&sym->localof, K_SYMBOL);
+        relocate (&sym->addressmod[0], K_SYMBOL);
+        relocate (&sym->addressmod[1], K_SYMBOL);
+        relocate (&sym->fileDef, K_STRING);
+        break;
+      }
+
+    case K_LINK:
+      {
+        sym_link *l = obj;
+
+        if (l->xclass == SPECIFIER)
+          {
+            relocate (&l->select.s.oclass, K_MEMMAP);
+            relocate (&l->select.s.addrspace, K_SYMBOL);
+            relocate (&l->select.s.v_struct, K_STRUCT);
+          }
+        else
+          {
+            relocate (&l->select.d.ptr_addrspace, K_SYMBOL);
+            relocate (&l->select.d.tspec, K_LINK);
+            relocate (&l->select.d.num_elem_ast, K_AST);
+            if (rmode == R_LOAD && l->select.d.num_elem_ast)
+              l->select.d.num_elem_ast = newAst_VALUE (valueFromLit (l->select.d.num_elem));
+          }
+        relocate (&l->funcAttrs.args, K_VALUE);
+        relocate (&l->next, K_LINK);
+        break;
+      }
+
+    case K_STRUCT:
+      {
+        structdef *sdef = obj;
+
+        relocate (&sdef->fields, K_SYMBOL);
+        relocate (&sdef->tagsym, K_SYMBOL);
+        break;
+      }
+
+    case K_VALUE:
+      {
+        value *val = obj;
+
+        relocate (&val->type, K_LINK);
+        relocate (&val->etype, K_LINK);
+        relocate (&val->sym, K_SYMBOL);
+        relocate (&val->next, K_VALUE);
+        break;
+      }
+    }
+}
+
+/*-----------------------------------------------------------------*/
+/* checkSymbol - returns why a symbol cannot be precompiled        */
+/*-----------------------------------------------------------------*/
+static const char *
+checkSymbol (const symbol *sym)
+{
+  int i;
+
+  if (IS_FUNC (sym->type) && (FUNC_HASBODY (sym->type) || sym->funcTree))
+    return "header defines a function";
+  if (sym->ival)
+    return "header has an initializer";
+  for (i = 0; i < 8; i++)
+    if (sym->regs[i])
+      return "header generates code";
+  if (sym->aop || sym->fuse || sym->rematiCode || sym->reqv || sym->prereqv || sym->psbase || sym->usl.spillLoc ||
+    sym->defs || sym->uses || sym->regsUsed || sym->clashes)
+    return "header generates code";
+  return NULL;
+}
+
+/*-----------------------------------------------------------------*/
+/* setOf - one of the sets of symbols the header can add to        */
+/*-----------------------------------------------------------------*/
+static set **
+setOf (unsigned int i)
+{
+  if (i < NMAPS)
+    return *maps[i] ? &(*maps[i])->syms : NULL;
+  return i == NMAPS ? &operKeyReset : &publics;
+}
+
+/*-----------------------------------------------------------------*/
+/* hashKnown - digest of the known objects that does not depend on */
+/*             where they are                                      */
+/*-----------------------------------------------------------------*/
+static void
+hashKnown (char *digest)
+{
+  unsigned int i;
+  pchCopy copy;
+  cacheHash h;
+
+  rmode = R_CHECK;
+  cacheHashInit (&h);
+  for (i = 0; i < pch.known.count; i++)
+    {
+      int kind = pch.known.obj[i].kind;
+
+      if (kind == K_STRING)
+        {
+          cacheHashAdd (&h, pch.known.obj[i].ptr, strlen (pch.known.obj[i].ptr));
+          continue;
+        }
+      memcpy (&copy, pch.known.obj[i].ptr, kindSize[kind]);
+      relocateObject (kind, &copy);
+      cacheHashAdd (&h, &copy, kindSize[kind]);
+    }
+  cacheHashName (&h, digest);
+}
+
+/*-----------------------------------------------------------------*/
+/* walkKnown - collects the objects the front end has: those that  */
+/*             can be reached from the tables and the sets         */
+/*-----------------------------------------------------------------*/
+static void
+walkKnown (char *digest)
+{
+  unsigned int i, t;
+  bucket *bp;
+  set **sp, *s;
+  pchCopy copy;
+
+  rmode = R_KNOWN;
+  for (t = 0; t < NTABLES; t++)
+    for (i = 0; i < HASHTAB_SIZE; i++)
+      for (bp = tables[t][i]; bp; bp = bp->next)
+        relocatePtr (bp->sym, tables[t] == StructTab ? K_STRUCT : K_SYMBOL);
+  for (i = 0; i < NSETS; i++)
+    if ((sp = setOf (i)))
+      for (s = *sp; s; s = s->next)
+        relocatePtr (s->item, K_SYMBOL);
+  for (i = 0; i <= INTNO_MAX; i++)
+    relocatePtr (interrupts[i], K_SYMBOL);
+
+  /* the list grows while it is walked */
+  for (i = 0; i < pch.known.count; i++)
+    if (pch.known.obj[i].kind != K_STRING)
+      {
+        memcpy (&copy, pch.known.obj[i].ptr, kindSize[pch.known.obj[i].kind]);
+        relocateObject (pch.known.obj[i].kind, &copy);
+      }
+
+  hashKnown (digest);
+}
+
+/*-----------------------------------------------------------------*/
+/* isMarker - is this a line marker of the preprocessor? If so,    */
+/*            returns the flags after the file name as bits        */
+/*-----------------------------------------------------------------*/
+static bool
+isMarker (const char *p, const char *end, int *flags)
+{
+  if (end - p < 3 || p[0] != '#' || p[1] != ' ' || !isdigit ((unsigned char) p[2]))
+    return false;
+
+  *flags = 0;
+  for (p += 2; p < end && *p != '"'; p++)
+    ;
+  for (p++; p < end && *p != '"'; p++)
+    if (*p == '\\')
+      p++;
+  for (p++; p < end; p++)
+    if (isdigit ((unsigned char) *p))
+      *flags |= 1 << (*p - '0');
+  return true;
+}
+
+/*-----------------------------------------------------------------*/
+/* markerFile - returns the file name in a line marker             */
+/*-----------------------------------------------------------------*/
+static char *
+markerFile (const char *p, const char *end)
+{
+  struct dbuf_s name;
+
+  dbuf_init (&name, 128);
+  for (; p < end && *p != '"'; p++)
+    ;
+  for (p++; p < end && *p != '"'; p++)
+    {
+      if (*p == '\\' && p + 1 < end)
+        p++;
+      dbuf_append_char (&name, *p);
+    }
+  return dbuf_detach_c_str (&name);
+}
+
+/*-----------------------------------------------------------------*/
+/* isBlank - is there nothing but white space on the line?         */
+/*-----------------------------------------------------------------*/
+static bool
+isBlank (const char *p, const char *end)
+{
+  for (; p < end; p++)
+    if (!isspace ((unsigned char) *p))
+      return false;
+  return true;
+}
+
+/*-----------------------------------------------------------------*/
+/* findHeader - finds the header part of the preprocessed source:  */
+/*              from the marker entering the first header to the   */
+/*              one returning to the source. When creating, there  */
+/*              may not be anything else. Returns why there is no  */
+/*              header part that can be used, or NULL              */
+/*-----------------------------------------------------------------*/
+static const char *
+findHeader (const char *text, size_t len, size_t *start, size_t *end)
+{
+  const char *p, *eol, *stop = text + len;
+  int depth = 0, flags;
+  bool seen = false;
+
+  for (p = text; p < stop; p = eol + 1)
+    {
+      if (!(eol = memchr (p, '\n', stop - p)))
+        eol = stop;
+
+      if (isMarker (p, eol, &flags))
+        {
+          if (flags & 1 << 1)
+            {
+              if (!depth++)
+                {
+                  if (seen)
+                    return "source includes more than one header";
+                  seen = true;
+                  *start = p - text;
+                  pch.header = markerFile (p, eol);
+                }
+            }
+          else if ((flags & 1 << 2) && depth && !--depth)
+            {
+              *end = p - text;
+              if (!options.pch_create)
+                return NULL;
+            }
+        }
+      else if (depth)
+        {
+          if (!strncmp (p, "#pragma", 7))
+            return "header has a #pragma";
+        }
+      else if (!isBlank (p, eol))
+        {
+          if (!seen)
+            return "source does not start with an #include";
+          return "source does more than include a header";
+        }
+    }
+
+  return seen && !depth ? NULL : "source does not include a header";
+}
+
+/*-----------------------------------------------------------------*/
+/* buildKey - the options, and the layout of the objects. Options  */
+/*            that only select the output or the messages are left */
+/*            out                                                  */
+/*-----------------------------------------------------------------*/
+static void
+buildKey (int argc, char **argv)
+{
+  static const char *const skip[] = { "-c", "-S", "--syntax-only", "-V", "--verbose", NULL };
+  char **args = Safe_alloc ((argc + 1) * sizeof (char *));
+  const char *const *s;
+  int i, n = 0;
+
+  for (i = 0; i < argc; i++)
+    {
+      for (s = skip; *s && strcmp (argv[i], *s); s++)
+        ;
+      if (!*s)
+        args[n++] = argv[i];
+    }
+
+  dbuf_init (&pch.key, 1024);
+  dbuf_printf (&pch.key, "%u %u %u %u %u\n", (unsigned int) sizeof (void *), (unsigned int) sizeof (symbol),
+    (unsigned int) sizeof (sym_link), (unsigned int) sizeof (structdef), (unsigned int) sizeof (value));
+  cacheOptionsKey (&pch.key, n, args);
+  Safe_free (args);
+}
+
+/*-----------------------------------------------------------------*/
+/* snapshot - notes what is there before the header is parsed      */
+/*-----------------------------------------------------------------*/
+static void
+snapshot (void)
+{
+  unsigned int i, t;
+  bucket *bp;
+  set **sp, *s;
+
+  walkKnown (pch.knownDigest);
+
+  for (t = 0; t < NTABLES; t++)
+    for (i = 0; i < HASHTAB_SIZE; i++)
+      for (bp = tables[t][i]; bp; bp = bp->next)
+        {
+          ptrMapPut (&pch.buckets, bp, 1);
+          addSet (&pch.oldBuckets[t], bp);
+        }
+
+  for (i = 0; i < NSETS; i++)
+    if ((sp = setOf (i)))
+      for (s = *sp; s; s = s->next)
+        addSet (&pch.oldItems[i], s->item);
+
+  for (i = 0; i < NMAPS; i++)
+    if (*maps[i])
+      pch.bufLength[i] = dbuf_get_length (&(*maps[i])->oBuf);
+
+  memcpy (pch.interrupts, interrupts, sizeof (pch.interrupts));
+  pch.namedspacemaps = namedspacemaps;
+}
+
+/*-----------------------------------------------------------------*/
+/* putWord, putString - append to the precompiled header           */
+/*-----------------------------------------------------------------*/
+static void
+putWord (struct dbuf_s *buf, uintptr_t w)
+{
+  dbuf_append (buf, &w, sizeof (w));
+}
+
+static void
+putString (struct dbuf_s *buf, const char *s)
+{
+  putWord (buf, strlen (s));
+  dbuf_append (buf, s, strlen (s));
+}
+
+/*-----------------------------------------------------------------*/
+/* putPacked - appends an object; most of its bytes are zero, runs */
+/*             of them are only counted                            */
+/*-----------------------------------------------------------------*/
+static void
+putPacked (struct dbuf_s *buf, const void *obj, size_t len)
+{
+  const unsigned char *p = obj;
+  size_t i = 0;
+
+  while (i < len)
+    {
+      unsigned char run[2] = { 0, 0 };
+
+      for (; i < len && !p[i] && run[0] < 255; i++)
+        run[0]++;
+      while (i + run[1] < len && run[1] < 255 && (p[i + run[1]] || (i + run[1] + 1 < len && p[i + run[1] + 1])))
+        run[1]++;
+      dbuf_append (buf, run, 2);
+      dbuf_append (buf, p + i, run[1]);
+      i += run[1];
+    }
+}
+
+typedef struct reader
+{
+  const char *p;
+  const char *end;
+  bool bad;
+}
+reader;
+
+/*-----------------------------------------------------------------*/
+/* getBytes, getWord, getPacked, getObject, getString - read back  */
+/*-----------------------------------------------------------------*/
+static const void *
+getBytes (reader *r, size_t len)
+{
+  const char *p = r->p;
+
+  if (r->bad || (size_t) (r->end - r->p) < len)
+    {
+      r->bad = true;
+      return NULL;
+    }
+  r->p += len;
+  return p;
+}
+
+static uintptr_t
+getWord (reader *r)
+{
+  const void *p = getBytes (r, sizeof (uintptr_t));
+  uintptr_t w = 0;
+
+  if (p)
+    memcpy (&w, p, sizeof (w));
+  return w;
+}
+
+static bool
+getPacked (reader *r, void *obj, size_t len)
+{
+  unsigned char *p = obj;
+  size_t i = 0;
+
+  while (i < len)
+    {
+      const unsigned char *run = getBytes (r, 2);
+      const void *bytes;
+
+      if (!run || i + run[0] + run[1] > len || !(bytes = getBytes (r, run[1])))
+        {
+          r->bad = true;
+          return false;
+        }
+      memset (p + i, 0, run[0]);
+      memcpy (p + i + run[0], bytes, run[1]);
+      i += run[0] + run[1];
+    }
+  return true;
+}
+
+static void *
+getObject (reader *r, int kind)
+{
+  uintptr_t c = getWord (r);
+  pchObjects *list = (c & 1) ? &pch.known : robjects;
+
+  if (r->bad || !(c >> 1) || (c >> 1) > list->count || list->obj[(c >> 1) - 1].kind != kind)
+    return NULL;
+  return list->obj[(c >> 1) - 1].ptr;
+}
+
+static char *
+getString (reader *r)
+{
+  size_t len = getWord (r);
+  const char *p = getBytes (r, len);
+  char *s;
+
+  if (!p)
+    return NULL;
+  s = Safe_alloc (len + 1);
+  memcpy (s, p, len);
+  return s;
+}
+
+/*-----------------------------------------------------------------*/
+/* saveChanges - appends how parsing the header changed the tables */
+/*               and the sets, and returns their number            */
+/*-----------------------------------------------------------------*/
+static unsigned int
+saveChanges (struct dbuf_s *out)
+{
+  unsigned int i, t, n, count = 0, chainAlloc = 16;
+  bucket *bp, **chain = Safe_alloc (chainAlloc * sizeof (bucket *));
+  ptrMap present = { NULL, NULL, 0, 0 };
+  set **sp, *s;
+  void *item;
+
+  /* buckets of predefined symbols are only taken out, like those of
+     the parameters of the support routines after the first declaration */
+  for (t = 0; t < NTABLES; t++)
+    {
+      for (i = 0; i < HASHTAB_SIZE; i++)
+        for (bp = tables[t][i]; bp; bp = bp->next)
+          ptrMapPut (&present, bp, 1);
+      for (bp = setFirstItem (pch.oldBuckets[t]); bp; bp = setNextItem (pch.oldBuckets[t]))
+        if (!ptrMapGet (&present, bp))
+          {
+            putWord (out, PCH_DELETE_SYM);
+            putWord (out, t);
+            putString (out, bp->name);
+            putWord (out, (uintptr_t) relocatePtr (bp->sym, tables[t] == StructTab ? K_STRUCT : K_SYMBOL));
+            count++;
+          }
+    }
+  Safe_free (present.keys);
+  Safe_free (present.vals);
+
+  /* new buckets are put in front of the old ones, they are written in
+     the order they were added in */
+  for (t = 0; t < NTABLES; t++)
+    for (i = 0; i < HASHTAB_SIZE; i++)
+      {
+        for (n = 0, bp = tables[t][i]; bp && !ptrMapGet (&pch.buckets, bp); bp = bp->next)
+          {
+            if (n == chainAlloc)
+              chain = Safe_realloc (chain, (chainAlloc *= 2) * sizeof (bucket *));
+            chain[n++] = bp;
+          }
+        for (; bp; bp = bp->next)
+          if (!ptrMapGet (&pch.buckets, bp))
+            unsupported = "header changes a predefined symbol";
+        while (n--)
+          {
+            putWord (out, PCH_ADD_SYM);
+            putWord (out, t);
+            putString (out, chain[n]->name);
+            putWord (out, chain[n]->level);
+            putWord (out, chain[n]->block);
+            putWord (out, (uintptr_t) relocatePtr (chain[n]->sym, tables[t] == StructTab ? K_STRUCT : K_SYMBOL));
+            count++;
+          }
+      }
+  Safe_free (chain);
+
+  /* symbols are taken out of the sets anywhere, but only added to
+     their end */
+  for (i = 0; i < NSETS; i++)
+    {
+      if (!(sp = setOf (i)))
+        continue;
+      item = setFirstItem (pch.oldItems[i]);
+      for (s = *sp; s; s = s->next)
+        {
+          for (; item && item != s->item; item = setNextItem (pch.oldItems[i]))
+            {
+              putWord (out, PCH_DELETE_ITEM);
+              putWord (out, i);
+              putWord (out, (uintptr_t) relocatePtr (item, K_SYMBOL));
+              count++;
+            }
+          if (item)
+            item = setNextItem (pch.oldItems[i]);
+          else
+            {
+              putWord (out, PCH_ADD_ITEM);
+              putWord (out, i);
+              putWord (out, (uintptr_t) relocatePtr (s->item, K_SYMBOL));
+              count++;
+            }
+        }
+      for (; item; item = setNextItem (pch.oldItems[i]))
+        {
+          putWord (out, PCH_DELETE_ITEM);
+          putWord (out, i);
+          putWord (out, (uintptr_t) relocatePtr (item, K_SYMBOL));
+          count++;
+        }
+    }
+
+  return count;
+}
+
+/*-----------------------------------------------------------------*/
+/* saveState - appends what parsing the header added: the objects  */
+/*             and the changes to the tables and the sets          */
+/*-----------------------------------------------------------------*/
+static void
+saveState (struct dbuf_s *out)
+{
+  pchObjects objects = { NULL, 0, 0 };
+  struct dbuf_s changes, data;
+  unsigned int i, count;
+  const char *why;
+  pchCopy copy;
+
+  rmode = R_SAVE;
+  robjects = &objects;
+  dbuf_init (&changes, 4096);
+  dbuf_init (&data, 65536);
+
+  count = saveChanges (&changes);
+
+  for (i = 0; i < NMAPS; i++)
+    if (*maps[i] && dbuf_get_length (&(*maps[i])->oBuf) != pch.bufLength[i])
+      unsupported = "header generates code";
+  if (memcmp (pch.interrupts, interrupts, sizeof (pch.interrupts)) || pch.namedspacemaps != namedspacemaps)
+    unsupported = "header defines interrupts or address spaces";
+
+  /* the list grows while it is written */
+  for (i = 0; i < objects.count; i++)
+    {
+      int kind = objects.obj[i].kind;
+
+      putWord (&data, kind);
+      if (kind == K_STRING)
+        {
+          putString (&data, objects.obj[i].ptr);
+          continue;
+        }
+      if (kind == K_SYMBOL && (why = checkSymbol (objects.obj[i].ptr)))
+        unsupported = why;
+      memcpy (&copy, objects.obj[i].ptr, kindSize[kind]);
+      relocateObject (kind, &copy);
+      putPacked (&data, &copy, kindSize[kind]);
+    }
+
+  putWord (out, objects.count);
+  dbuf_append (out, dbuf_get_buf (&data), dbuf_get_length (&data));
+  putWord (out, count);
+  dbuf_append (out, dbuf_get_buf (&changes), dbuf_get_length (&changes));
+  putWord (out, genSymCount);
+  putWord (out, blockNo);
+  putWord (out, seqPointNo);
+
+  dbuf_destroy (&changes);
+  dbuf_destroy (&data);
+  Safe_free (objects.obj);
+}
+
+/*-----------------------------------------------------------------*/
+/* pchWrite - writes the precompiled header after the source has   */
+/*            been parsed                                          */
+/*-----------------------------------------------------------------*/
+void
+pchWrite (void)
+{
+  struct dbuf_s out;
+  char digest[33];
+  FILE *fp;
+
+  dbuf_init (&out, 65536);
+  dbuf_append_str (&out, PCH_MAGIC);
+  putString (&out, dbuf_c_str (&pch.key));
+  putString (&out, pch.digest);
+  putString (&out, pch.header);
+  putWord (&out, pch.known.count);
+  putString (&out, pch.knownDigest);
+
+  /* the predefined objects are still there as they were */
+  hashKnown (digest);
+  if (!unsupported && strcmp (digest, pch.knownDigest))
+    unsupported = "header changes a predefined symbol";
+
+  if (!unsupported)
+    saveState (&out);
+
+  if (unsupported)
+    {
+      werror (E_PCH_CREATE, options.pch_create, unsupported);
+      exit (EXIT_FAILURE);
+    }
+
+  if (!(fp = fopen (options.pch_create, "wb")))
+    {
+      werror (E_OUTPUT_FILE_OPEN_ERR, options.pch_create, strerror (errno));
+      exit (EXIT_FAILURE);
+    }
+  dbuf_write_and_destroy (&out, fp);
+  if (fclose (fp))
+    {
+      werror (E_OUTPUT_FILE_OPEN_ERR, options.pch_create, strerror (errno));
+      remove (options.pch_create);
+      exit (EXIT_FAILURE);
+    }
+
+  if (options.verbose)
+    printf ("sdcc: precompiled header %s for %s\n", options.pch_create, pch.header);
+}
+
+/*-----------------------------------------------------------------*/
+/* pchLoad - loads the precompiled header if it fits the source;   */
+/*           the state of the front end is only changed if it does */
+/*-----------------------------------------------------------------*/
+static bool
+pchLoad (void)
+{
+  struct dbuf_s file;
+  pchObjects objects = { NULL, 0, 0 };
+  reader r;
+  const char *why = NULL;
+  char digest[33], *s;
+  size_t count, i;
+  int kind, pass, counters[3];
+
+  dbuf_init (&file, 65536);
+  {
+    char chunk[4096];
+    size_t n;
+    FILE *fp;
+
+    if (!(fp = fopen (options.pch_use, "rb")))
+      {
+        werror (W_PCH_NOT_USED, options.pch_use, strerror (errno));
+        dbuf_destroy (&file);
+        return false;
+      }
+    while ((n = fread (chunk, 1, sizeof (chunk), fp)) > 0)
+      dbuf_append (&file, chunk, n);
+    fclose (fp);
+  }
+  r.p = dbuf_get_buf (&file);
+  r.end = r.p + dbuf_get_length (&file);
+  r.bad = false;
+
+  if (!(s = (char *) getBytes (&r, strlen (PCH_MAGIC))) || memcmp (s, PCH_MAGIC, strlen (PCH_MAGIC)))
+    why = "not a precompiled header";
+  else if (!(s = getString (&r)) || strcmp (s, dbuf_c_str (&pch.key)))
+    why = "options differ";
+  else if (!(s = getString (&r)) || strcmp (s, pch.digest))
+    why = "header or defines differ";
+  else
+    {
+      getString (&r);
+      count = getWord (&r);
+      s = getString (&r);
+      walkKnown (digest);
+      if (!s || count != pch.known.count || strcmp (s, digest))
+        why = "predefined symbols differ";
+    }
+
+  if (!why)
+    {
+      /* the objects, before their pointers are mapped */
+      count = getWord (&r);
+      for (i = 0; i < count && !r.bad; i++)
+        {
+          void *obj;
+
+          kind = getWord (&r);
+          if (kind == K_STRING)
+            obj = getString (&r);
+          else if (kind >= K_SYMBOL && kind < K_STRING)
+            getPacked (&r, obj = Safe_alloc (kindSize[kind]), kindSize[kind]);
+          else
+            r.bad = true;
+          if (!r.bad)
+            addObject (&objects, kind, obj);
+        }
+      if (r.bad)
+        why = "file is damaged";
+    }
+
+  /* the changes to the tables and the sets are checked before
+     anything is changed */
+  rmode = R_LOAD;
+  robjects = &objects;
+  for (pass = 0; pass < 2 && !why; pass++)
+    {
+      reader rr = r;
+
+      for (count = getWord (&rr); count && !rr.bad; count--)
+        {
+          int change = getWord (&rr);
+          unsigned int t = getWord (&rr);
+          char *name = change <= PCH_ADD_SYM ? getString (&rr) : NULL;
+          long level = change == PCH_ADD_SYM ? (long) getWord (&rr) : 0;
+          int block = change == PCH_ADD_SYM ? (int) getWord (&rr) : 0;
+          void *obj;
+
+          if (change <= PCH_ADD_SYM)
+            obj = getObject (&rr, t < NTABLES && tables[t] == StructTab ? K_STRUCT : K_SYMBOL);
+          else
+            obj = getObject (&rr, K_SYMBOL);
+
+          if (change < PCH_DELETE_SYM || change > PCH_ADD_ITEM || !obj ||
+            (change <= PCH_ADD_SYM ? !name || t >= NTABLES : t >= NSETS || !setOf (t)))
+            rr.bad = true;
+          else if (pass)
+            switch (change)
+              {
+              case PCH_DELETE_SYM:
+                deleteSym (tables[t], obj, name);
+                break;
+              case PCH_ADD_SYM:
+                addSym (tables[t], obj, name, level, block, 0);
+                break;
+              case PCH_DELETE_ITEM:
+                deleteSetItem (setOf (t), obj);
+                break;
+              case PCH_ADD_ITEM:
+                addSet (setOf (t), obj);
+                break;
+              }
+          Safe_free (name);
+        }
+
+      for (i = 0; i < 3; i++)
+        counters[i] = getWord (&rr);
+      if (!pass && rr.bad)
+        why = "file is damaged";
+    }
+
+  if (why)
+    {
+      werror (W_PCH_NOT_USED, options.pch_use, why);
+      Safe_free (objects.obj);
+      dbuf_destroy (&file);
+      return false;
+    }
+
+  for (i = 0; i < objects.count; i++)
+    relocateObject (objects.obj[i].kind, objects.obj[i].ptr);
+  genSymCount = counters[0];
+  blockNo = counters[1];
+  seqPointNo = counters[2];
+
+  if (options.verbose)
+    printf ("sdcc: using precompiled header %s for %s\n", options.pch_use, pch.header);
+
+  Safe_free (objects.obj);
+  dbuf_destroy (&file);
+  return true;
+}
+
+/*-----------------------------------------------------------------*/
+/* pchBegin - with --create-pch checks the preprocessed source and */
+/*            notes what the front end knows before parsing it.    */
+/*            With --use-pch loads the precompiled header if it    */
+/*            fits the source, and leaves the header part out of   */
+/*            what the parser gets                                 */
+/*-----------------------------------------------------------------*/
+void
+pchBegin (int argc, char **argv)
+{
+  struct dbuf_s text;
+  char chunk[4096];
+  size_t n, start = 0, end = 0;
+  const char *why;
+  cacheHash h;
+
+  if (!options.pch_create && !options.pch_use)
+    return;
+
+  if (options.c1mode || options.whole_program)
+    {
+      if (options.pch_create)
+        {
+          werror (E_PCH_CREATE, options.pch_create, "not with --c1mode or --whole-program");
+          exit (EXIT_FAILURE);
+        }
+      werror (W_PCH_NOT_USED, options.pch_use, "not with --c1mode or --whole-program");
+      return;
+    }
+
+  buildKey (argc, argv);
+
+  dbuf_init (&text, 65536);
+  while ((n = fread (chunk, 1, sizeof (chunk), yyin)) > 0)
+    dbuf_append (&text, chunk, n);
+  pch.cppStatus = cachePclose (yyin);
+
+  if (pch.cppStatus)
+    why = "preprocessor failed";
+  else
+    why = findHeader (dbuf_get_buf (&text), dbuf_get_length (&text), &start, &end);
+
+  if (why)
+    {
+      if (options.pch_create)
+        {
+          if (!pch.cppStatus)
+            {
+              werror (E_PCH_CREATE, options.pch_create, why);
+              exit (EXIT_FAILURE);
+            }
+          options.pch_create = NULL;
+        }
+      else
+        werror (W_PCH_NOT_USED, options.pch_use, why);
+      start = end = 0;
+    }
+  else
+    {
+      cacheHashInit (&h);
+      cacheHashAdd (&h, (const char *) dbuf_get_buf (&text) + start, end - start);
+      cacheHashName (&h, pch.digest);
+
+      if (options.pch_create)
+        {
+          snapshot ();
+          start = end = 0;
+        }
+      else if (!pchLoad ())
+        start = end = 0;
+    }
+
+  /* hand the rest of the preprocessed source on to the parser */
+  if (!(pch.input = tmpfile ()))
+    {
+      werror (E_OUTPUT_FILE_OPEN_ERR, "tmpfile", strerror (errno));
+      exit (EXIT_FAILURE);
+    }
+  fwrite (dbuf_get_buf (&text), 1, start, pch.input);
+  fwrite ((const char *) dbuf_get_buf (&text) + end, 1, dbuf_get_length (&text) - end, pch.input);
+  rewind (pch.input);
+  yyin = pch.input;
+
+  dbuf_destroy (&text);
+}
+
+/*-----------------------------------------------------------------*/
+/* pchPclose - closes the preprocessed source                      */
+/*-----------------------------------------------------------------*/
+int
+pchPclose (FILE *fp)
+{
+  if (!pch.input || fp != pch.input)
+    return cachePclose (fp);
+
+  fclose (fp);
+  pch.input = NULL;
+  return pch.cppStatus;
+}
@@ -0,0 +1,28 @@
+/*-------------------------------------------------------------------------
+  SDCCpch.h - precompiled headers
+
+   This program is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the
+   Free Software Foundation; either version 2, or (at your option) any
+   later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+-------------------------------------------------------------------------*/
+
+#ifndef SDCCPCH_H
+#define SDCCPCH_H
+
+#include <stdio.h>
+
+void pchBegin (int argc, char **argv);
+int pchPclose (FILE *fp);
+void pchWrite (void);
+
+#endif
@@ -34,6 +34,7 @@ static peepRule *currRule = NULL;
 #define HTAB_SIZE 53
 
 hTab *labelHash = NULL;
+unsigned long peepHoleGeneration = 0;
 
 static struct
 {
@@ -3473,6 +3474,8 @@ replaceRule (lineNode **shead, lineNode *stail, const peepRule *pr)
   char *lbp;
   lineNode *comment = NULL;
 
+  peepHoleGeneration++;
+
   /* collect all the comment lines in the source */
   for (cl = *shead; cl != stail; cl = cl->next)
     {
@@ -3823,6 +3826,8 @@ peepHole (lineNode ** pls)
   lineNode *mtail = NULL;
   bool restart, replaced;
   unsigned long rule_application_counter = 0ul;
+  unsigned long attempts = 0ul;
+  int phase;
 
 #if !OPT_DISABLE_PIC14 || !OPT_DISABLE_PIC16
   /* The PIC port uses a different peep hole optimizer based on "pCode" */
@@ -3832,6 +3837,9 @@ peepHole (lineNode ** pls)
 
   assert(labelHash == NULL);
 
+  phase = reportPhase (PHASE_PEEPHOLE);
+  peepHoleGeneration++;
+
   do
     {
       restart = FALSE;
@@ -3867,6 +3875,7 @@ peepHole (lineNode ** pls)
               /* Tidy up any data stored in the hTab */
 
               /* if it matches */
+              attempts++;
               if (matchRule (spl, &mtail, pr, *pls))
                 {
                   rule_application_counter++;
@@ -3910,6 +3919,9 @@ end:
       freeTrace (&_G.labels);
     }
   labelHash = NULL;
+
+  reportCount (COUNT_PEEPHOLE, attempts);
+  reportPhase (phase);
 }
 
 
@@ -52,6 +52,10 @@ bool isLabelDefinition (const char *line, const char **start, int *len,
                         bool isPeepRule);
 
 extern hTab *labelHash;
+
+/* Changes whenever peepHole() starts or modifies the line list, so
+   ports can tell when what they cached about the list went stale. */
+extern unsigned long peepHoleGeneration;
 labelHashEntry *getLabelRef (const char *label, lineNode *head);
 
 void initPeepHole (void);
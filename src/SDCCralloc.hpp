@@ -41,6 +41,12 @@
 // create_cfg(), thorup_tree_decomposition(), nicify(), alive_tree_dec(), tree_dec_ralloc_nodes().
 //
 // The Z80 port can serve as an example, see z80_ralloc2_cc() in z80/ralloc2.cc.
+//
+// Ports with more than MAX_NUM_REGS registers define MAX_NUM_REGS before including this file.
+// Ports that restrict variables to some of the registers (e.g. to register pairs or pointer registers)
+// define RALLOC_REGISTER_CLASSES and supply
+// template <class I_t>
+// regset_t register_class(var_t v, const I_t &I);
 
 #ifndef SDCCRALLOC_HH
 #define SDCCRALLOC_HH 1
@@ -48,6 +54,7 @@
 #include <iostream>
 #include <limits>
 #include <utility>
+#include <bitset>
 #include <sstream>
 #include <fstream>
 
@@ -70,7 +77,15 @@ typedef short int var_t;
 typedef signed char reg_t;
 
 // Integer constant upper bound on port->num_regs
+#ifndef MAX_NUM_REGS
 #define MAX_NUM_REGS 9
+#endif
+
+typedef std::bitset<MAX_NUM_REGS> regset_t;
+
+// The types below depend on MAX_NUM_REGS, which differs between ports. Each port includes this file into a single translation unit, keep them local to it.
+namespace
+{
 
 // Assignment at an instruction
 struct i_assignment_t
@@ -110,18 +125,15 @@ struct i_assignment_t
       registers[r][0] = v;
   }
 
-  void remove_var(var_t v)
+  void remove_var(var_t v, reg_t r)
   {
-    for (reg_t r = 0; r < port->num_regs; r++)
+    if (registers[r][1] == v)
       {
-        if (registers[r][1] == v)
-          {
-            registers[r][1] = registers[r][0];
-            registers[r][0] = -1;
-          }
-        else if (registers[r][0] == v)
-          registers[r][0] = -1;
+        registers[r][1] = registers[r][0];
+        registers[r][0] = -1;
       }
+    else if (registers[r][0] == v)
+      registers[r][0] = -1;
   }
 };
 
@@ -227,6 +239,9 @@ struct con_node
 };
 
 typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::bidirectionalS, tree_dec_node> tree_dec_t;
+
+}
+
 typedef boost::adjacency_list<boost::setS, boost::vecS, boost::undirectedS, con_node> con_t;
 typedef boost::adjacency_matrix<boost::undirectedS, con_node> con2_t;
 typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::bidirectionalS, cfg_node> cfg_t;
@@ -262,6 +277,21 @@ static void get_best_local_assignment_biased(assignment &a, typename boost::grap
 // Code for another ic is generated when generating this one. Mark the other as generated. Port-specific.
 static void extra_ic_generated(iCode *ic);
 
+#ifdef RALLOC_REGISTER_CLASSES
+// Registers that variable v can be placed in. Port-specific.
+template <class I_t>
+static regset_t register_class(var_t v, const I_t &I);
+#else
+template <class I_t>
+static regset_t register_class(var_t v, const I_t &I)
+{
+  regset_t regs;
+  for (reg_t r = 0; r < port->num_regs; r++)
+    regs.set(r);
+  return(regs);
+}
+#endif
+
 inline void
 add_operand_to_cfg_node(cfg_node &n, operand *o, std::map<std::pair<int, reg_t>, var_t> &sym_to_index)
 {
@@ -628,20 +658,18 @@ static void print_assignment(const assignment &a)
 }
 #endif
 
+// Registers occupied by variables that conflict with v.
 template <class I_t>
-bool assignment_conflict(const assignment &a, const I_t &I, var_t v, reg_t r)
+regset_t assignment_conflicts(const assignment &a, const I_t &I, var_t v)
 {
+  regset_t regs;
   varset_t::const_iterator i, i_end;
 
   for (i = a.local.begin(), i_end = a.local.end(); i != i_end; ++i)
-    {
-      if (a.global[*i] != r)
-        continue;
-      if (boost::edge(*i, v, I).second)
-        return(true);
-    }
-    
-  return(false);
+    if (boost::edge(*i, v, I).second)
+      regs.set(a.global[*i]);
+
+  return(regs);
 }
 
 template<class G_t>
@@ -707,7 +735,7 @@ void assignments_introduce_instruction(assignment_list_t &alist, unsigned short
 }
 
 template <class G_t, class I_t>
-static void assignments_introduce_variable(assignment_list_t &alist, unsigned short int i, short int v, const G_t &G, const I_t &I)
+static void assignments_introduce_variable(assignment_list_t &alist, unsigned short int i, short int v, const regset_t &regs, const G_t &G, const I_t &I)
 {
   assignment_list_t::iterator ai;
   bool a_initialized;
@@ -718,9 +746,11 @@ static void assignments_introduce_variable(assignment_list_t &alist, unsigned sh
     {
       a_initialized = false;
 
+      const regset_t free = regs & ~assignment_conflicts(*ai, I, v);
+
       for (reg_t r = 0; r < port->num_regs; r++)
         {
-          if (!assignment_conflict(*ai, I, v, r))
+          if (free.test(r))
             {
               if(!a_initialized)
                 {
@@ -735,12 +765,15 @@ static void assignments_introduce_variable(assignment_list_t &alist, unsigned sh
               a.i_assignment.add_var(v, r);
               if(!assignment_hopeless(a, i, G, I, v))
                 alist.push_back(a);
-              a.i_assignment.remove_var(v);
+              a.i_assignment.remove_var(v, r);
             }
         }
     }
 }
 
+namespace
+{
+
 struct assignment_rep
 {
   assignment_list_t::iterator i;
@@ -752,6 +785,8 @@ struct assignment_rep
   }
 };
 
+}
+
 template <class I_t>
 float compatibility_cost(const assignment& a, const assignment& ac, const I_t &I)
 {
@@ -784,21 +819,24 @@ float compatibility_cost(const assignment& a, const assignment& ac, const I_t &I
 }
 
 // Ensure that we never get more than options.max_allocs_per_node assignments at a single node of the tree decomposition.
+// Each assignment can be extended in up to num_regs ways by the next variable, which can only be placed in num_regs registers.
 // Tries to drop the worst ones first (but never drop the empty assignment, as it's the only one guaranteed to be always valid).
 template <class G_t, class I_t>
-static void drop_worst_assignments(assignment_list_t &alist, unsigned short int i, const G_t &G, const I_t &I, const assignment& ac, bool *const assignment_optimal)
+static void drop_worst_assignments(assignment_list_t &alist, unsigned short int i, size_t num_regs, const G_t &G, const I_t &I, const assignment& ac, bool *const assignment_optimal)
 {
   unsigned int n;
   size_t alist_size;
   assignment_list_t::iterator ai, an;
 
-  if ((alist_size = alist.size()) * port->num_regs <= static_cast<size_t>(options.max_allocs_per_node) || alist_size <= 1)
+  num_regs = std::max(num_regs, size_t(1));
+
+  if ((alist_size = alist.size()) * num_regs <= static_cast<size_t>(options.max_allocs_per_node) || alist_size <= 1)
     return;
 
   *assignment_optimal = false;
 
 #ifdef DEBUG_RALLOC_DEC
-  std::cout << "Too many assignments here (" << i << "):" << alist_size << " > " << options.max_allocs_per_node / port->num_regs << ". Dropping some.\n"; std::cout.flush();
+  std::cout << "Too many assignments here (" << i << "):" << alist_size << " > " << options.max_allocs_per_node / num_regs << ". Dropping some.\n"; std::cout.flush();
 #endif
 
 #if 0
@@ -810,15 +848,15 @@ static void drop_worst_assignments(assignment_list_t &alist, unsigned short int
       arep[n].s = ai->s + rough_cost_estimate(*ai, i, G, I) + compatibility_cost(*ai, ac, I);
     }
 
-  std::nth_element(arep + 1, arep + options.max_allocs_per_node / port->num_regs, arep + alist_size);
+  std::nth_element(arep + 1, arep + options.max_allocs_per_node / num_regs, arep + alist_size);
 
-  //std::cout << "nth elem. est. cost: " << arep[options.max_allocs_per_node / port->num_regs].s << "\n"; std::cout.flush();
+  //std::cout << "nth elem. est. cost: " << arep[options.max_allocs_per_node / num_regs].s << "\n"; std::cout.flush();
 
-  for (n = options.max_allocs_per_node / port->num_regs + 1; n < alist_size; n++)
+  for (n = options.max_allocs_per_node / num_regs + 1; n < alist_size; n++)
     alist.erase(arep[n].i);
 #else // More efficient, reduces total SDCC runtime by about 1%.
 
-  size_t endsize = options.max_allocs_per_node / port->num_regs + 1;
+  size_t endsize = options.max_allocs_per_node / num_regs + 1;
   size_t arep_maxsize = std::min(alist_size, endsize * 2) + 1;
   size_t m, k;
   float bound = std::numeric_limits<float>::infinity();
@@ -885,6 +923,8 @@ static void tree_dec_ralloc_leaf(T_t &T, typename boost::graph_traits<T_t>::vert
   assignment a;
   assignment_list_t &alist = T[t].assignments;
 
+  wassert (port->num_regs <= MAX_NUM_REGS);
+
   a.s = 0;
   a.marked = false;
   a.global.resize(boost::num_vertices(I), -1);
@@ -934,10 +974,13 @@ static void tree_dec_ralloc_introduce(T_t &T, typename boost::graph_traits<T_t>:
   std::set<var_t>::const_iterator v;
   for (v = new_vars.begin(); v != new_vars.end(); ++v)
     {
-      drop_worst_assignments(alist, i, G, I, ac, assignment_optimal);
-      assignments_introduce_variable(alist, i, *v, G, I);
+      const regset_t regs = register_class(*v, I);
+      drop_worst_assignments(alist, i, regs.count(), G, I, ac, assignment_optimal);
+      assignments_introduce_variable(alist, i, *v, regs, G, I);
     }
 
+  reportCount(COUNT_ASSIGNMENTS, alist.size());
+
   // Summation of costs and early removal of assignments.
   for (ai = alist.begin(); ai != alist.end();)
     {
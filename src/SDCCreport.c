@@ -0,0 +1,453 @@
+/*-------------------------------------------------------------------------
+  SDCCreport.c - reports on the resources used by the compiler
+
+   This program is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the
+   Free Software Foundation; either version 2, or (at your option) any
+   later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+-------------------------------------------------------------------------*/
+
+/* With --mem-report the bytes requested from the heap are charged to
+   the phase the compiler is in, with --time-report and --time-trace
+   the time spent in it. Code generation for a function runs from
+   inside the parser, so the phases nest: reportPhase switches to a
+   phase and returns the previous one, to be switched back to.
+
+   From the optimizer on, the time and the counts are also kept per
+   function. --time-report prints a table of the phases, the totals
+   of the counts and the functions that took longest; --time-trace
+   writes the same in the Chrome trace event format, which can be
+   loaded into chrome://tracing or Perfetto, or read by scripts. The
+   trace holds an event for each function, with its counts and the
+   time of each phase as arguments, and one for each stretch of time
+   of at least TRACE_MIN_USECS spent in a phase.
+
+   The preprocessor is a process of its own, running alongside the
+   parser; its time is the processor time used by it. */
+
+#include <stdio.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#include <sys/resource.h>
+#endif
+
+#include "common.h"
+#include "dbuf_string.h"
+#include "SDCCreport.h"
+
+/* shorter stretches of a phase are left out of the trace */
+#define TRACE_MIN_USECS 50
+
+/* number of functions in the table of --time-report */
+#define SLOWEST 10
+
+static const char *phaseNames[PHASES] =
+{
+  "preprocess",
+  "parse",
+  "decorate",
+  "icode",
+  "optimize",
+  "cse",
+  "gcse",
+  "loop",
+  "genconstprop",
+  "lospre",
+  "naddr",
+  "ralloc",
+  "codegen",
+  "peephole",
+  "glue",
+  "assemble",
+  "link",
+};
+
+static const char *countNames[COUNTS] =
+{
+  "icodes",
+  "tdwidth",
+  "assignments",
+  "dryruns",
+  "peephole",
+};
+
+typedef struct funcTime
+{
+  char name[SDCC_NAME_MAX + 1];
+  unsigned long long usecs;
+  unsigned long counts[COUNTS];
+}
+funcTime;
+
+static struct
+{
+  int phase;
+  bool on;
+  unsigned long long mark;
+  unsigned long long bytes[PHASES];
+  unsigned long long start;
+  unsigned long long tmark;
+  unsigned long long usecs[PHASES];
+  unsigned long counts[COUNTS];
+  /* the function being compiled */
+  bool inFunc;
+  unsigned long long fstart;
+  unsigned long long fusecs[PHASES];
+  funcTime func;
+  funcTime slowest[SLOWEST];
+  int nslowest;
+  unsigned long functions;
+  size_t maxRegion;
+  char maxName[SDCC_NAME_MAX + 1];
+  struct dbuf_s trace;
+  bool traceEvents;
+}
+_G;
+
+/*-----------------------------------------------------------------*/
+/* usecs - microseconds since some fixed point in time             */
+/*-----------------------------------------------------------------*/
+static unsigned long long
+usecs (void)
+{
+#ifdef _WIN32
+  LARGE_INTEGER count, freq;
+
+  QueryPerformanceCounter (&count);
+  QueryPerformanceFrequency (&freq);
+  return count.QuadPart / freq.QuadPart * 1000000 + count.QuadPart % freq.QuadPart * 1000000 / freq.QuadPart;
+#else
+  struct timespec ts;
+
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return (unsigned long long) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+/*-----------------------------------------------------------------*/
+/* traceEvent - appends a complete event to the trace              */
+/*-----------------------------------------------------------------*/
+static void
+traceEvent (const char *name, const char *cat, unsigned long long start, unsigned long long dur)
+{
+  if (!_G.traceEvents)
+    dbuf_init (&_G.trace, 4096);
+  else
+    dbuf_append_str (&_G.trace, "},\n");
+  _G.traceEvents = true;
+  dbuf_printf (&_G.trace, "{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, \"ts\": %llu, \"dur\": %llu",
+               name, cat, start - _G.start, dur);
+}
+
+/*-----------------------------------------------------------------*/
+/* reportPhase - switches to a phase, returns the previous one     */
+/*-----------------------------------------------------------------*/
+int
+reportPhase (int phase)
+{
+  int prev = _G.phase;
+
+  if (!_G.on)
+    {
+      _G.on = options.mem_report || options.time_report || options.time_trace;
+      if (!_G.on)
+        {
+          _G.phase = phase;
+          return prev;
+        }
+      _G.start = _G.tmark = usecs ();
+      _G.mark = Safe_allocated ();
+    }
+
+  {
+    unsigned long long now = Safe_allocated ();
+
+    _G.bytes[prev] += now - _G.mark;
+    _G.mark = now;
+  }
+
+  if (options.time_report || options.time_trace)
+    {
+      unsigned long long now = usecs ();
+      unsigned long long dur = now - _G.tmark;
+
+      _G.usecs[prev] += dur;
+      if (_G.inFunc)
+        _G.fusecs[prev] += dur;
+      if (options.time_trace && dur >= TRACE_MIN_USECS)
+        traceEvent (phaseNames[prev], "phase", _G.tmark, dur);
+      _G.tmark = now;
+    }
+
+  _G.phase = phase;
+
+  return prev;
+}
+
+/*-----------------------------------------------------------------*/
+/* reportCurrentPhase - returns the phase the compiler is in       */
+/*-----------------------------------------------------------------*/
+int
+reportCurrentPhase (void)
+{
+  return _G.phase;
+}
+
+/*-----------------------------------------------------------------*/
+/* reportCount - adds to a count of the current function           */
+/*-----------------------------------------------------------------*/
+void
+reportCount (int counter, unsigned long n)
+{
+  _G.func.counts[counter] += n;
+  _G.counts[counter] += n;
+}
+
+/*-----------------------------------------------------------------*/
+/* reportMax - raises a count of the current function to n          */
+/*-----------------------------------------------------------------*/
+void
+reportMax (int counter, unsigned long n)
+{
+  if (n > _G.func.counts[counter])
+    _G.func.counts[counter] = n;
+  if (n > _G.counts[counter])
+    _G.counts[counter] = n;
+}
+
+/*-----------------------------------------------------------------*/
+/* reportFunctionBegin - starts the counts of a function           */
+/*-----------------------------------------------------------------*/
+void
+reportFunctionBegin (const char *name)
+{
+  memset (&_G.func, 0, sizeof (_G.func));
+  strncpyz (_G.func.name, name ? name : "(initializer)", sizeof (_G.func.name));
+  memset (_G.fusecs, 0, sizeof (_G.fusecs));
+  _G.inFunc = true;
+  if (_G.on)
+    {
+      reportPhase (_G.phase);
+      _G.fstart = _G.tmark;
+    }
+}
+
+/*-----------------------------------------------------------------*/
+/* reportFunctionEnd - ends a function, notes its region size      */
+/*-----------------------------------------------------------------*/
+void
+reportFunctionEnd (size_t region)
+{
+  int i, j;
+
+  _G.functions++;
+  if (region > _G.maxRegion)
+    {
+      _G.maxRegion = region;
+      strncpyz (_G.maxName, _G.func.name, sizeof (_G.maxName));
+    }
+
+  if (!options.time_report && !options.time_trace)
+    {
+      _G.inFunc = false;
+      return;
+    }
+
+  reportPhase (_G.phase);
+  _G.inFunc = false;
+  _G.func.usecs = _G.tmark - _G.fstart;
+
+  if (options.time_trace)
+    {
+      traceEvent (_G.func.name, "function", _G.fstart, _G.func.usecs);
+      dbuf_append_str (&_G.trace, ", \"args\": {");
+      for (i = 0; i < COUNTS; i++)
+        dbuf_printf (&_G.trace, "\"%s\": %lu, ", countNames[i], _G.func.counts[i]);
+      for (i = 0, j = 0; i < PHASES; i++)
+        if (_G.fusecs[i])
+          dbuf_printf (&_G.trace, "%s\"%s_us\": %llu", j++ ? ", " : "", phaseNames[i], _G.fusecs[i]);
+      dbuf_append_char (&_G.trace, '}');
+    }
+
+  /* keep the slowest functions, slowest first */
+  for (i = _G.nslowest; i > 0 && _G.slowest[i - 1].usecs < _G.func.usecs; i--)
+    if (i < SLOWEST)
+      _G.slowest[i] = _G.slowest[i - 1];
+  if (i < SLOWEST)
+    {
+      _G.slowest[i] = _G.func;
+      if (_G.nslowest < SLOWEST)
+        _G.nslowest++;
+    }
+}
+
+/*-----------------------------------------------------------------*/
+/* reportPreprocessor - notes the time used by the preprocessor    */
+/*-----------------------------------------------------------------*/
+void
+reportPreprocessor (void)
+{
+#ifndef _WIN32
+  struct rusage ru;
+
+  /* the preprocessor is the only child process that has ended so far */
+  if (_G.on && !getrusage (RUSAGE_CHILDREN, &ru))
+    _G.usecs[PHASE_PREPROCESS] = (unsigned long long) (ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000 +
+                                 ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+#endif
+}
+
+/*-----------------------------------------------------------------*/
+/* peakRss - peak resident set size in kbytes, 0 if unknown        */
+/*-----------------------------------------------------------------*/
+static unsigned long
+peakRss (void)
+{
+#ifndef _WIN32
+  struct rusage ru;
+
+  if (!getrusage (RUSAGE_SELF, &ru))
+#ifdef __APPLE__
+    return ru.ru_maxrss / 1024;
+#else
+    return ru.ru_maxrss;
+#endif
+#endif
+  return 0;
+}
+
+/*-----------------------------------------------------------------*/
+/* printMemReport - prints the memory report                       */
+/*-----------------------------------------------------------------*/
+static void
+printMemReport (void)
+{
+  unsigned long long total = 0;
+  unsigned long rss;
+  int i;
+
+  fprintf (stderr, "memory report:\n");
+  for (i = 0; i < PHASES; i++)
+    if (_G.bytes[i])
+      {
+        fprintf (stderr, "  %-12s %10llu kbytes allocated\n", phaseNames[i], (_G.bytes[i] + 1023) / 1024);
+        total += _G.bytes[i];
+      }
+  fprintf (stderr, "  %-12s %10llu kbytes allocated\n", "total", (total + 1023) / 1024);
+  fprintf (stderr, "  functions: %lu, largest region %lu kbytes", _G.functions, (unsigned long) (_G.maxRegion + 1023) / 1024);
+  if (*_G.maxName)
+    fprintf (stderr, " (%s)", _G.maxName);
+  fprintf (stderr, "\n");
+  rss = peakRss ();
+  if (rss)
+    fprintf (stderr, "  peak rss: %lu kbytes\n", rss);
+}
+
+/*-----------------------------------------------------------------*/
+/* printTimeReport - prints the table of --time-report             */
+/*-----------------------------------------------------------------*/
+static void
+printTimeReport (void)
+{
+  unsigned long long total = 0;
+  int i, j;
+
+  for (i = 0; i < PHASES; i++)
+    if (i != PHASE_PREPROCESS)
+      total += _G.usecs[i];
+
+  fprintf (stderr, "time report:\n");
+  for (i = 0; i < PHASES; i++)
+    if (_G.usecs[i])
+      {
+        fprintf (stderr, "  %-12s %10.3f s", phaseNames[i], _G.usecs[i] / 1e6);
+        if (i == PHASE_PREPROCESS)
+          fprintf (stderr, "  (processor time of sdcpp, alongside parse)\n");
+        else
+          fprintf (stderr, " %5.1f%%\n", total ? _G.usecs[i] * 100.0 / total : 0.0);
+      }
+  fprintf (stderr, "  %-12s %10.3f s\n", "total", total / 1e6);
+
+  fprintf (stderr, "  functions: %lu", _G.functions);
+  for (i = 0; i < COUNTS; i++)
+    fprintf (stderr, ", %s %lu", countNames[i], _G.counts[i]);
+  fprintf (stderr, "\n");
+
+  if (_G.nslowest)
+    {
+      fprintf (stderr, "  %-24s %10s", "slowest functions", "s");
+      for (j = 0; j < COUNTS; j++)
+        fprintf (stderr, " %11s", countNames[j]);
+      fprintf (stderr, "\n");
+    }
+  for (i = 0; i < _G.nslowest; i++)
+    {
+      fprintf (stderr, "  %-24s %10.3f", _G.slowest[i].name, _G.slowest[i].usecs / 1e6);
+      for (j = 0; j < COUNTS; j++)
+        fprintf (stderr, " %11lu", _G.slowest[i].counts[j]);
+      fprintf (stderr, "\n");
+    }
+}
+
+/*-----------------------------------------------------------------*/
+/* writeTrace - writes the file of --time-trace                    */
+/*-----------------------------------------------------------------*/
+static void
+writeTrace (void)
+{
+  FILE *fp;
+  int i;
+
+  if (!(fp = fopen (options.time_trace, "w")))
+    {
+      werror (E_FILE_OPEN_ERR, options.time_trace);
+      return;
+    }
+
+  /* the whole compilation, with the totals */
+  traceEvent (moduleName ? moduleName : "sdcc", "total", _G.start, _G.tmark - _G.start);
+  dbuf_printf (&_G.trace, ", \"args\": {\"functions\": %lu", _G.functions);
+  for (i = 0; i < COUNTS; i++)
+    dbuf_printf (&_G.trace, ", \"%s\": %lu", countNames[i], _G.counts[i]);
+  for (i = 0; i < PHASES; i++)
+    if (_G.usecs[i])
+      dbuf_printf (&_G.trace, ", \"%s_us\": %llu", phaseNames[i], _G.usecs[i]);
+  dbuf_append_str (&_G.trace, "}}\n");
+
+  fprintf (fp, "{\"traceEvents\": [\n");
+  fwrite (dbuf_get_buf (&_G.trace), 1, dbuf_get_length (&_G.trace), fp);
+  fprintf (fp, "],\n\"displayTimeUnit\": \"ms\"}\n");
+  fclose (fp);
+  dbuf_destroy (&_G.trace);
+}
+
+/*-----------------------------------------------------------------*/
+/* reportPrint - prints the reports asked for                      */
+/*-----------------------------------------------------------------*/
+void
+reportPrint (void)
+{
+  if (!_G.on)
+    return;
+
+  reportPhase (_G.phase);
+
+  if (options.mem_report)
+    printMemReport ();
+  if (options.time_report)
+    printTimeReport ();
+  if (options.time_trace)
+    writeTrace ();
+}
@@ -0,0 +1,75 @@
+/*-------------------------------------------------------------------------
+  SDCCreport.h - reports on the resources used by the compiler
+
+   This program is free software; you can redistribute it and/or modify it
+   under the terms of the GNU General Public License as published by the
+   Free Software Foundation; either version 2, or (at your option) any
+   later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+-------------------------------------------------------------------------*/
+
+#ifndef SDCCREPORT_H
+#define SDCCREPORT_H
+
+#include <stddef.h>
+
+/* phases of the compiler */
+enum
+{
+  PHASE_PREPROCESS,             /* starting the preprocessor */
+  PHASE_PARSE,                  /* parsing and declarations */
+  PHASE_DECORATE,               /* type checking and folding of the ast */
+  PHASE_ICODE,                  /* intermediate code from the ast */
+  PHASE_OPTIMIZE,               /* basic blocks and other optimizations */
+  PHASE_CSE,                    /* local common subexpression elimination */
+  PHASE_GCSE,                   /* global common subexpression elimination */
+  PHASE_LOOP,                   /* loop optimizations and unrolling */
+  PHASE_GENCONSTPROP,           /* generalized constant propagation */
+  PHASE_LOSPRE,                 /* lifetime-optimal partial redundancy elimination */
+  PHASE_NADDR,                  /* placement of named address space switches */
+  PHASE_RALLOC,                 /* register allocation */
+  PHASE_CODEGEN,                /* code generation */
+  PHASE_PEEPHOLE,               /* peephole optimizer */
+  PHASE_GLUE,                   /* writing the assembler source */
+  PHASE_ASSEMBLE,               /* running the assembler */
+  PHASE_LINK,                   /* running the linker */
+  PHASES
+};
+
+/* things counted per function */
+enum
+{
+  COUNT_ICODES,                 /* iCodes going into the optimizer */
+  COUNT_TDWIDTH,                /* largest width of a tree decomposition */
+  COUNT_ASSIGNMENTS,            /* register assignments considered */
+  COUNT_DRYRUNS,                /* code generator dry runs */
+  COUNT_PEEPHOLE,               /* attempts to match a peephole rule */
+  COUNTS
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int reportPhase (int phase);
+int reportCurrentPhase (void);
+void reportCount (int counter, unsigned long n);
+void reportMax (int counter, unsigned long n);
+void reportFunctionBegin (const char *name);
+void reportFunctionEnd (size_t region);
+void reportPreprocessor (void);
+void reportPrint (void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
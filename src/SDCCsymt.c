@@ -345,6 +345,7 @@ newSymbol (const char *name, long scope)
   sym->funcDivFlagSafe = false;
   sym->funcUsesVolatile = true;
   sym->funcRestartAtomicSupport = true; //options.std_c11;
+  sym->funcClobberedRegs = ~0u;
 
   return sym;
 }
@@ -958,19 +959,37 @@ mergeDeclSpec (sym_link * dest, sym_link * src, const char *name)
   return decl;
 }
 
+int genSymCount = 0;            /* number of anonymous names generated */
+
 /*-------------------------------------------------------------------*/
 /* genSymName - generates and returns a name used for anonymous vars */
 /*-------------------------------------------------------------------*/
 char *
 genSymName (long level)
 {
-  static int gCount = 0;
   static char gname[SDCC_NAME_MAX + 1];
 
-  SNPRINTF (gname, sizeof (gname), "__%04d%04d", level, gCount++);
+  SNPRINTF (gname, sizeof (gname), "__%04d%04d", level, genSymCount++);
   return gname;
 }
 
+/*-------------------------------------------------------------------*/
+/* linkName - returns the name a file scope symbol is known by in    */
+/*            the module: with --whole-program, identifiers with     */
+/*            internal linkage get the number of their source file   */
+/*-------------------------------------------------------------------*/
+const char *
+linkName (const symbol *sym)
+{
+  static char lname[SDCC_NAME_MAX + 1];
+
+  if (!options.whole_program || !IS_STATIC (sym->etype))
+    return sym->name;
+
+  SNPRINTF (lname, sizeof (lname), "_%d_%s", translationUnit, sym->name);
+  return lname;
+}
+
 /*------------------------------------------------------------------*/
 /* getSpec - returns the specifier part from a declaration chain    */
 /*------------------------------------------------------------------*/
@@ -1625,6 +1644,18 @@ addSymChain (symbol ** symHead)
           if (csym->ival && !sym->ival)
             sym->ival = csym->ival;
 
+          /* a declaration after the definition of a function, as
+             when the files of a whole program share a header, keeps
+             what code generation found out about the function */
+          if (IS_FUNC (csym->type) && IFFUNC_HASBODY (csym->type) && IS_FUNC (sym->type))
+            {
+              FUNC_HASBODY (sym->type) = 1;
+              sym->funcDivFlagSafe = csym->funcDivFlagSafe;
+              sym->funcUsesVolatile = csym->funcUsesVolatile;
+              sym->funcRestartAtomicSupport = csym->funcRestartAtomicSupport;
+              sym->funcClobberedRegs = csym->funcClobberedRegs;
+            }
+
           if (!csym->cdef && !sym->cdef && IS_EXTERN (sym->etype))
             {
               /* if none of symbols is a compiler defined function
@@ -2341,6 +2372,42 @@ cleanUpBlock (bucket ** table, int block)
 /*------------------------------------------------------------------*/
 /* cleanUpLevel - cleans up the symbol table specified for all the  */
 /*                symbols in the given level                        */
+/*------------------------------------------------------------------*/
+/* cleanUpFileScope - removes what is local to a source file before */
+/*                    the next one of a whole program: identifiers  */
+/*                    with internal linkage, enumeration constants, */
+/*                    inline definitions, typedefs and tags         */
+/*------------------------------------------------------------------*/
+void
+cleanUpFileScope (void)
+{
+  int i;
+  bucket *chain;
+
+  for (i = 0; i < HASHTAB_SIZE; i++)
+    {
+      for (chain = SymbolTab[i]; chain; chain = chain->next)
+        {
+          symbol *sym = chain->sym;
+
+          if (chain->level)
+            continue;
+
+          /* an inline definition without an extern declaration
+             provides no external definition, each file has its own */
+          if (IS_STATIC (sym->etype) || IS_TYPEDEF (sym->etype) ||
+            IS_SPEC (sym->etype) && SPEC_ENUM (sym->etype) ||
+            IS_FUNC (sym->type) && IFFUNC_ISINLINE (sym->type) && !IS_EXTERN (sym->etype))
+            deleteSym (SymbolTab, sym, chain->name);
+        }
+    }
+
+  cleanUpLevel (StructTab, 0);
+  cleanUpLevel (TypedefTab, 0);
+  cleanUpLevel (enumTab, 0);
+  cleanUpLevel (AddrspaceTab, 0);
+}
+
 /*------------------------------------------------------------------*/
 void
 cleanUpLevel (bucket ** table, long level)
@@ -2913,6 +2980,48 @@ comparePtrType (sym_link *dest, sym_link *src, bool mustCast, bool ignoreimplici
     return res;
 }
 
+/*------------------------------------------------------------------*/
+/* compareStructUnits - with --whole-program, a struct or union at  */
+/*                      file scope is compatible with one from      */
+/*                      another source file that has the same tag   */
+/*                      and the same members (C11 6.2.7)            */
+/*------------------------------------------------------------------*/
+static int
+compareStructUnits (structdef *dest, structdef *src)
+{
+  static int depth;
+  symbol *dfield, *sfield;
+  int ret = 1;
+
+  if (!options.whole_program || dest->level || src->level ||
+    dest->type != src->type || dest->size != src->size || !dest->fields || !src->fields)
+    return 0;
+
+  if (!dest->tagsym != !src->tagsym || dest->tagsym && strcmp (dest->tag, src->tag))
+    return 0;
+
+  for (dfield = dest->fields, sfield = src->fields; dfield && sfield; dfield = dfield->next, sfield = sfield->next)
+    if (strcmp (dfield->name, sfield->name) || dfield->offset != sfield->offset)
+      return 0;
+  if (dfield || sfield)
+    return 0;
+
+  /* members that point back to the struct only get the check above */
+  if (depth)
+    return 1;
+
+  depth++;
+  for (dfield = dest->fields, sfield = src->fields; dfield; dfield = dfield->next, sfield = sfield->next)
+    if (compareType (dfield->type, sfield->type, false) <= 0)
+      {
+        ret = 0;
+        break;
+      }
+  depth--;
+
+  return ret;
+}
+
 /*--------------------------------------------------------------------*/
 /* compareType - will do type check return 1 if match, 0 if no match, */
 /*               -1 if castable, -2 if only signedness differs        */
@@ -3049,7 +3158,7 @@ compareType (sym_link *dest, sym_link *src, bool ignoreimplicitintrinsic)
   else if (IS_STRUCT (dest))
     {
       if (SPEC_STRUCT (dest) != SPEC_STRUCT (src))
-        return 0;
+        return compareStructUnits (SPEC_STRUCT (dest), SPEC_STRUCT (src));
 
       structdef *destsdef = SPEC_STRUCT (dest);
       structdef *srcsdef = SPEC_STRUCT (src);
@@ -3208,7 +3317,7 @@ compareTypeExact (sym_link * dest, sym_link * src, long level)
 
   if (IS_STRUCT (dest))
     {
-      if (SPEC_STRUCT (dest) != SPEC_STRUCT (src))
+      if (SPEC_STRUCT (dest) != SPEC_STRUCT (src) && !compareStructUnits (SPEC_STRUCT (dest), SPEC_STRUCT (src)))
         return 0;
     }
 
@@ -3462,7 +3571,7 @@ checkFunction (symbol * sym, symbol * csym)
           // this can happen for reentrant functions
           werrorfl (sym->fileDef, sym->lineDef, E_PARAM_NAME_OMITTED, sym->name, argCnt);
           // the show must go on: synthesize a name and symbol
-          SNPRINTF (acargs->name, sizeof (acargs->name), "_%s_PARM_%d", sym->name, argCnt);
+          SNPRINTF (acargs->name, sizeof (acargs->name), "_%s_PARM_%d", linkName (sym), argCnt);
           acargs->sym = newSymbol (acargs->name, 1);
           SPEC_OCLS (acargs->etype) = istack;
           acargs->sym->type = copyLinkChain (acargs->type);
@@ -3783,7 +3892,7 @@ processFuncArgs (symbol *func, sym_link *funcType)
       /* synthesize a variable name */
       if (!val->sym)
         {
-          SNPRINTF (val->name, sizeof (val->name), "_%s_PARM_%d", func->name, pNum);
+          SNPRINTF (val->name, sizeof (val->name), "_%s_PARM_%d", linkName (func), pNum);
           val->sym = newSymbol (val->name, 1);
           val->sym->type = copyLinkChain (val->type);
           val->sym->etype = getSpec (val->sym->type);
@@ -3796,7 +3905,7 @@ processFuncArgs (symbol *func, sym_link *funcType)
         }
       else                      /* symbol name given create synth name */
         {
-          SNPRINTF (val->name, sizeof (val->name), "_%s_PARM_%d", func->name, pNum);
+          SNPRINTF (val->name, sizeof (val->name), "_%s_PARM_%d", linkName (func), pNum);
           strncpyz (val->sym->rname, val->name, sizeof (val->sym->rname));
           val->sym->_isparm = 1;
           if (!defaultOClass (val->sym))
@@ -341,6 +341,7 @@ typedef struct symbol
   bool funcDivFlagSafe:1;           /* we know this function is safe to call with undocumented stm8 flag bit 6 set*/
   bool funcUsesVolatile:1;          /* The function accesses a volatile variable */
   bool funcRestartAtomicSupport:1;  /* The function uses (directly or indirectly) restartable atomic support routines. */
+  unsigned int funcClobberedRegs;   /* Registers (bit per register index) the code of the function might write, when it has been generated in this translation unit */
   unsigned isstrlit;                /* is a string literal and it's usage count  */
   unsigned accuse;                  /* can be left in the accumulator
                                        On the Z80 accuse is divided into
@@ -643,6 +644,8 @@ extern symbol *fp16x16conv[2][5][2];
 /* Dims: shift left/shift right, BYTE/WORD/DWORD/QWORD, SIGNED/UNSIGNED */
 extern symbol *rlrr[2][4][2];
 
+extern int genSymCount;
+
 extern symbol *builtin_memcpy;
 extern symbol *nonbuiltin_memcpy;
 
@@ -686,6 +689,7 @@ sym_link *reverseLink (sym_link *);
 symbol *copySymbol (const symbol *);
 symbol *copySymbolChain (const symbol *);
 char *genSymName (long);
+const char *linkName (const symbol *);
 sym_link *getSpec (sym_link *);
 int compStructSize (int, structdef *);
 sym_link *copyLinkChain (const sym_link *);
@@ -712,6 +716,7 @@ int compareTypeInexact (sym_link *, sym_link *);
 int checkFunction (symbol *, symbol *);
 void cleanUpLevel (bucket **, long);
 void cleanUpBlock (bucket **, int);
+void cleanUpFileScope (void);
 symbol *getAddrspace (sym_link *type);
 int funcInChain (sym_link *);
 void addSymChain (symbol **);
@@ -55,6 +55,8 @@
 #include <boost/graph/copy.hpp>
 #include <boost/graph/adjacency_list.hpp>
 
+#include "SDCCreport.h"
+
 #undef RANGE
 #undef BLOCK
 
@@ -644,5 +646,10 @@ void get_nice_tree_decomposition(T_t &tree_dec, const G_t &cfg)
 #ifdef HAVE_TREEDEC_COMBINATIONS_HPP
   wassert(treedec::is_valid_treedecomposition(cfg, tree_dec));
 #endif
+
+  size_t width = 0;
+  for (unsigned int i = 0; i < boost::num_vertices(tree_dec); i++)
+    width = std::max(width, tree_dec[i].bag.size());
+  reportMax(COUNT_TDWIDTH, width ? width - 1 : 0);
 }
 
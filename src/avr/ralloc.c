@@ -2293,6 +2293,7 @@ avr_assignRegisters (ebbIndex * ebbi)
 	ic = iCodeLabelOptimize (iCodeFromeBBlock (ebbs, count));
 
 
+	reportPhase (PHASE_CODEGEN);
 	genAVRCode (ic);
 	/*     for (; ic ; ic = ic->next) */
 	/*          piCode(ic,stdout); */
@@ -61,6 +61,7 @@ extern "C" {
 #include "SDCCutil.h"
 #include "SDCCasm.h"
 #include "SDCCsystem.h"
+#include "SDCCreport.h"
 
 #include "port.h"
 
@@ -3486,6 +3486,7 @@ ds390_assignRegisters (ebbIndex * ebbi)
   /* now get back the chain */
   ic = iCodeLabelOptimize (iCodeFromeBBlock (ebbs, count));
 
+  reportPhase (PHASE_CODEGEN);
   gen390Code (ic);
 
   /* free up any _G.stackSpil locations allocated */
@@ -7536,6 +7536,7 @@ genF8iCode (iCode *ic)
 float
 dryF8iCode (iCode *ic)
 {
+  reportCount (COUNT_DRYRUNS, 1);
   regalloc_dry_run = true;
   regalloc_dry_run_cost_bytes = 0;
   regalloc_dry_run_cost_cycles = 0;
@@ -796,6 +796,7 @@ f8_assignRegisters (ebbIndex *ebbi)
       dumpLiveRanges (DUMP_LRANGE, liveRanges);
     }
 
+  reportPhase (PHASE_CODEGEN);
   genF8Code (ic);
 
   _G.slocNum = 0;
@@ -11194,6 +11194,7 @@ init_aop_pass(void)
 float
 dryhc08iCode (iCode *ic)
 {
+  reportCount (COUNT_DRYRUNS, 1);
   regalloc_dry_run = true;
   regalloc_dry_run_cost = 0;
 
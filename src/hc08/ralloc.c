@@ -1586,6 +1586,7 @@ hc08_ralloc (ebbIndex * ebbi)
   /* now get back the chain */
   ic = iCodeLabelOptimize (iCodeFromeBBlock (ebbs, count));
 
+  reportPhase (PHASE_CODEGEN);
   genhc08Code (ic);
 
   /* free up any _G.stackSpil locations allocated */
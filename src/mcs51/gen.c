@@ -119,6 +119,11 @@ static struct
 }
 _G;
 
+/* During a dry run code is generated for the cost estimates of the
+   register allocator only, see dry51iCode () */
+static bool regalloc_dry_run;
+static unsigned int regalloc_dry_run_cost;
+
 static char *rb1regs[] =
 {
   "b1_0", "b1_1", "b1_2", "b1_3", "b1_4", "b1_5", "b1_6", "b1_7",
@@ -406,6 +411,28 @@ showR0R1status(iCode * ic)
 }
 #endif
 
+/*-----------------------------------------------------------------*/
+/* ptrRegFreeInOperands - true if neither left nor right operand   */
+/*                        lives in or points through register idx  */
+/*-----------------------------------------------------------------*/
+static bool
+ptrRegFreeInOperands (iCode * ic, int idx)
+{
+  operand *ops[2] = { IC_LEFT (ic), IC_RIGHT (ic) };
+  int i;
+
+  for (i = 0; i < 2; i++)
+    {
+      if (!ops[i])
+        continue;
+      if (bitVectBitValue (mcs51_rUmaskForOp (ops[i]), idx))
+        return FALSE;
+      if (ops[i]->aop && (ops[i]->aop->type == AOP_R0 && idx == R0_IDX || ops[i]->aop->type == AOP_R1 && idx == R1_IDX))
+        return FALSE;
+    }
+  return TRUE;
+}
+
 /*-----------------------------------------------------------------*/
 /* getFreePtr - returns r0 or r1 whichever is free or can be pushed */
 /*-----------------------------------------------------------------*/
@@ -500,20 +527,30 @@ endOfWorld:
       return NULL;
     }
   /* in the case that result AND left AND right needs a pointer reg
-     we can safely use the result's */
+     we can safely use the result's, unless an operand still needs it */
   if (bitVectBitValue (mcs51_rUmaskForOp (IC_RESULT (ic)), R0_IDX) &&
+    ptrRegFreeInOperands (ic, R0_IDX) &&
     (!OP_SYMBOL (IC_RESULT (ic)) || OP_SYMBOL (IC_RESULT (ic))->regs[getSize (operandType (IC_RESULT (ic))) - 1]->rIdx == R0_IDX))
     {
       aop->type = AOP_R0;
       return REG_WITH_INDEX (R0_IDX);
     }
   if (bitVectBitValue (mcs51_rUmaskForOp (IC_RESULT (ic)), R1_IDX) &&
+    ptrRegFreeInOperands (ic, R1_IDX) &&
     (!OP_SYMBOL (IC_RESULT (ic)) || OP_SYMBOL (IC_RESULT (ic))->regs[getSize (operandType (IC_RESULT (ic))) - 1]->rIdx == R1_IDX))
     {
       aop->type = AOP_R1;
       return REG_WITH_INDEX (R1_IDX);
     }
 
+  /* the register allocator tried an assignment we cannot handle */
+  if (regalloc_dry_run)
+    {
+      regalloc_dry_run_cost += 1000;
+      aop->type = AOP_R0;
+      return REG_WITH_INDEX (R0_IDX);
+    }
+
   /* now this is REALLY the end of the world */
   werror (E_INTERNAL_ERROR, __FILE__, __LINE__, "getFreePtr should never reach here");
   exit (EXIT_FAILURE);
@@ -1128,8 +1165,10 @@ aopOp (operand *op, iCode *ic, bool result)
 
   /* if it is spilt then two situations
      a) is rematerialize
-     b) has a spill location */
-  if (sym->isspilt || sym->nRegs == 0)
+     b) has a spill location
+     results that are never used are not seen by the register
+     allocator, a dry run treats them as dummies */
+  if (sym->isspilt || sym->nRegs == 0 || regalloc_dry_run && !sym->regs[0])
     {
       /* rematerialize it NOW */
       if (sym->remat)
@@ -1186,6 +1225,36 @@ aopOp (operand *op, iCode *ic, bool result)
           return;
         }
 
+      /* spill locations are created after register allocation */
+      if (regalloc_dry_run && sym->isspilt)
+        {
+          if (options.stackAuto || (currFunc && IFFUNC_ISREENT (currFunc->type)))
+            {
+              sym->aop = op->aop = aop = newAsmop (0);
+              aop->aopu.aop_ptr = getFreePtr (ic, aop, result);
+              if (aop->type != AOP_STK)
+                {
+                  emitcode ("mov", "a,%s", SP_BP ("sp", "_bp"));
+                  emitcode ("add", "a,#0x01");
+                  emitcode ("mov", "%s,a", aop->aopu.aop_ptr->name);
+                }
+              else
+                {
+                  /* a result pushed and popped into place by freeAsmop () */
+                  regalloc_dry_run_cost += 6 + 3 * getSize (sym->type);
+                  aop->type = AOP_DIR;
+                  aop->aopu.aop_dir = "sloc";
+                }
+            }
+          else
+            {
+              sym->aop = op->aop = aop = newAsmop (AOP_DIR);
+              aop->aopu.aop_dir = "sloc";
+            }
+          aop->size = getSize (sym->type);
+          return;
+        }
+
       /* else must be a dummy iTemp */
       sym->aop = op->aop = aop = newAsmop (AOP_DUMMY);
       aop->size = getSize (sym->type);
@@ -2531,9 +2600,11 @@ skip_byte:
         }
 
       // No byte can be assigned safely (i.e. the assignment is a permutation).
-      //if (!regalloc_dry_run)
-      //  wassertl_bt (0, "Unimplemented.");
-      //cost (180, 180);
+      if (regalloc_dry_run)
+        {
+          regalloc_dry_run_cost += 1000;
+          return;
+        }
       wassert (0);
       return;
     }
@@ -2892,8 +2963,8 @@ saveRegisters (iCode * lic)
     }
 
   /* if the registers have been saved already or don't need to be then
-     do nothing */
-  if (ic->regsSaved)
+     do nothing; a dry run charges the saving to the call itself */
+  if (ic->regsSaved || regalloc_dry_run && ic != lic)
     return;
   if (IS_SYMOP (IC_LEFT (ic)))
     {
@@ -11025,8 +11096,11 @@ genNearPointerGet (operand * left, operand * result, iCode * ic, iCode * pi, iCo
          already in a pointer register, then
          if size > 0 && this could be used again
          we have to point it back to where it
-         belongs */
-      if ((AOP_SIZE (result) > 1 && !OP_SYMBOL (left)->remat && (OP_SYMBOL (left)->liveTo > ic->seq || ic->depth)) && !pi)
+         belongs; a pointer that was only loaded
+         from memory may share its register with
+         the result and must not be touched */
+      if ((AOP_SIZE (result) > 1 && !OP_SYMBOL (left)->remat && (OP_SYMBOL (left)->liveTo > ic->seq || ic->depth)) && !pi &&
+        AOP_INPREG (AOP (left)))
         {
           int size = AOP_SIZE (result) - 1;
           while (size--)
@@ -12946,6 +13020,305 @@ genEndCritical (iCode * ic)
     }
 }
 
+/*-----------------------------------------------------------------*/
+/* genmcs51iCode - generate code for a single iCode                */
+/*-----------------------------------------------------------------*/
+static void
+genmcs51iCode (iCode *ic)
+{
+  switch (ic->op)
+    {
+    case '!':
+      genNot (ic);
+      break;
+
+    case '~':
+      genCpl (ic);
+      break;
+
+    case UNARYMINUS:
+      genUminus (ic);
+      break;
+
+    case IPUSH:
+      genIpush (ic);
+      break;
+
+    case IPUSH_VALUE_AT_ADDRESS:
+      genPointerPush (ic);
+      break;
+
+    case IPOP:
+    {
+      iCode *ifxIc, *popIc;
+      bool CommonRegs = FALSE;
+
+      /* IPOP happens only when trying to restore a
+         spilt live range, if there is an ifx statement
+         following this pop (or several) then the if statement might
+         be using some of the registers being popped which
+         would destroy the contents of the register so
+         we need to check for this condition and handle it */
+      for (ifxIc = ic->next; ifxIc && ifxIc->op == IPOP; ifxIc = ifxIc->next);
+      for (popIc = ic; popIc && popIc->op == IPOP; popIc = popIc->next)
+        CommonRegs |= (ifxIc && ifxIc->op == IFX && !ifxIc->generated && regsInCommon (IC_LEFT (popIc), IC_COND (ifxIc)));
+      if (CommonRegs)
+        genIfx (ifxIc, ic);
+      else
+        genIpop (ic);
+    }
+    break;
+
+    case CALL:
+      genCall (ic);
+      break;
+
+    case PCALL:
+      genPcall (ic);
+      break;
+
+    case FUNCTION:
+      genFunction (ic);
+      break;
+
+    case ENDFUNCTION:
+      genEndFunction (ic);
+      break;
+
+    case RETURN:
+      genRet (ic);
+      break;
+
+    case LABEL:
+      genLabel (ic);
+      break;
+
+    case GOTO:
+      genGoto (ic);
+      break;
+
+    case '+':
+      genPlus (ic);
+      break;
+
+    case '-':
+      if (!genDjnz (ic, ifxForOp (IC_RESULT (ic), ic)))
+        genMinus (ic);
+      break;
+
+    case '*':
+      genMult (ic);
+      break;
+
+    case '/':
+      genDiv (ic);
+      break;
+
+    case '%':
+      genMod (ic);
+      break;
+
+    case '>':
+      genCmpGt (ic, ifxForOp (IC_RESULT (ic), ic));
+      break;
+
+    case '<':
+      genCmpLt (ic, ifxForOp (IC_RESULT (ic), ic));
+      break;
+
+    case LE_OP:
+    case GE_OP:
+    case NE_OP:
+
+      /* note these two are xlated by algebraic equivalence
+         in decorateType() in SDCCast.c */
+      werror (E_INTERNAL_ERROR, __FILE__, __LINE__, "got '>=' or '<=' shouldn't have come here");
+      break;
+
+    case EQ_OP:
+      genCmpEq (ic, ifxForOp (IC_RESULT (ic), ic));
+      break;
+
+    case AND_OP:
+      genAndOp (ic);
+      break;
+
+    case OR_OP:
+      genOrOp (ic);
+      break;
+
+    case '^':
+      genXor (ic, ifxForOp (IC_RESULT (ic), ic));
+      break;
+
+    case '|':
+      genOr (ic, ifxForOp (IC_RESULT (ic), ic));
+      break;
+
+    case BITWISEAND:
+      genAnd (ic, ifxForOp (IC_RESULT (ic), ic));
+      break;
+
+    case INLINEASM:
+      genInline (ic);
+      break;
+
+    case GETABIT:
+      genGetAbit (ic);
+      break;
+
+    case GETBYTE:
+      genGetByte (ic);
+      break;
+
+    case GETWORD:
+      genGetWord (ic);
+      break;
+
+    case ROT:
+      genRot (ic);
+      break;
+
+    case LEFT_OP:
+      genLeftShift (ic);
+      break;
+
+    case RIGHT_OP:
+      genRightShift (ic);
+      break;
+
+    case GET_VALUE_AT_ADDRESS:
+      genPointerGet (ic, regalloc_dry_run ? NULL : hasInc (IC_LEFT (ic), ic, getSize (operandType (IC_RESULT (ic)))), ifxForOp (IC_RESULT (ic), ic));
+      break;
+
+    case '=':
+      if (POINTER_SET (ic))
+        genPointerSet (ic, regalloc_dry_run ? NULL : hasInc (IC_RESULT (ic), ic, getSize (operandType (IC_RIGHT (ic)))));
+      else
+        genAssign (ic);
+      break;
+
+    case IFX:
+      genIfx (ic, NULL);
+      break;
+
+    case ADDRESS_OF:
+      genAddrOf (ic);
+      break;
+
+    case JUMPTABLE:
+      genJumpTab (ic);
+      break;
+
+    case CAST:
+      genCast (ic);
+      break;
+
+    case RECEIVE:
+      genReceive (ic);
+      break;
+
+    case SEND:
+      if (!regalloc_dry_run)
+        addSet (&_G.sendSet, ic);
+      else
+        {
+          set *sendSet = NULL;
+          addSet (&sendSet, ic);
+          genSend (sendSet);
+          deleteSet (&sendSet);
+        }
+      break;
+
+    case DUMMY_READ_VOLATILE:
+      genDummyRead (ic);
+      break;
+
+    case CRITICAL:
+      genCritical (ic);
+      break;
+
+    case ENDCRITICAL:
+      genEndCritical (ic);
+      break;
+
+    default:
+      break;
+    }
+}
+
+/*-----------------------------------------------------------------*/
+/* dry51iCode - code size of a single iCode for the register       */
+/*              allocator, nothing is emitted                      */
+/*-----------------------------------------------------------------*/
+unsigned int
+dry51iCode (iCode *ic)
+{
+  char G[sizeof (_G)];
+  genLine_t savedLine = genLine;
+  bool regsSaved = ic->regsSaved, bankSaved = ic->bankSaved;
+  bool generated = ic->generated, nextGenerated = ic->next && ic->next->generated;
+  int savedLabelKey = labelKey;
+  unsigned int cost;
+  lineNode *pl;
+
+  /* no code for these, see gen51Code () */
+  if (resultRemat (ic) || ic->generated)
+    return 0;
+
+  reportCount (COUNT_DRYRUNS, 1);
+  memcpy (G, &_G, sizeof (_G));
+  genLine.lineHead = genLine.lineCurr = NULL;
+  initGenLineElement ();
+  genLine.lineElement.ic = ic;
+
+  _G.currentFunc = currFunc;
+  spname = options.useXstack ? "_spx" : "sp";
+  /* the arguments pushed for a call are popped by it */
+  if (ic->op == CALL || ic->op == PCALL)
+    {
+      if (options.useXstack)
+        _G.stack.xpushed = ic->parmBytes;
+      else
+        _G.stack.pushed = ic->parmBytes;
+    }
+
+  regalloc_dry_run = true;
+  regalloc_dry_run_cost = 0;
+  rtrackSuspend (true);
+
+  genmcs51iCode (ic);
+
+  rtrackSuspend (false);
+  regalloc_dry_run = false;
+
+  cost = regalloc_dry_run_cost;
+  for (pl = genLine.lineHead; pl; pl = pl->next)
+    if (!pl->isComment && !pl->isLabel && !pl->isDebug)
+      cost += port->peep.getSize (pl);
+
+  destroy_line_list ();
+  genLine = savedLine;
+  /* the labels of the discarded lines are not needed */
+  labelKey = savedLabelKey;
+  memcpy (&_G, G, sizeof (_G));
+  ic->regsSaved = regsSaved;
+  ic->bankSaved = bankSaved;
+  ic->generated = generated;
+  if (ic->next)
+    ic->next->generated = nextGenerated;
+
+  /* the asmops depend on the registers tried */
+  if (IS_SYMOP (IC_LEFT (ic)))
+    IC_LEFT (ic)->aop = OP_SYMBOL (IC_LEFT (ic))->aop = NULL;
+  if (IS_SYMOP (IC_RIGHT (ic)))
+    IC_RIGHT (ic)->aop = OP_SYMBOL (IC_RIGHT (ic))->aop = NULL;
+  if (IS_SYMOP (IC_RESULT (ic)))
+    IC_RESULT (ic)->aop = OP_SYMBOL (IC_RESULT (ic))->aop = NULL;
+
+  return cost;
+}
+
 /*-----------------------------------------------------------------*/
 /* gen51Code - generate code for 8051 based controllers            */
 /*-----------------------------------------------------------------*/
@@ -12974,6 +13347,14 @@ gen51Code (iCode * lic)
   else
     spname = "sp";
 
+  /* undo the marks left by the cost estimates of the register allocator */
+  regalloc_dry_run = false;
+  for (ic = lic; ic; ic = ic->next)
+    {
+      ic->generated = false;
+      ic->regsSaved = false;
+    }
+
   for (ic = lic; ic; ic = ic->next)
     {
       initGenLineElement ();
@@ -13033,218 +13414,7 @@ gen51Code (iCode * lic)
       if (resultRemat (ic) || ic->generated)
         continue;
 
-      /* depending on the operation */
-      switch (ic->op)
-        {
-        case '!':
-          genNot (ic);
-          break;
-
-        case '~':
-          genCpl (ic);
-          break;
-
-        case UNARYMINUS:
-          genUminus (ic);
-          break;
-
-        case IPUSH:
-          genIpush (ic);
-          break;
-
-        case IPUSH_VALUE_AT_ADDRESS:
-          genPointerPush (ic);
-          break;
-
-        case IPOP:
-        {
-          iCode *ifxIc, *popIc;
-          bool CommonRegs = FALSE;
-
-          /* IPOP happens only when trying to restore a
-             spilt live range, if there is an ifx statement
-             following this pop (or several) then the if statement might
-             be using some of the registers being popped which
-             would destroy the contents of the register so
-             we need to check for this condition and handle it */
-          for (ifxIc = ic->next; ifxIc && ifxIc->op == IPOP; ifxIc = ifxIc->next);
-          for (popIc = ic; popIc && popIc->op == IPOP; popIc = popIc->next)
-            CommonRegs |= (ifxIc && ifxIc->op == IFX && !ifxIc->generated && regsInCommon (IC_LEFT (popIc), IC_COND (ifxIc)));
-          if (CommonRegs)
-            genIfx (ifxIc, ic);
-          else
-            genIpop (ic);
-        }
-        break;
-
-        case CALL:
-          genCall (ic);
-          break;
-
-        case PCALL:
-          genPcall (ic);
-          break;
-
-        case FUNCTION:
-          genFunction (ic);
-          break;
-
-        case ENDFUNCTION:
-          genEndFunction (ic);
-          break;
-
-        case RETURN:
-          genRet (ic);
-          break;
-
-        case LABEL:
-          genLabel (ic);
-          break;
-
-        case GOTO:
-          genGoto (ic);
-          break;
-
-        case '+':
-          genPlus (ic);
-          break;
-
-        case '-':
-          if (!genDjnz (ic, ifxForOp (IC_RESULT (ic), ic)))
-            genMinus (ic);
-          break;
-
-        case '*':
-          genMult (ic);
-          break;
-
-        case '/':
-          genDiv (ic);
-          break;
-
-        case '%':
-          genMod (ic);
-          break;
-
-        case '>':
-          genCmpGt (ic, ifxForOp (IC_RESULT (ic), ic));
-          break;
-
-        case '<':
-          genCmpLt (ic, ifxForOp (IC_RESULT (ic), ic));
-          break;
-
-        case LE_OP:
-        case GE_OP:
-        case NE_OP:
-
-          /* note these two are xlated by algebraic equivalence
-             in decorateType() in SDCCast.c */
-          werror (E_INTERNAL_ERROR, __FILE__, __LINE__, "got '>=' or '<=' shouldn't have come here");
-          break;
-
-        case EQ_OP:
-          genCmpEq (ic, ifxForOp (IC_RESULT (ic), ic));
-          break;
-
-        case AND_OP:
-          genAndOp (ic);
-          break;
-
-        case OR_OP:
-          genOrOp (ic);
-          break;
-
-        case '^':
-          genXor (ic, ifxForOp (IC_RESULT (ic), ic));
-          break;
-
-        case '|':
-          genOr (ic, ifxForOp (IC_RESULT (ic), ic));
-          break;
-
-        case BITWISEAND:
-          genAnd (ic, ifxForOp (IC_RESULT (ic), ic));
-          break;
-
-        case INLINEASM:
-          genInline (ic);
-          break;
-
-        case GETABIT:
-          genGetAbit (ic);
-          break;
-
-        case GETBYTE:
-          genGetByte (ic);
-          break;
-
-        case GETWORD:
-          genGetWord (ic);
-          break;
-
-        case ROT:
-          genRot (ic);
-          break;
-
-        case LEFT_OP:
-          genLeftShift (ic);
-          break;
-
-        case RIGHT_OP:
-          genRightShift (ic);
-          break;
-
-        case GET_VALUE_AT_ADDRESS:
-          genPointerGet (ic, hasInc (IC_LEFT (ic), ic, getSize (operandType (IC_RESULT (ic)))), ifxForOp (IC_RESULT (ic), ic));
-          break;
-
-        case '=':
-          if (POINTER_SET (ic))
-            genPointerSet (ic, hasInc (IC_RESULT (ic), ic, getSize (operandType (IC_RIGHT (ic)))));
-          else
-            genAssign (ic);
-          break;
-
-        case IFX:
-          genIfx (ic, NULL);
-          break;
-
-        case ADDRESS_OF:
-          genAddrOf (ic);
-          break;
-
-        case JUMPTABLE:
-          genJumpTab (ic);
-          break;
-
-        case CAST:
-          genCast (ic);
-          break;
-
-        case RECEIVE:
-          genReceive (ic);
-          break;
-
-        case SEND:
-          addSet (&_G.sendSet, ic);
-          break;
-
-        case DUMMY_READ_VOLATILE:
-          genDummyRead (ic);
-          break;
-
-        case CRITICAL:
-          genCritical (ic);
-          break;
-
-        case ENDCRITICAL:
-          genEndCritical (ic);
-          break;
-
-        default:
-          ic = ic;
-        }
+      genmcs51iCode (ic);
     }
 
   genLine.lineElement.ic = NULL;
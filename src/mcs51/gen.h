@@ -85,6 +85,7 @@ typedef struct asmop
 asmop;
 
 void gen51Code (iCode *);
+unsigned int dry51iCode (iCode *ic);
 void mcs51_emitDebuggerSymbol (const char *);
 
 bool mcs51IsReturned (const char *what);
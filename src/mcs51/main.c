@@ -1110,6 +1110,6 @@ PORT mcs51_port =
   GPOINTER,                     /* treat unqualified pointers as "generic" pointers */
   1,                            /* reset labelKey to 1 */
   1,                            /* globals & local statics allowed */
-  0,                            /* Number of registers handled in the tree-decomposition-based register allocator in SDCCralloc.hpp */
+  8,                            /* Number of registers handled in the tree-decomposition-based register allocator in SDCCralloc.hpp */
   PORT_MAGIC
 };
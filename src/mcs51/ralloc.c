@@ -181,23 +181,6 @@ allocReg (short type)
   return NULL;
 }
 
-/*-----------------------------------------------------------------*/
-/* allocThisReg - allocates a particular register (if free)        */
-/*-----------------------------------------------------------------*/
-static reg_info *
-allocThisReg (reg_info *reg)
-{
-  if (!reg->isFree)
-    return NULL;
-
-  reg->isFree = 0;
-  if (currFunc)
-    currFunc->regsUsed = bitVectSetBit (currFunc->regsUsed, reg->rIdx);
-
-  return reg;
-}
-
-
 /*-----------------------------------------------------------------*/
 /* mcs51_regWithIdx - returns pointer to register with index number*/
 /*-----------------------------------------------------------------*/
@@ -261,15 +244,6 @@ nfreeRegsType (int type)
   return nFreeRegs (type);
 }
 
-/*-----------------------------------------------------------------*/
-/* useReg - marks a register  as used                              */
-/*-----------------------------------------------------------------*/
-static void
-useReg (reg_info *reg)
-{
-  reg->isFree = 0;
-}
-
 /*-----------------------------------------------------------------*/
 /* computeSpillable - given a point find the spillable live ranges */
 /*-----------------------------------------------------------------*/
@@ -360,15 +334,6 @@ notUsedInRemaining (symbol * sym, eBBlock * ebp, iCode * ic)
   return ((usedInRemaining (operandFromSymbol (sym, false), ic) ? 0 : 1) && allDefsOutOfRange (sym->defs, ebp->fSeq, ebp->lSeq));
 }
 
-/*-----------------------------------------------------------------*/
-/* allLRs - return true for all                                    */
-/*-----------------------------------------------------------------*/
-static int
-allLRs (symbol * sym, eBBlock * ebp, iCode * ic)
-{
-  return 1;
-}
-
 /*-----------------------------------------------------------------*/
 /* liveRangesWith - applies function to a given set of live range  */
 /*-----------------------------------------------------------------*/
@@ -857,38 +822,6 @@ spilSomething (iCode * ic, eBBlock * ebp, symbol * forSym)
     return TRUE;
 }
 
-/*-----------------------------------------------------------------*/
-/* getRegPtr - will try for PTR if not a GPR type if not spil      */
-/*-----------------------------------------------------------------*/
-static reg_info *
-getRegPtr (iCode * ic, eBBlock * ebp, symbol * sym)
-{
-  reg_info *reg;
-  int j;
-
-tryAgain:
-  /* try for a ptr type */
-  if ((reg = allocReg (REG_PTR)))
-    return reg;
-
-  /* try for gpr type */
-  if ((reg = allocReg (REG_GPR)))
-    return reg;
-
-  /* we have to spil */
-  if (!spilSomething (ic, ebp, sym))
-    return NULL;
-
-  /* make sure partially assigned registers aren't reused */
-  for (j = 0; j <= sym->nRegs; j++)
-    if (sym->regs[j])
-      sym->regs[j]->isFree = 0;
-
-  /* this looks like an infinite loop but
-     in reality selectSpil will abort  */
-  goto tryAgain;
-}
-
 /*-----------------------------------------------------------------*/
 /* getRegGpr - will try for GPR if not spil                        */
 /*-----------------------------------------------------------------*/
@@ -937,70 +870,6 @@ getRegBit (symbol * sym)
   return 0;
 }
 
-/*-----------------------------------------------------------------*/
-/* getRegPtrNoSpil - get it cannot be spilt                        */
-/*-----------------------------------------------------------------*/
-static reg_info *
-getRegPtrNoSpil ()
-{
-  reg_info *reg;
-
-  /* try for a ptr type */
-  if ((reg = allocReg (REG_PTR)))
-    return reg;
-
-  /* try for gpr type */
-  if ((reg = allocReg (REG_GPR)))
-    return reg;
-
-  assert (0);
-
-  /* just to make the compiler happy */
-  return 0;
-}
-
-/*-----------------------------------------------------------------*/
-/* getRegGprNoSpil - get it cannot be spilt                        */
-/*-----------------------------------------------------------------*/
-static reg_info *
-getRegGprNoSpil ()
-{
-  reg_info *reg;
-  if ((reg = allocReg (REG_GPR)))
-    return reg;
-
-  if (!mcs51_ptrRegReq)
-    if ((reg = allocReg (REG_PTR)))
-      return reg;
-
-  assert (0);
-
-  /* just to make the compiler happy */
-  return 0;
-}
-
-/*-----------------------------------------------------------------*/
-/* getRegBitNoSpil - get it cannot be spilt                        */
-/*-----------------------------------------------------------------*/
-static reg_info *
-getRegBitNoSpil ()
-{
-  reg_info *reg;
-
-  /* try for a bit type */
-  if ((reg = allocReg (REG_BIT)))
-    return reg;
-
-  /* try for gpr type */
-  if ((reg = allocReg (REG_GPR)))
-    return reg;
-
-  assert (0);
-
-  /* just to make the compiler happy */
-  return 0;
-}
-
 /*-----------------------------------------------------------------*/
 /* symHasReg - symbol has a given register                         */
 /*-----------------------------------------------------------------*/
@@ -1136,150 +1005,11 @@ deassignLRs (iCode * ic, eBBlock * ebp)
 
 
 /*-----------------------------------------------------------------*/
-/* reassignLR - reassign this to registers                         */
+/* serialRegMark - marks the variables for the tree decomposition  */
+/*                 allocator, bit registers are assigned here      */
 /*-----------------------------------------------------------------*/
 static void
-reassignLR (operand * op)
-{
-  symbol *sym = OP_SYMBOL (op);
-  int i;
-
-  /* not spilt any more */
-  sym->isspilt = sym->spillA = sym->blockSpil = sym->remainSpil = 0;
-  bitVectUnSetBit (_G.spiltSet, sym->key);
-
-  _G.regAssigned = bitVectSetBit (_G.regAssigned, sym->key);
-  _G.totRegAssigned = bitVectSetBit (_G.totRegAssigned, sym->key);
-
-  _G.blockSpil--;
-
-  for (i = 0; i < sym->nRegs; i++)
-    sym->regs[i]->isFree = 0;
-}
-
-/*-----------------------------------------------------------------*/
-/* willCauseSpill - determines if allocating will cause a spill    */
-/*-----------------------------------------------------------------*/
-static int
-willCauseSpill (int nr, int rt)
-{
-  /* first check if there are any available registers
-     of the type required */
-  if (rt == REG_PTR)
-    {
-      /* special case for pointer type
-         if pointer type not available then
-         check for type gpr */
-      if (nFreeRegs (rt) >= nr)
-        return 0;
-      if (nFreeRegs (REG_GPR) >= nr)
-        return 0;
-    }
-  else if (rt == REG_BIT)
-    {
-      if (nFreeRegs (rt) >= nr)
-        return 0;
-    }
-  else
-    {
-      if (mcs51_ptrRegReq)
-        {
-          if (nFreeRegs (rt) >= nr)
-            return 0;
-        }
-      else
-        {
-          if (nFreeRegs (REG_PTR) + nFreeRegs (REG_GPR) >= nr)
-            return 0;
-        }
-    }
-
-  /* it will cause a spil */
-  return 1;
-}
-
-/*-----------------------------------------------------------------*/
-/* positionRegs - the allocator can allocate same registers to     */
-/* result and operand, if this happens make sure they are in the   */
-/* same position as the operand otherwise chaos results            */
-/*-----------------------------------------------------------------*/
-static int
-positionRegs (symbol * result, symbol * opsym, int chOp)
-{
-  int count = min (result->nRegs, opsym->nRegs);
-  int i, j = 0, shared = 0;
-  int change = 0;
-
-  /* if the result has been spilt then cannot share */
-  if (opsym->isspilt)
-    return 0;
-
-  for (;;)
-    {
-      shared = 0;
-      /* first make sure that they actually share */
-      for (i = 0; i < count; i++)
-        for (j = 0; j < count; j++)
-          if (result->regs[i] == opsym->regs[j] && i != j)
-            {
-              shared = 1;
-              goto xchgPositions;
-            }
-xchgPositions:
-      if (shared)
-        if (!chOp)
-          {
-            reg_info *tmp = result->regs[i];
-            result->regs[i] = result->regs[j];
-            result->regs[j] = tmp;
-            change++;
-          }
-        else
-          {
-            reg_info *tmp = opsym->regs[i];
-            opsym->regs[i] = opsym->regs[j];
-            opsym->regs[j] = tmp;
-            change++;
-          }
-      else
-        return change;
-    }
-}
-
-/*------------------------------------------------------------------*/
-/* verifyRegsAssigned - make sure an iTemp is properly initialized; */
-/* it should either have registers or have beed spilled. Otherwise, */
-/* there was an uninitialized variable, so just spill this to get   */
-/* the operand in a valid state.                                    */
-/*------------------------------------------------------------------*/
-static void
-verifyRegsAssigned (operand * op, iCode * ic)
-{
-  symbol *sym;
-
-  if (!op)
-    return;
-  if (!IS_ITEMP (op))
-    return;
-
-  sym = OP_SYMBOL (op);
-  if (sym->isspilt)
-    return;
-  if (!sym->nRegs)
-    return;
-  if (sym->regs[0])
-    return;
-
-  werrorfl (ic->filename, ic->lineno, W_LOCAL_NOINIT, sym->prereqv ? sym->prereqv->name : sym->name);
-  spillThis (sym);
-}
-
-
-/*-----------------------------------------------------------------*/
-/* serialRegAssign - serially allocate registers to the variables  */
-/*-----------------------------------------------------------------*/
-static void
-serialRegAssign (eBBlock ** ebbs, int count)
+serialRegMark (eBBlock ** ebbs, int count)
 {
   int i;
 
@@ -1296,11 +1026,6 @@ serialRegAssign (eBBlock ** ebbs, int count)
         {
           updateRegUsage (ic);
 
-          /* if this is an ipop that means some live
-             range will have to be assigned again */
-          if (ic->op == IPOP)
-            reassignLR (IC_LEFT (ic));
-
           /* if result is present && is a true symbol */
           if (IC_RESULT (ic) && ic->op != IFX && IS_TRUE_SYMOP (IC_RESULT (ic)))
             {
@@ -1326,10 +1051,6 @@ serialRegAssign (eBBlock ** ebbs, int count)
           if (IC_RESULT (ic))
             {
               symbol *sym = OP_SYMBOL (IC_RESULT (ic));
-              bitVect *spillable;
-              int willCS;
-              int j;
-              int ptrRegSet = 0;
 
               /* Make sure any spill location is definitely allocated */
               if (sym->isspilt && !sym->remat && sym->usl.spillLoc && !sym->usl.spillLoc->allocreq)
@@ -1345,397 +1066,77 @@ serialRegAssign (eBBlock ** ebbs, int count)
                   continue;
                 }
 
-              /* do not try to spil bit registers as it won't work */
-              if (sym->regType != REG_BIT)
-                {
-                  /* if some liverange has been spilt at the block level
-                     and this one live beyond this block then spil this
-                     to be safe */
-                  if (_G.blockSpil && sym->liveTo > ebbs[i]->lSeq)
-                    {
-                      spillThis (sym);
-                      continue;
-                    }
-
-                  willCS = willCauseSpill (sym->nRegs, sym->regType);
-                  /* if this is a bit variable then don't use precious registers
-                     along with expensive bit-to-char conversions but just spill
-                     it */
-                  if (willCS && SPEC_NOUN (sym->etype) == V_BIT)
-                    {
-                      spillThis (sym);
-                      continue;
-                    }
-
-                  /* if trying to allocate this will cause
-                     a spill and there is nothing to spill
-                     or this one is rematerializable then
-                     spill this one */
-                  spillable = computeSpillable (ic);
-                  if (sym->remat || (willCS && bitVectIsZero (spillable)))
-                    {
-                      spillThis (sym);
-                      continue;
-                    }
-
-                  /* If the live range preceeds the point of definition
-                     then ideally we must take into account registers that
-                     have been allocated after sym->liveFrom but freed
-                     before ic->seq. This is complicated, so spill this
-                     symbol instead and let fillGaps handle the allocation. */
-                  if (sym->liveFrom < ic->seq)
-                    {
-                      spillThis (sym);
-                      continue;
-                    }
-
-                  /* if it has a spillocation & is used less than
-                     all other live ranges then spill this */
-                  if (willCS)
-                    {
-                      if (sym->usl.spillLoc)
-                        {
-                          symbol *leastUsed = leastUsedLR (liveRangesWith (spillable,
-                                                                           allLRs, ebbs[i], ic));
-                          if (leastUsed && leastUsed->used > sym->used)
-                            {
-                              spillThis (sym);
-                              continue;
-                            }
-                        }
-                      else
-                        {
-                          /* if none of the liveRanges have a spillLocation then better
-                             to spill this one than anything else already assigned to registers */
-                          if (liveRangesWith (spillable, noSpilLoc, ebbs[i], ic))
-                            {
-                              /* if this is local to this block then we might find a block spil */
-                              if (!(sym->liveFrom >= ebbs[i]->fSeq && sym->liveTo <= ebbs[i]->lSeq))
-                                {
-                                  spillThis (sym);
-                                  continue;
-                                }
-                            }
-                        }
-                    }
-                }
-              /* if we need ptr regs for the right side
-                 then mark it */
-              if (POINTER_GET (ic) && IS_SYMOP (IC_LEFT (ic))
-                  && getSize (OP_SYMBOL (IC_LEFT (ic))->type) <= (unsigned int) NEARPTRSIZE)
-                {
-                  mcs51_ptrRegReq++;
-                  ptrRegSet = 1;
-                }
-              if (IC_LEFT (ic) && IS_SYMOP (IC_LEFT (ic)) && SPEC_OCLS (OP_SYMBOL (IC_LEFT (ic))->etype) == idata)
-                {
-                  mcs51_ptrRegReq++;
-                  ptrRegSet = 1;
-                }
-              if (IC_RIGHT (ic) && IS_SYMOP (IC_RIGHT (ic)) && SPEC_OCLS (OP_SYMBOL (IC_RIGHT (ic))->etype) == idata)
-                {
-                  mcs51_ptrRegReq++;
-                  ptrRegSet = 1;
-                }
-
-              /* else we assign registers to it */
-              _G.regAssigned = bitVectSetBit (_G.regAssigned, sym->key);
-              _G.totRegAssigned = bitVectSetBit (_G.totRegAssigned, sym->key);
-
-              for (j = 0; j < sym->nRegs; j++)
-                {
-                  sym->regs[j] = NULL;
-                  if (sym->regType == REG_PTR)
-                    sym->regs[j] = getRegPtr (ic, ebbs[i], sym);
-                  else
-                    {
-                      if (ic->op == CAST && IS_SYMOP (IC_RIGHT (ic)))
-                        {
-                          symbol *right = OP_SYMBOL (IC_RIGHT (ic));
-
-                          if (right->regs[j] && (right->regType != REG_BIT))
-                            sym->regs[j] = allocThisReg (right->regs[j]);
-                        }
-                      if (!sym->regs[j])
-                        {
-                          if (sym->regType == REG_BIT) /* Prefer spilling over a GPR */
-                            sym->regs[j] = getRegBit (sym);
-                          else
-                            sym->regs[j] = getRegGpr (ic, ebbs[i], sym);
-                        }
-                    }
-
-                  /* if the allocation failed which means
-                     this was spilt then break */
-                  if (!sym->regs[j])
-                    {
-                      int i;
-                      for (i = 0; i < sym->nRegs; i++)
-                        sym->regs[i] = NULL;
-                      break;
-                    }
-                }
-
-              /* for debugging prefer to keep the sym in ascending
-                 registers so sort them by address */
-              if (sym->regs[0])
+              /* bit registers are not handled by the new allocator */
+              if (sym->regType == REG_BIT)
                 {
-                  for (j = 0; j < sym->nRegs - 1; j++)
+                  if ((sym->regs[0] = getRegBit (sym)))
                     {
-                      int k;
-                      for (k=j+1; k<sym->nRegs; k++)
-                        {
-                          if (sym->regs[j]->offset > sym->regs[k]->offset)
-                            {
-                              reg_info *tmp = sym->regs[j];
-                              sym->regs[j] = sym->regs[k];
-                              sym->regs[k] = tmp;
-                            }
-                        }
+                      _G.regAssigned = bitVectSetBit (_G.regAssigned, sym->key);
+                      _G.totRegAssigned = bitVectSetBit (_G.totRegAssigned, sym->key);
                     }
+                  continue;
                 }
 
-              if (!POINTER_SET (ic) && !POINTER_GET (ic))
+              if (sym->remat)
                 {
-                  /* if it shares registers with operands make sure
-                     that they are in the same position */
-                  if (IC_LEFT (ic) && IS_SYMOP (IC_LEFT (ic)) && OP_SYMBOL (IC_LEFT (ic))->nRegs)
-                    {
-                      positionRegs (OP_SYMBOL (IC_RESULT (ic)), OP_SYMBOL (IC_LEFT (ic)), 0);
-                    }
-                  /* do the same for the right operand */
-                  if (IC_RIGHT (ic) && IS_SYMOP (IC_RIGHT (ic)) && OP_SYMBOL (IC_RIGHT (ic))->nRegs)
-                    {
-                      positionRegs (OP_SYMBOL (IC_RESULT (ic)), OP_SYMBOL (IC_RIGHT (ic)), 0);
-                    }
+                  spillThis (sym);
+                  continue;
                 }
 
-              if (ptrRegSet)
-                {
-                  mcs51_ptrRegReq--;
-                  ptrRegSet = 0;
-                }
+              sym->for_newralloc = 1;
             }
         }
     }
-
-  /* Check for and fix any problems with uninitialized operands */
-  for (i = 0; i < count; i++)
-    {
-      iCode *ic;
-
-      if (ebbs[i]->noPath && (ebbs[i]->entryLabel != entryLabel && ebbs[i]->entryLabel != returnLabel))
-        {
-          continue;
-        }
-
-      for (ic = ebbs[i]->sch; ic; ic = ic->next)
-        {
-          if (SKIP_IC2 (ic))
-            continue;
-
-          verifyRegsAssigned (IC_RESULT (ic), ic);
-          verifyRegsAssigned (IC_LEFT (ic), ic);
-          verifyRegsAssigned (IC_RIGHT (ic), ic);
-        }
-    }
 }
 
 /*-----------------------------------------------------------------*/
-/* fillGaps - Try to fill in the Gaps left by Pass1                */
+/* RegFix - spills the variables left without registers            */
 /*-----------------------------------------------------------------*/
 static void
-fillGaps (void)
+RegFix (eBBlock ** ebbs, int count)
 {
-  symbol *sym = NULL;
-  int key = 0;
-  int pass;
-  iCode *ic = NULL;
-
-  if (getenv ("DISABLE_FILL_GAPS"))
-    return;
+  int i;
 
-  /* look for liveranges that were spilt by the allocator */
-  for (sym = hTabFirstItem (liveRanges, &key); sym; sym = hTabNextItem (liveRanges, &key))
+  for (i = 0; i < count; i++)
     {
-      int i;
-      int pdone = 0;
-
-      if (!sym->spillA || !sym->clashes || sym->remat)
-        continue;
+      iCode *ic;
 
-      /* if spilt in direct space the original rname is lost */
-      if (sym->usl.spillLoc && (IN_DIRSPACE (SPEC_OCLS (sym->usl.spillLoc->etype))))
+      if (ebbs[i]->noPath && (ebbs[i]->entryLabel != entryLabel && ebbs[i]->entryLabel != returnLabel))
         continue;
 
-      /* find the liveRanges this one clashes with, that are
-         still assigned to registers & mark the registers as used */
-      for (i = 0; i < sym->clashes->size; i++)
+      for (ic = ebbs[i]->sch; ic; ic = ic->next)
         {
-          int k;
-          symbol *clr;
-
-          if (bitVectBitValue (sym->clashes, i) == 0 || /* those that clash with this */
-              bitVectBitValue (_G.totRegAssigned, i) == 0)      /* and are still assigned to registers */
-            continue;
-
-          clr = hTabItemWithKey (liveRanges, i);
-          assert (clr);
-
-          /* mark these registers as used */
-          for (k = 0; k < clr->nRegs; k++)
-            useReg (clr->regs[k]);
-        }
+          operand *ops[3];
+          int j;
 
-      if (willCauseSpill (sym->nRegs, sym->regType))
-        {
-          /* NOPE :( clear all registers & and continue */
-          freeAllRegs ();
-          continue;
-        }
+          deassignLRs (ic, ebbs[i]);
 
-      ic = NULL;
-      for (i = 0; i < sym->defs->size; i++)
-        {
-          if (bitVectBitValue (sym->defs, i))
-            {
-              if (!(ic = hTabItemWithKey (iCodehTab, i)))
-                continue;
-              if (ic->op == CAST)
-                break;
-            }
-        }
+          if (SKIP_IC2 (ic))
+            continue;
 
-      D (printf ("Attempting fillGaps on %s: [", sym->name));
-      /* THERE IS HOPE !!!! */
-      for (i = 0; i < sym->nRegs; i++)
-        {
-          if (sym->regType == REG_PTR)
-            sym->regs[i] = getRegPtrNoSpil ();
-          else if (sym->regType == REG_BIT)
-            sym->regs[i] = getRegBitNoSpil ();
-          else
+          ops[0] = IC_RESULT (ic);
+          ops[1] = IC_LEFT (ic);
+          ops[2] = IC_RIGHT (ic);
+          for (j = 0; j < 3; j++)
             {
-              sym->regs[i] = NULL;
-              if (ic && ic->op == CAST && IS_SYMOP (IC_RIGHT (ic)))
-                {
-                  symbol *right = OP_SYMBOL (IC_RIGHT (ic));
+              symbol *sym;
+              int k;
 
-                  if (right->regs[i] && right->regs[i]->type != REG_BIT)
-                    sym->regs[i] = allocThisReg (right->regs[i]);
-                }
-              if (!sym->regs[i])
-                sym->regs[i] = getRegGprNoSpil ();
-            }
-          D (printf ("%s ", sym->regs[i]->name));
-        }
-      D (printf ("]\n"));
-
-      /* For all its definitions check if the registers
-         allocated needs positioning NOTE: we can position
-         only ONCE if more than One positioning required
-         then give up.
-         We may need to perform the checks twice; once to
-         position the registers as needed, the second to
-         verify any register repositioning is still
-         compatible.
-       */
-      sym->isspilt = 0;
-      for (pass = 0; pass < 2; pass++)
-        {
-          D (printf (" checking definitions\n"));
-          for (i = 0; i < sym->defs->size; i++)
-            {
-              if (bitVectBitValue (sym->defs, i))
-                {
-                  if (!(ic = hTabItemWithKey (iCodehTab, i)))
-                    continue;
-                  D (printf ("  ic->seq = %d\n", ic->seq));
-                  if (SKIP_IC (ic))
-                    continue;
-                  assert (isSymbolEqual (sym, OP_SYMBOL (IC_RESULT (ic))));     /* just making sure */
-                  /* if left is assigned to registers */
-                  if (IS_SYMOP (IC_LEFT (ic)))
-                    {
-                      D (printf ("   left = "));
-                      D (printOperand (IC_LEFT (ic), NULL));
-                    }
-                  if (IS_SYMOP (IC_LEFT (ic)) && bitVectBitValue (_G.totRegAssigned, OP_SYMBOL (IC_LEFT (ic))->key))
-                    {
-                      pdone += (positionRegs (sym, OP_SYMBOL (IC_LEFT (ic)), 0) > 0);
-                    }
-                  if (IS_SYMOP (IC_RIGHT (ic)))
-                    {
-                      D (printf ("   right = "));
-                      D (printOperand (IC_RIGHT (ic), NULL));
-                    }
-                  if (IS_SYMOP (IC_RIGHT (ic)) && bitVectBitValue (_G.totRegAssigned, OP_SYMBOL (IC_RIGHT (ic))->key))
-                    {
-                      pdone += (positionRegs (sym, OP_SYMBOL (IC_RIGHT (ic)), 0) > 0);
-                    }
-                  D (printf ("   pdone = %d\n", pdone));
-                  if (pdone > 1)
-                    break;
-                }
-            }
-          D (printf (" checking uses\n"));
-          for (i = 0; i < sym->uses->size; i++)
-            {
-              if (bitVectBitValue (sym->uses, i))
+              if (!ops[j] || !IS_ITEMP (ops[j]))
+                continue;
+              sym = OP_SYMBOL (ops[j]);
+              if (sym->isspilt || !sym->nRegs)
+                continue;
+              if (!sym->regs[0])
                 {
-                  iCode *ic;
-                  if (!(ic = hTabItemWithKey (iCodehTab, i)))
-                    continue;
-                  D (printf ("  ic->seq = %d\n", ic->seq));
-                  if (SKIP_IC (ic))
-                    continue;
-                  if (POINTER_SET (ic) || POINTER_GET (ic))
-                    continue;
-
-                  /* if result is assigned to registers */
-                  if (IS_SYMOP (IC_RESULT (ic)))
-                    {
-                      D (printf ("   result = "));
-                      D (printOperand (IC_RESULT (ic), NULL));
-                    }
-                  if (IS_SYMOP (IC_RESULT (ic)) && bitVectBitValue (_G.totRegAssigned, OP_SYMBOL (IC_RESULT (ic))->key))
-                    {
-                      pdone += (positionRegs (sym, OP_SYMBOL (IC_RESULT (ic)), 0) > 0);
-                    }
-                  D (printf ("   pdone = %d\n", pdone));
-                  if (pdone > 1)
-                    break;
+                  spillThis (sym);
+                  continue;
                 }
+              if (currFunc)
+                for (k = 0; k < sym->nRegs; k++)
+                  currFunc->regsUsed = bitVectSetBit (currFunc->regsUsed, sym->regs[k]->rIdx);
             }
-          if (pdone == 0)
-            break;              /* second pass only if regs repositioned */
-          if (pdone > 1)
-            break;
         }
-      D (printf (" sym->regs = ["));
-      for (i = 0; i < sym->nRegs; i++)
-        D (printf ("%s ", sym->regs[i]->name));
-      D (printf ("]\n"));
-      /* had to position more than once GIVE UP */
-      if (pdone > 1)
-        {
-          /* UNDO all the changes we made to try this */
-          sym->isspilt = 1;
-          for (i = 0; i < sym->nRegs; i++)
-            {
-              sym->regs[i] = NULL;
-            }
-          freeAllRegs ();
-          D (printf
-             ("Fill Gap gave up due to positioning for %s in function %s\n", sym->name, currFunc ? currFunc->name : "UNKNOWN"));
-          continue;
-        }
-      D (printf ("FILLED GAP for %s in function %s\n", sym->name, currFunc ? currFunc->name : "UNKNOWN"));
-
-      _G.totRegAssigned = bitVectSetBit (_G.totRegAssigned, sym->key);
-      sym->isspilt = sym->spillA = 0;
-      sym->usl.spillLoc->allocreq--;
-      freeAllRegs ();
     }
 }
 
@@ -3346,32 +2747,6 @@ packRegisters (eBBlock ** ebpp, int blockno)
     }
 }
 
-/*------------------------------------------------------------------------*/
-/* positionRegsReverse - positioning registers from end to begin to avoid */
-/* conflict among result, left and right operands in some extrem cases    */
-/*------------------------------------------------------------------------*/
-static void
-positionRegsReverse (eBBlock ** ebbs, int count)
-{
-  int i;
-  iCode *ic;
-
-  for (i = count - 1; i >= 0; i--)
-    for (ic = ebbs[i]->ech; ic; ic = ic->prev)
-      {
-        if (IC_LEFT (ic) && IS_SYMOP (IC_LEFT (ic)) && OP_SYMBOL (IC_LEFT (ic))->nRegs &&
-            IC_RESULT (ic) && IS_SYMOP (IC_RESULT (ic)) && OP_SYMBOL (IC_RESULT (ic))->nRegs)
-          {
-            positionRegs (OP_SYMBOL (IC_RESULT (ic)), OP_SYMBOL (IC_LEFT (ic)), 1);
-          }
-        if (IC_RIGHT (ic) && IS_SYMOP (IC_RIGHT (ic)) && OP_SYMBOL (IC_RIGHT (ic))->nRegs &&
-            IC_RESULT (ic) && IS_SYMOP (IC_RESULT (ic)) && OP_SYMBOL (IC_RESULT (ic))->nRegs)
-          {
-            positionRegs (OP_SYMBOL (IC_RESULT (ic)), OP_SYMBOL (IC_RIGHT (ic)), 1);
-          }
-      }
-}
-
 /*-----------------------------------------------------------------*/
 /* assignRegisters - assigns registers to each live range as need  */
 /*-----------------------------------------------------------------*/
@@ -3415,16 +2790,16 @@ mcs51_assignRegisters (ebbIndex * ebbi)
      registers & the type of registers required for each */
   regTypeNum (*ebbs);
 
-  /* and serially allocate registers */
-  serialRegAssign (ebbs, count);
+  /* mark the variables for the new allocator */
+  serialRegMark (ebbs, count);
+
+  /* and allocate registers on the tree decomposition */
+  mcs51_ralloc2_cc (ebbi);
 
   freeAllRegs ();
-  //setToNull ((void *) &_G.regAssigned);
-  //setToNull ((void *) &_G.totRegAssigned);
-  fillGaps ();
+  setToNull ((void *) &_G.regAssigned);
 
-  /* do positionRegs() for all ICs from end to begin */
-  positionRegsReverse (ebbs, count);
+  RegFix (ebbs, count);
 
   /* if stack was extended then tell the user */
   if (_G.stackExtend)
@@ -3474,6 +2849,7 @@ mcs51_assignRegisters (ebbIndex * ebbi)
   /* Redo generalized constant propagation */
   recomputeValinfos (ic, ebbi, "_2");
 
+  reportPhase (PHASE_CODEGEN);
   gen51Code (ic);
 
   /* free up any _G.stackSpil locations allocated */
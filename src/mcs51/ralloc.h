@@ -77,6 +77,8 @@ bitVect *mcs51_allBankregs (void);
 extern int mcs51_ptrRegReq;
 extern int mcs51_nRegs;
 
+iCode *mcs51_ralloc2_cc (ebbIndex *ebbi);
+
 
 /* reverse lookup register mnemonic to ?_IDX enum.
 
@@ -0,0 +1,489 @@
+// Philipp Klaus Krause, philipp@informatik.uni-frankfurt.de, pkk@spth.de, 2010 - 2011
+//
+// (c) 2012 Goethe-Universität Frankfurt
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by the
+// Free Software Foundation; either version 2, or (at your option) any
+// later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+//
+// An optimal, polynomial-time register allocator.
+// For mcs51 it places variables in r0 to r7. The accumulator, b and dptr
+// are left to register packing (accuse and ruonly), as code generation
+// uses them as scratch registers.
+
+//#define DEBUG_RALLOC_DEC // Uncomment to get debug messages while doing register allocation on the tree decomposition.
+//#define DEBUG_RALLOC_DEC_ASS // Uncomment to get debug messages about assignments while doing register allocation on the tree decomposition (much more verbose than the one above).
+
+#define TD_SALLOC
+#define CH_SALLOC
+
+#include "SDCCralloc.hpp"
+
+extern "C"
+{
+  #include "ralloc.h"
+  #include "gen.h"
+}
+
+template <class I_t>
+static void add_operand_conflicts_in_node(const cfg_node &n, I_t &I)
+{
+  const iCode *ic = n.ic;
+
+  const operand *result = IC_RESULT(ic);
+  const operand *left = IC_LEFT(ic);
+  const operand *right = IC_RIGHT(ic);
+
+  if(!result || !IS_SYMOP(result) || POINTER_SET(ic))
+    return;
+
+  operand_map_t::const_iterator oir, oir_end, oirs;
+  boost::tie(oir, oir_end) = n.operands.equal_range(OP_SYMBOL_CONST(result)->key);
+  if(oir == oir_end)
+    return;
+
+  // Code generation can handle a result sharing registers with an operand
+  // only when the shared bytes are at the same position. A pointer is
+  // still needed after the first byte of the result has been read.
+  const bool get = POINTER_GET(ic) && getSize(operandType(result)) > 1;
+
+  operand_map_t::const_iterator oio, oio_end;
+
+  if(left && IS_SYMOP(left))
+    for(boost::tie(oio, oio_end) = n.operands.equal_range(OP_SYMBOL_CONST(left)->key); oio != oio_end; ++oio)
+      for(oirs = oir; oirs != oir_end; ++oirs)
+        {
+          var_t rvar = oirs->second;
+          var_t ovar = oio->second;
+          if(get || I[rvar].byte != I[ovar].byte)
+            boost::add_edge(rvar, ovar, I);
+        }
+
+  if(right && IS_SYMOP(right))
+    for(boost::tie(oio, oio_end) = n.operands.equal_range(OP_SYMBOL_CONST(right)->key); oio != oio_end; ++oio)
+      for(oirs = oir; oirs != oir_end; ++oirs)
+        {
+          var_t rvar = oirs->second;
+          var_t ovar = oio->second;
+          if(I[rvar].byte != I[ovar].byte)
+            boost::add_edge(rvar, ovar, I);
+        }
+}
+
+template <class G_t, class I_t>
+static void set_surviving_regs(const assignment &a, unsigned short int i, const G_t &G, const I_t &I)
+{
+  iCode *ic = G[i].ic;
+
+  bitVectClear(ic->rMask);
+  bitVectClear(ic->rSurv);
+
+  cfg_alive_t::const_iterator v, v_end;
+  for (v = G[i].alive.begin(), v_end = G[i].alive.end(); v != v_end; ++v)
+    {
+      if(a.global[*v] < 0)
+        continue;
+      ic->rMask = bitVectSetBit(ic->rMask, a.global[*v]);
+      if(G[i].dying.find(*v) == G[i].dying.end())
+        if(!((IC_RESULT(ic) && !POINTER_SET(ic)) && IS_SYMOP(IC_RESULT(ic)) && OP_SYMBOL_CONST(IC_RESULT(ic))->key == I[*v].v))
+          ic->rSurv = bitVectSetBit(ic->rSurv, a.global[*v]);
+    }
+}
+
+template <class G_t, class I_t>
+static void assign_operand_for_cost(operand *o, const assignment &a, unsigned short int i, const G_t &G, const I_t &I)
+{
+  if(!o || !IS_SYMOP(o))
+    return;
+  symbol *sym = OP_SYMBOL(o);
+  operand_map_t::const_iterator oi, oi_end;
+  for(boost::tie(oi, oi_end) = G[i].operands.equal_range(OP_SYMBOL_CONST(o)->key); oi != oi_end; ++oi)
+    {
+      var_t v = oi->second;
+      if(a.global[v] >= 0)
+        {
+          sym->regs[I[v].byte] = regs8051 + a.global[v];
+          sym->isspilt = false;
+          sym->nRegs = I[v].size;
+        }
+      else
+        {
+          for(int i = 0; i < I[v].size; i++)
+            sym->regs[i] = 0;
+          sym->nRegs = I[v].size;
+          sym->isspilt = true;
+        }
+    }
+}
+
+// The registers used by the operands, code generation takes r0 and r1 for
+// pointers only if they are not in this set or in rMask.
+static void set_used_regs(iCode *ic)
+{
+  const operand *ops[3] = {IC_LEFT(ic), IC_RIGHT(ic), IC_RESULT(ic)};
+
+  if(!ic->rUsed)
+    ic->rUsed = newBitVect(port->num_regs);
+  bitVectClear(ic->rUsed);
+
+  for(int j = 0; j < 3; j++)
+    {
+      if(!ops[j] || !IS_ITEMP(ops[j]))
+        continue;
+      const symbol *sym = OP_SYMBOL_CONST(ops[j]);
+      if(sym->isspilt || sym->regType == REG_BIT)
+        continue;
+      for(int k = 0; k < sym->nRegs; k++)
+        if(sym->regs[k])
+          ic->rUsed = bitVectSetBit(ic->rUsed, sym->regs[k]->rIdx);
+    }
+}
+
+// Check that the operand is either fully in registers or fully in memory.
+template <class G_t, class I_t>
+static bool operand_sane(const operand *o, const assignment &a, unsigned short int i, const G_t &G, const I_t &I)
+{
+  if(!o || !IS_SYMOP(o))
+    return(true);
+
+  operand_map_t::const_iterator oi, oi_end;
+  boost::tie(oi, oi_end) = G[i].operands.equal_range(OP_SYMBOL_CONST(o)->key);
+
+  if(oi == oi_end)
+    return(true);
+
+  // In registers.
+  if(std::binary_search(a.local.begin(), a.local.end(), oi->second))
+    {
+      while(++oi != oi_end)
+        if(!std::binary_search(a.local.begin(), a.local.end(), oi->second))
+          return(false);
+    }
+  else
+    {
+       while(++oi != oi_end)
+        if(std::binary_search(a.local.begin(), a.local.end(), oi->second))
+          return(false);
+    }
+
+  return(true);
+}
+
+template <class G_t, class I_t>
+static bool inst_sane(const assignment &a, unsigned short int i, const G_t &G, const I_t &I)
+{
+  const iCode *ic = G[i].ic;
+
+  // Variables are only ever placed in registers entirely, see RegFix ().
+  cfg_alive_t::const_iterator v, v_end;
+  for(v = G[i].alive.begin(), v_end = G[i].alive.end(); v != v_end; ++v)
+    if(I[*v].byte && (a.global[*v - 1] < 0) != (a.global[*v] < 0))
+      return(false);
+
+  return(operand_sane(IC_RESULT(ic), a, i, G, I) && operand_sane(IC_LEFT(ic), a, i, G, I) && operand_sane(IC_RIGHT(ic), a, i, G, I));
+}
+
+// Internal RAM is scarce, a result that is not placed in registers needs a spill location.
+// Spill locations of functions that call others can not be overlaid, and temporaries without
+// a home of their own need a new one, so these are more expensive.
+template <class G_t, class I_t>
+static float spill_cost(const assignment &a, unsigned short int i, const G_t &G, const I_t &I)
+{
+  const iCode *ic = G[i].ic;
+  const operand *result = IC_RESULT(ic);
+
+  if(!result || !IS_SYMOP(result) || POINTER_SET(ic))
+    return(0.0f);
+
+  const symbol *sym = OP_SYMBOL_CONST(result);
+  if(sym->remat)
+    return(0.0f);
+
+  float byte_cost = (currFunc && IFFUNC_HASFCALL(currFunc->type)) ? 4.0f : 2.0f;
+  if(!sym->usl.spillLoc)
+    byte_cost *= 3.0f;
+
+  float c = 0.0f;
+  operand_map_t::const_iterator oi, oi_end;
+  for(boost::tie(oi, oi_end) = G[i].operands.equal_range(sym->key); oi != oi_end; ++oi)
+    if(a.global[oi->second] < 0)
+      c += byte_cost;
+
+  return(c);
+}
+
+// Cost function.
+template <class G_t, class I_t>
+static float instruction_cost(const assignment &a, unsigned short int i, const G_t &G, const I_t &I)
+{
+  iCode *ic = G[i].ic;
+
+  wassert (TARGET_IS_MCS51);
+
+  if(!inst_sane(a, i, G, I))
+    return(std::numeric_limits<float>::infinity());
+
+  if(ic->generated)
+    return(0.0f);
+
+  switch(ic->op)
+    {
+    // Register assignment doesn't matter for these:
+    case FUNCTION:
+    case ENDFUNCTION:
+    case LABEL:
+    case GOTO:
+    case INLINEASM:
+    case IPOP:
+      return(0.0f);
+    case '!':
+    case '~':
+    case UNARYMINUS:
+    case '+':
+    case '-':
+    case '^':
+    case '|':
+    case BITWISEAND:
+    case IPUSH:
+    case IPUSH_VALUE_AT_ADDRESS:
+    case CALL:
+    case PCALL:
+    case RETURN:
+    case '*':
+    case '/':
+    case '%':
+    case '>':
+    case '<':
+    case EQ_OP:
+    case AND_OP:
+    case OR_OP:
+    case GETABIT:
+    case GETBYTE:
+    case GETWORD:
+    case ROT:
+    case LEFT_OP:
+    case RIGHT_OP:
+    case GET_VALUE_AT_ADDRESS:
+    case '=':
+    case IFX:
+    case ADDRESS_OF:
+    case JUMPTABLE:
+    case CAST:
+    case RECEIVE:
+    case SEND:
+    case DUMMY_READ_VOLATILE:
+    case CRITICAL:
+    case ENDCRITICAL:
+      assign_operand_for_cost(IC_LEFT(ic), a, i, G, I);
+      assign_operand_for_cost(IC_RIGHT(ic), a, i, G, I);
+      assign_operand_for_cost(IC_RESULT(ic), a, i, G, I);
+      set_surviving_regs(a, i, G, I);
+      set_used_regs(ic);
+      return(dry51iCode(ic) + spill_cost(a, i, G, I));
+    default:
+      return(0.0f);
+    }
+}
+
+// For early removal of assignments that cannot be extended to valid assignments.
+template <class G_t, class I_t>
+static bool assignment_hopeless(const assignment &a, unsigned short int i, const G_t &G, const I_t &I, const var_t lastvar)
+{
+  // Variables are placed in registers entirely or not at all, and the bytes of a variable are introduced in order.
+  if(I[lastvar].byte && a.global[lastvar - 1] < 0 && std::binary_search(G[i].alive.begin(), G[i].alive.end(), lastvar - 1))
+    return(true);
+
+  return(false);
+}
+
+// Increase chance of finding good compatible assignments at join nodes.
+template <class T_t>
+static void get_best_local_assignment_biased(assignment &a, typename boost::graph_traits<T_t>::vertex_descriptor t, const T_t &T)
+{
+  const assignment_list_t &alist = T[t].assignments;
+
+  assignment_list_t::const_iterator ai, ai_end, ai_best;
+  for(ai = ai_best = alist.begin(), ai_end = alist.end(); ai != ai_end; ++ai)
+    if(ai->s < ai_best->s)
+      ai_best = ai;
+
+  a = *ai_best;
+
+  varset_t newlocal;
+  std::set_union(T[t].alive.begin(), T[t].alive.end(), a.local.begin(), a.local.end(), std::inserter(newlocal, newlocal.end()));
+  a.local = newlocal;
+}
+
+// Suggest to honor register keyword and a canonical placement of variables.
+template <class G_t, class I_t>
+static float rough_cost_estimate(const assignment &a, unsigned short int i, const G_t &G, const I_t &I)
+{
+  float c = 0.0f;
+
+  unsigned int used = 0;
+  varset_t::const_iterator vi, vi_end;
+  for(vi = a.local.begin(), vi_end = a.local.end(); vi != vi_end; ++vi)
+    used |= 1u << a.global[*vi];
+
+  cfg_alive_t::const_iterator v, v_end;
+  for(v = G[i].alive.begin(), v_end = G[i].alive.end(); v != v_end; ++v)
+    {
+      const symbol *const sym = (symbol *)(hTabItemWithKey(liveRanges, I[*v].v));
+      const reg_t r = a.global[*v];
+      if(r < 0 && IS_REGISTER(sym->type)) // Try to honour register keyword.
+        c += 4.0f;
+      if(r < 0 || r == R0_IDX || r == R1_IDX)
+        continue;
+      // Apart from r0 and r1, which can be used as pointers, the registers are interchangeable. Without a strong
+      // preference for a canonical placement the assignments kept are mostly permutations of each other, and those
+      // kept in different subtrees of the tree decomposition rarely match when they are joined.
+      // Place the bytes of a variable in consecutive registers, starting at the lowest free one.
+      if(I[*v].byte && a.global[*v - 1] >= 0 && a.global[*v - 1] + 1 != r)
+        c += 24.0f;
+      else if(!I[*v].byte && (used & ((1u << r) - 1)) != (1u << r) - 1)
+        c += 12.0f;
+    }
+
+  return(c);
+}
+
+// Code for another ic is generated when generating this one. Mark the other as generated.
+static void extra_ic_generated(iCode *ic)
+{
+  iCode *ifx;
+
+  if(ic->op == '>' || ic->op == '<' || ic->op == EQ_OP || ic->op == '^' || ic->op == '|' || ic->op == BITWISEAND ||
+    ic->op == GET_VALUE_AT_ADDRESS && getSize(operandType(IC_RESULT(ic))) == 1)
+    {
+      if((ifx = ifxForOp (IC_RESULT (ic), ic)))
+        ifx->generated = true;
+    }
+  // See genDjnz ().
+  if(ic->op == '-' && IS_OP_LITERAL (IC_RIGHT (ic)) && operandLitValue (IC_RIGHT (ic)) == 1 && getSize(operandType(IC_RESULT (ic))) == 1 && isOperandEqual (IC_RESULT (ic), IC_LEFT (ic)))
+    {
+      if((ifx = ifxForOp (IC_RESULT (ic), ic)) && !IC_FALSE (ifx))
+        ifx->generated = true;
+    }
+}
+
+template <class T_t, class G_t, class I_t>
+static bool tree_dec_ralloc(T_t &T, G_t &G, const I_t &I)
+{
+  bool assignment_optimal;
+
+  con2_t I2(boost::num_vertices(I));
+  for(unsigned int i = 0; i < boost::num_vertices(I); i++)
+    {
+      I2[i].v = I[i].v;
+      I2[i].byte = I[i].byte;
+      I2[i].size = I[i].size;
+      I2[i].name = I[i].name;
+    }
+  typename boost::graph_traits<I_t>::edge_iterator e, e_end;
+  for(boost::tie(e, e_end) = boost::edges(I); e != e_end; ++e)
+    add_edge(boost::source(*e, I), boost::target(*e, I), I2);
+
+  assignment ac;
+  assignment_optimal = true;
+  tree_dec_ralloc_nodes(T, find_root(T), G, I2, ac, &assignment_optimal);
+
+  const assignment &winner = *(T[find_root(T)].assignments.begin());
+
+#ifdef DEBUG_RALLOC_DEC
+  std::cout << "Winner: ";
+  for(unsigned int i = 0; i < boost::num_vertices(I); i++)
+  {
+  	std::cout << "(" << i << ", " << int(winner.global[i]) << ") ";
+  }
+  std::cout << "\n";
+  std::cout << "Cost: " << winner.s << "\n";
+  std::cout.flush();
+#endif
+
+  // Todo: Make this an assertion
+  if(winner.global.size() != boost::num_vertices(I))
+    {
+      std::cerr << "ERROR: No Assignments at root\n";
+      exit(-1);
+    }
+
+  for(unsigned int v = 0; v < boost::num_vertices(I); v++)
+    {
+      symbol *sym = (symbol *)(hTabItemWithKey(liveRanges, I[v].v));
+      if(winner.global[v] >= 0)
+        {
+          sym->regs[I[v].byte] = regs8051 + winner.global[v];
+          sym->isspilt = false;
+          sym->nRegs = I[v].size;
+        }
+      else
+        {
+          for(int i = 0; i < I[v].size; i++)
+            sym->regs[i] = 0;
+          sym->nRegs = I[v].size;
+          wassert (sym->nRegs);
+          //spillThis(sym); Leave it to regFix, which can do some spillocation compaction. Todo: Use Thorup instead.
+          sym->isspilt = false;
+        }
+    }
+
+  for(unsigned int i = 0; i < boost::num_vertices(G); i++)
+    set_surviving_regs(winner, i, G, I);
+
+  return(!assignment_optimal);
+}
+
+iCode *mcs51_ralloc2_cc(ebbIndex *ebbi)
+{
+
+#ifdef DEBUG_RALLOC_DEC
+  std::cout << "Processing " << currFunc->name << " from " << dstFileName << "\n"; std::cout.flush();
+#endif
+
+  cfg_t control_flow_graph;
+
+  con_t conflict_graph;
+
+  iCode *ic = create_cfg(control_flow_graph, conflict_graph, ebbi);
+
+  if (optimize.genconstprop)
+    recomputeValinfos (ic, ebbi, "_2");
+
+  guessCounts(ic, ebbi);
+
+  if(options.dump_graphs)
+    dump_cfg(control_flow_graph);
+
+  if(options.dump_graphs)
+    dump_con(conflict_graph);
+
+  tree_dec_t tree_decomposition;
+
+  get_nice_tree_decomposition(tree_decomposition, control_flow_graph);
+
+  alive_tree_dec(tree_decomposition, control_flow_graph);
+
+  good_re_root(tree_decomposition);
+  nicify(tree_decomposition);
+  alive_tree_dec(tree_decomposition, control_flow_graph);
+
+  if(options.dump_graphs)
+    dump_tree_decomposition(tree_decomposition);
+
+  guessCounts (ic, ebbi);
+
+  tree_dec_ralloc(tree_decomposition, control_flow_graph, conflict_graph);
+
+  return(ic);
+}
+
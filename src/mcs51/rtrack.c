@@ -1166,6 +1166,22 @@ void rtrackLoadDptrWithSym (const char *x)
 }
 
 
+/* Suspends tracking while code is generated for cost estimates only,
+   the lines generated then are not assembled */
+void rtrackSuspend (bool suspend)
+{
+  static int saved;
+
+  if (suspend)
+    {
+      saved = enable;
+      enable = 0;
+    }
+  else
+    enable = saved;
+}
+
+
 #if 0
 /* Loads index registers R0, R1 with symbol (if needed)
  *
@@ -25,4 +25,6 @@ char * rtrackGetLit(const char *x);
 int rtrackMoveALit (const char *x);
 
 void rtrackLoadDptrWithSym (const char *x);
+
+void rtrackSuspend (bool suspend);
 void rtrackLoadR0R1WithSym (const char *reg, const char *x);
@@ -8561,6 +8561,7 @@ init_aop_pass(void)
 float
 drym6502iCode (iCode *ic)
 {
+  reportCount (COUNT_DRYRUNS, 1);
   regalloc_dry_run = true;
   regalloc_dry_run_cost_bytes = 0;
   regalloc_dry_run_cost_cycles = 0;
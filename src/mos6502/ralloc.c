@@ -1589,6 +1589,7 @@ m6502_assignRegisters (ebbIndex *ebbi)
   /* now get back the chain */
   ic = iCodeLabelOptimize (iCodeFromeBBlock (ebbs, count));
 
+  reportPhase (PHASE_CODEGEN);
   genm6502Code (ic);
 
   /* free up any _G.stackSpil locations allocated */
@@ -5729,6 +5729,7 @@ genPdkiCode (iCode *ic)
 float
 dryPdkiCode (iCode *ic)
 {
+  reportCount (COUNT_DRYRUNS, 1);
   regalloc_dry_run = true;
   regalloc_dry_run_cost_words = 0;
   regalloc_dry_run_cost_cycles = 0;
@@ -733,6 +733,7 @@ pdk_assignRegisters (ebbIndex *ebbi)
       dumpLiveRanges (DUMP_LRANGE, liveRanges);
     }
 
+  reportPhase (PHASE_CODEGEN);
   genPdkCode (ic);
 }
 
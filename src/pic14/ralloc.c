@@ -3888,6 +3888,7 @@ pic14_assignRegisters (ebbIndex *ebbi)
   debugLog ("ebbs after optimizing:\n");
   dumpEbbsToDebug (ebbs, count);
 
+  reportPhase (PHASE_CODEGEN);
   genpic14Code (ic);
 
   /* free up any _G.stackSpil locations allocated */
@@ -1004,7 +1004,10 @@ pic16_printIvalCharPtr (symbol * sym, sym_link * type, value * val, char ptype,
     }
 
   if (val->sym && val->sym->isstrlit) { // && !isinSet(statsg->syms, val->sym)) {
-        if(ptype == 'p' && !isinSet(statsg->syms, val->sym))addSet (&statsg->syms, val->sym);
+        if(ptype == 'p' && !isinSet(statsg->syms, val->sym)) {
+          addSet (&statsg->syms, val->sym);
+          addStringSymbol (val->sym);
+        }
         else if(ptype == 'f' /*&& !isinSet(rel_idataSymSet, val->sym)*/)addSet(&rel_idataSymSet, val->sym);
   }
 
@@ -5586,6 +5586,62 @@ static pCode *findLabelinpBlock(pBlock *pb, const pCodeOpLabel *pcop_label)
 
   return NULL;
 }
+
+/*-----------------------------------------------------------------*/
+/* pBlockLabelIndex - map the key of each compiler generated label */
+/*                    in a pBlock to the first pCode carrying it.  */
+/*                    Lets branch targets be resolved without      */
+/*                    rescanning the whole pBlock for every branch */
+/*-----------------------------------------------------------------*/
+static hTab *pBlockLabelIndex(pBlock *pb)
+{
+  hTab *index = NULL;
+  pBranch *pbr;
+  pCode *pc;
+
+  if(!pb)
+    return NULL;
+
+  for(pc = pb->pcHead; pc; pc = pc->next) {
+    if(pc->type == PC_LABEL) {
+      if((PCL(pc)->key > 0) && !hTabItemWithKey(index, PCL(pc)->key))
+        hTabAddItem(&index, PCL(pc)->key, pc);
+    } else if((pc->type == PC_OPCODE) || (pc->type == PC_ASMDIR)) {
+      for(pbr = PCI(pc)->label; pbr; pbr = pbr->next) {
+        if((pbr->pc->type == PC_LABEL) && (PCL(pbr->pc)->key > 0)
+            && !hTabItemWithKey(index, PCL(pbr->pc)->key))
+          hTabAddItem(&index, PCL(pbr->pc)->key, pc);
+      }
+    }
+  }
+
+  return index;
+}
+
+/*-----------------------------------------------------------------*/
+/* findLabelinIndex - like findLabelinpBlock, but look up labels   */
+/*                    with a positive key in an index built by     */
+/*                    pBlockLabelIndex                             */
+/*-----------------------------------------------------------------*/
+static pCode *findLabelinIndex(hTab *index, pBlock *pb, const pCodeOpLabel *pcop_label)
+{
+  /* function labels (key <= 0) are never indexed */
+  if(pcop_label->key <= 0)
+    return findLabelinpBlock(pb, pcop_label);
+
+  return hTabItemWithKey(index, pcop_label->key);
+}
+
+/*-----------------------------------------------------------------*/
+/* deleteLabelIndex - release an index built by pBlockLabelIndex   */
+/*-----------------------------------------------------------------*/
+static void deleteLabelIndex(hTab *index)
+{
+  if(index) {
+    hTabDeleteAll(index);
+    Safe_free(index);
+  }
+}
 #if 0
 /*-----------------------------------------------------------------*/
 /* findLabel - Search the pCode for a particular label             */
@@ -6266,6 +6322,7 @@ static void LinkFlow(pBlock *pb)
   pCode *pcflow;
   pCode *pct;
   pCode *jumptab_pre = NULL;
+  hTab *labels = pBlockLabelIndex(pb);
 
   //fprintf(stderr,"linkflow \n");
 
@@ -6359,7 +6416,7 @@ static void LinkFlow(pBlock *pb)
         continue;
       }
 
-      if( (pct = findLabelinpBlock(pb,pcol)) != NULL)
+      if( (pct = findLabelinIndex(labels,pb,pcol)) != NULL)
         LinkFlow_pCode(PCI(pc),PCI(pic16_findNextInstruction(pct)));
       else
         fprintf(stderr, "ERROR: %s, couldn't find label. key=%d,lab=%s\n",
@@ -6387,6 +6444,8 @@ static void LinkFlow(pBlock *pb)
 
     //fprintf(stderr, "ends with nothing: ERROR\n");
   }
+
+  deleteLabelIndex(labels);
 }
 
 /*-----------------------------------------------------------------*/
@@ -6664,6 +6723,32 @@ static pCode * findInstructionUsingLabel(pCodeLabel *pcl, pCode *pcs)
   return NULL;
 }
 
+/*-----------------------------------------------------------------*/
+/* pBlockLabelUseIndex - map the key of each compiler generated    */
+/*                       label referenced in a pBlock to the first */
+/*                       pCode using it (see                       */
+/*                       findInstructionUsingLabel)                */
+/*-----------------------------------------------------------------*/
+static hTab *pBlockLabelUseIndex(pBlock *pb)
+{
+  hTab *index = NULL;
+  pCode *pc;
+  int key;
+
+  for(pc = pb->pcHead; pc; pc = pc->next) {
+
+    if(((pc->type == PC_OPCODE) || (pc->type == PC_INLINE) || (pc->type == PC_ASMDIR)) &&
+       (PCI(pc)->pcop) &&
+       (PCI(pc)->pcop->type == PO_LABEL)) {
+      key = PCOLAB(PCI(pc)->pcop)->key;
+      if((key > 0) && !hTabItemWithKey(index, key))
+        hTabAddItem(&index, key, pc);
+    }
+  }
+
+  return index;
+}
+
 /*-----------------------------------------------------------------*/
 /*-----------------------------------------------------------------*/
 static void exchangeLabels(pCodeLabel *pcl, pCode *pc)
@@ -6708,6 +6793,7 @@ static void pBlockRemoveUnusedLabels(pBlock *pb)
 {
   pCode *pc;
   pCodeLabel *pcl;
+  hTab *uses;
 
   if(!pb || !pb->pcHead)
     return;
@@ -6737,6 +6823,9 @@ static void pBlockRemoveUnusedLabels(pBlock *pb)
     }
   }
 
+  /* the label uses do not change below, so look them up only once */
+  uses = pBlockLabelUseIndex(pb);
+
   for(pc = pb->pcHead; pc; pc = pc->next) {
 
     if(isPCL(pc)) // pc->type == PC_LABEL)
@@ -6750,7 +6839,7 @@ static void pBlockRemoveUnusedLabels(pBlock *pb)
     /* This pCode is a label, so search the pBlock to see if anyone
      * refers to it */
 
-    if((pcl->key>0) && (!findInstructionUsingLabel(pcl, pb->pcHead))
+    if((pcl->key>0) && (!hTabItemWithKey(uses, pcl->key))
         && (!pcl->force)) {
     //if( !findInstructionUsingLabel(pcl, pb->pcHead)) {
       /* Couldn't find an instruction that refers to this label
@@ -6770,6 +6859,8 @@ static void pBlockRemoveUnusedLabels(pBlock *pb)
       }
     }
   }
+
+  deleteLabelIndex(uses);
 }
 
 /*-----------------------------------------------------------------*/
@@ -8690,7 +8781,7 @@ hTab *bank2sym = NULL; // <PSEUDO BANK NR> --> <OPERAND NAME>
 hTab *coerce = NULL;   // <PSEUDO BANK NR> --> <&PSEUDOBANK>
 Graph *adj = NULL;
 
-typedef enum { INVALID_BANK = -1, UNKNOWN_BANK = -2, FIXED_BANK = -3 } pseudoBankNr;
+typedef enum { INVALID_BANK = -1, UNKNOWN_BANK = -2, FIXED_BANK = -3, UNREACHED_BANK = -4 } pseudoBankNr;
 
 typedef struct {
   pseudoBankNr bank;  // number assigned to this pseudoBank
@@ -9004,6 +9095,232 @@ unsigned int attachBsrInfo2pBlock (pBlock *pb, int mod)
   return banksels;
 }
 
+/*------------------------------------------------------------------*/
+/* BSR dataflow across labels                                       */
+/*------------------------------------------------------------------*/
+
+/* The pseudo bank selected on entry to a compiler generated label,
+ * accumulated over all branches to that label. */
+typedef struct {
+  pseudoBankNr bsr;   // meet of the pseudo BSR at all branches seen so far
+  int unsafe;         // label is also reached by other means (CALL, address taken)
+} labelBsr;
+
+/* meetBsr - combine the pseudo BSR of two control flow edges */
+static pseudoBankNr meetBsr (pseudoBankNr a, pseudoBankNr b)
+{
+  if (a == UNREACHED_BANK) return b;
+  if (b == UNREACHED_BANK) return a;
+  return (a == b) ? a : UNKNOWN_BANK;
+}
+
+/* isBsrBranch - check whether pc is a (conditional) jump whose
+ * target is only known through its pCodeOpLabel */
+static int isBsrBranch (pCode *pc)
+{
+  if (!isPCI(pc)) return 0;
+
+  switch (PCI(pc)->op) {
+  case POC_GOTO:
+  case POC_BRA:
+  case POC_BC:
+  case POC_BN:
+  case POC_BNC:
+  case POC_BNN:
+  case POC_BNOV:
+  case POC_BNZ:
+  case POC_BOV:
+  case POC_BZ:
+    return 1;
+
+  default:
+    return 0;
+  } // switch
+}
+
+/* endsBsrFlow - check whether control never falls through pc */
+static int endsBsrFlow (pCode *pc)
+{
+  if (!isPCI(pc)) return 0;
+
+  switch (PCI(pc)->op) {
+  case POC_GOTO:
+  case POC_BRA:
+  case POC_RETURN:
+  case POC_RETLW:
+  case POC_RETFIE:
+    return 1;
+
+  default:
+    return 0;
+  } // switch
+}
+
+/* collectBsrLabels - create one labelBsr per label referenced in pb.
+ * Returns FALSE if some jump target cannot be resolved (inline
+ * assembly, jumps to symbolic addresses), in which case labels must
+ * keep invalidating the pseudo BSR. */
+static int collectBsrLabels (pBlock *pb, hTab **labels)
+{
+  pCode *pc;
+  pCodeOp *pcop;
+  labelBsr *lb;
+  int key;
+
+  for (pc = pb->pcHead; pc; pc = pc->next) {
+    if (pc->type == PC_INLINE) return FALSE;
+
+    if (!isPCI(pc) && !isPCAD(pc)) continue;
+
+    pcop = PCI(pc)->pcop;
+    if (!pcop || pcop->type != PO_LABEL) {
+      if (isBsrBranch (pc) && !(pcop && pcop->type == PO_STR && !strcmp (pcop->name, "$")))
+        return FALSE;
+      continue;
+    } // if
+
+    key = PCOLAB(pcop)->key;
+    if (key <= 0) {
+      if (isBsrBranch (pc)) return FALSE;
+      continue;
+    } // if
+
+    lb = hTabItemWithKey (*labels, key);
+    if (!lb) {
+      lb = Safe_alloc (sizeof (labelBsr));
+      lb->bsr = UNREACHED_BANK;
+      hTabAddItem (labels, key, lb);
+    } // if
+    if (!isBsrBranch (pc)) lb->unsafe = 1;
+  } // for
+
+  return TRUE;
+}
+
+/* entryBsr - compute the pseudo BSR on entry to the labelled
+ * instruction pc, given the pseudo BSR fallthru of the preceding
+ * instruction */
+static pseudoBankNr entryBsr (hTab *labels, pCode *pc, pseudoBankNr fallthru)
+{
+  pCode *prev, *p;
+  pBranch *pbr;
+  labelBsr *lb;
+  pseudoBankNr bsr = fallthru;
+
+  prev = pic16_findPrevInstruction (pc->prev);
+  for (p = pc; p && p != prev; p = p->prev) {
+    if (isPCAD(p) && PCAD(p)->directive == NULL) return UNKNOWN_BANK;
+    if (isPCW(p)) return UNKNOWN_BANK;
+
+    if (isPCL(p)) {
+      if (PCL(p)->key <= 0) return UNKNOWN_BANK;
+      lb = hTabItemWithKey (labels, PCL(p)->key);
+      if (lb && lb->unsafe) return UNKNOWN_BANK;
+      if (lb) bsr = meetBsr (bsr, lb->bsr);
+      continue;
+    } // if
+
+    if (isPCI(p) || isPCAD(p) || p->type == PC_INFO) {
+      for (pbr = PCI(p)->label; pbr; pbr = pbr->next) {
+        if (!isPCL(pbr->pc) || PCL(pbr->pc)->key <= 0) return UNKNOWN_BANK;
+        lb = hTabItemWithKey (labels, PCL(pbr->pc)->key);
+        if (lb && lb->unsafe) return UNKNOWN_BANK;
+        if (lb) bsr = meetBsr (bsr, lb->bsr);
+      } // for
+    } // if
+  } // for
+
+  return bsr;
+}
+
+/* propagateBsr - one pass over pb, updating the pseudo BSR at all
+ * branch targets; removes redundant BANKSELs iff mod == 1.
+ * Returns the number of label states changed (mod == 0) or the
+ * number of BANKSELs removed (mod == 1). */
+static unsigned int propagateBsr (pBlock *pb, hTab *labels, int mod)
+{
+  pCode *pc, *pc_next;
+  pseudoBankNr bsr = UNKNOWN_BANK, before, bank;
+  labelBsr *lb;
+  int prevSkip = 0;
+  unsigned int count = 0;
+
+  pc = pic16_findNextInstruction (pb->pcHead);
+  while (pc) {
+    pc_next = pic16_findNextInstruction (pc->next);
+
+    if (!hasNoLabel (pc))
+      bsr = entryBsr (labels, pc, bsr);
+
+    // unlabelled dead code or jumptable entries
+    if (bsr == UNREACHED_BANK)
+      bsr = UNKNOWN_BANK;
+    before = bsr;
+
+    if (isBsrBranch (pc) && PCI(pc)->pcop && PCI(pc)->pcop->type == PO_LABEL
+        && (lb = hTabItemWithKey (labels, PCOLAB(PCI(pc)->pcop)->key)) != NULL) {
+      bank = meetBsr (lb->bsr, bsr);
+      if (bank != lb->bsr) {
+        lb->bsr = bank;
+        if (!mod) count++;
+      } // if
+    } // if
+
+    if (isBanksel (pc)) {
+      bsr = getEffectiveBank (getBankFromBanksel (pc));
+      if (mod && before == bsr && bsr >= 0) {
+        pic16_pCodeInsertAfter (pc->prev, pic16_newpCodeCharP("removed redundant BANKSEL"));
+        pic16_unlinkpCode (pc);
+        count++;
+      } // if
+    } else if (invalidatesBSR (pc)) {
+      bsr = UNKNOWN_BANK;
+    } // if
+
+    if (endsBsrFlow (pc))
+      bsr = UNREACHED_BANK;
+
+    // pc might have been skipped
+    if (prevSkip)
+      bsr = meetBsr (bsr, before);
+
+    prevSkip = isPCI_SKIP(pc);
+    pc = pc_next;
+  } // while
+
+  return count;
+}
+
+/*------------------------------------------------------------------*/
+/* removeRedundantBanksels - like attachBsrInfo2pBlock (pb, 1), but */
+/*   propagate the selected pseudo bank to labels whose predecessors */
+/*   all agree on it instead of forgetting it at every label        */
+/*------------------------------------------------------------------*/
+static unsigned int removeRedundantBanksels (pBlock *pb)
+{
+  hTab *labels = NULL;
+  labelBsr *lb;
+  unsigned int removed;
+  int key;
+
+  if (!pb) return 0;
+
+  if (!collectBsrLabels (pb, &labels)) {
+    removed = attachBsrInfo2pBlock (pb, 1);
+  } else {
+    // iterate to the fixpoint, then remove using the final label states
+    while (propagateBsr (pb, labels, 0))
+      ;
+    removed = propagateBsr (pb, labels, 1);
+  } // if
+
+  for (lb = hTabFirstItem (labels, &key); lb; lb = hTabNextItem (labels, &key))
+    Safe_free (lb);
+  deleteLabelIndex (labels);
+
+  return removed;
+}
+
 /*------------------------------------------------------------------------------------*/
 /* assignToSameBank - returns 0 on success or an error code                           */
 /*  1 - common bank would be too large                                                */
@@ -9325,7 +9642,10 @@ void pic16_OptimizeBanksel ()
   // remove redundant BANKSELs
   //fprintf (stderr, "removing redundant BANKSELs\n");
   for (pb = the_pFile->pbHead; pb; pb = pb->next) {
-    bankselsRemoved += attachBsrInfo2pBlock (pb, 1);
+    if (pic16_options.opt_banksel > 2)
+      bankselsRemoved += removeRedundantBanksels (pb);
+    else
+      bankselsRemoved += attachBsrInfo2pBlock (pb, 1);
   } // for pb
 #endif
 
@@ -4509,6 +4509,7 @@ pic16_assignRegisters (ebbIndex * ebbi)
 
   _inRegAllocator = 0;
 
+  reportPhase (PHASE_CODEGEN);
   genpic16Code (ic);
 
   /* free up any _G.stackSpil locations allocated */
@@ -20,6 +20,7 @@
 
 #include "ralloc.h"
 #include "gen.h"
+#include "peep.h"
 
 /* Use the D macro for basic (unobtrusive) debugging messages */
 #define D(x) do if (options.verboseAsm) { x; } while (0)
@@ -3585,6 +3586,39 @@ genUminus (const iCode *ic)
   freeAsmop (result);
 }
 
+/*-----------------------------------------------------------------*/
+/* callKeeps - register idx is live across the call ic, but is not */
+/*             saved, since the callee leaves it unchanged         */
+/*-----------------------------------------------------------------*/
+static bool
+callKeeps (int idx, const iCode *ic)
+{
+  if (regDead (idx, ic))
+    return false;
+
+  // Big return values go through x or y, and the frame pointer is always saved.
+  if (ic->op != CALL || IS_OP_LITERAL (IC_LEFT (ic)) || stm8_extend_stack)
+    return false;
+  sym_link *ftype = operandType (IC_LEFT (ic));
+  if (getSize (ftype->next) > 4 || IS_STRUCT (ftype->next))
+    return false;
+
+  unsigned int preserved = optimize.noClobberSummary ? 0 : ~OP_SYMBOL_CONST (IC_LEFT (ic))->funcClobberedRegs;
+  for (int i = 0; i <= YH_IDX; i++)
+    if (ftype->funcAttrs.preserved_regs[i])
+      preserved |= 1u << i;
+
+  switch (idx)
+    {
+    case A_IDX:
+      return (preserved & 1u << A_IDX) && !stm8IsParmInCall (ftype, "a");
+    case X_IDX:
+      return (preserved & 1u << XL_IDX) && (preserved & 1u << XH_IDX) && !stm8IsParmInCall (ftype, "x");
+    default:
+      return (preserved & 1u << YL_IDX) && (preserved & 1u << YH_IDX) && !stm8IsParmInCall (ftype, "y");
+    }
+}
+
 static void
 saveRegsForCall (const iCode * ic)
 {
@@ -3594,13 +3628,13 @@ saveRegsForCall (const iCode * ic)
   //if (!regDead (C_IDX, ic))
   //  push (ASMOP_C, 0, 1);
 
-  if (!regDead (A_IDX, ic))
+  if (!regDead (A_IDX, ic) && !callKeeps (A_IDX, ic))
     push (ASMOP_A, 0, 1);
 
-  if (!regDead (X_IDX, ic))
+  if (!regDead (X_IDX, ic) && !callKeeps (X_IDX, ic))
     push (ASMOP_X, 0, 2);
 
-  if (!regDead (Y_IDX, ic))
+  if (!regDead (Y_IDX, ic) && !callKeeps (Y_IDX, ic))
     push (ASMOP_Y, 0, 2);
 
   G.saved = TRUE;
@@ -4084,12 +4118,17 @@ genCall (const iCode *ic)
   freeAsmop (left);
   G.stack.pushed += prestackadjust;
 
+  // Live registers that were not saved, since the callee preserves them, must not be used below.
+  const bool a_kept = callKeeps (A_IDX, ic);
+  const bool x_kept = callKeeps (X_IDX, ic);
+  const bool y_kept = callKeeps (Y_IDX, ic);
+
   // Adjust the stack for parameters if required.
   if (ic->parmBytes || bigreturn)
     {
-      const bool a_free = !aopRet (ftype) || aopRet (ftype)->regs[A_IDX] < 0;
-      const bool x_free = !aopRet (ftype) || (aopRet (ftype)->regs[XL_IDX] < 0 && aopRet (ftype)->regs[XH_IDX] < 0);
-      const bool y_free = !aopRet (ftype) || (aopRet (ftype)->regs[YL_IDX] < 0 && aopRet (ftype)->regs[YH_IDX] < 0);
+      const bool a_free = !a_kept && (!aopRet (ftype) || aopRet (ftype)->regs[A_IDX] < 0);
+      const bool x_free = !x_kept && (!aopRet (ftype) || (aopRet (ftype)->regs[XL_IDX] < 0 && aopRet (ftype)->regs[XH_IDX] < 0));
+      const bool y_free = !y_kept && (!aopRet (ftype) || (aopRet (ftype)->regs[YL_IDX] < 0 && aopRet (ftype)->regs[YH_IDX] < 0));
       if (IFFUNC_ISNORETURN (ftype) || isFuncCalleeStackCleanup (ftype))
         {
           G.stack.pushed -= ic->parmBytes + bigreturn * 2;
@@ -4178,7 +4217,7 @@ genCall (const iCode *ic)
   if (SomethingReturned && !bigreturn)
     {
       wassert (getSize (ftype->next) >= 1 && getSize (ftype->next) <= 4);
-      genMove (result, aopRet (ftype), true, true, !stm8_extend_stack);
+      genMove (result, aopRet (ftype), !a_kept, !x_kept, !y_kept && !stm8_extend_stack);
     }
 
 restore:
@@ -4186,7 +4225,7 @@ restore:
     freeAsmop (IC_RESULT (ic));
 
   // Restore regs.
-  if (!regDead (Y_IDX, ic) && !stm8_extend_stack)
+  if (!regDead (Y_IDX, ic) && !callKeeps (Y_IDX, ic) && !stm8_extend_stack)
     if (regDead (YH_IDX, ic))
         {
           adjustStack (1, FALSE, FALSE, FALSE);
@@ -4204,7 +4243,7 @@ restore:
       else
         pop (ASMOP_Y, 0, 2);
 
-  if (!regDead (X_IDX, ic))
+  if (!regDead (X_IDX, ic) && !callKeeps (X_IDX, ic))
     {
       if (regDead (XH_IDX, ic))
         {
@@ -4224,7 +4263,7 @@ restore:
         pop (ASMOP_X, 0, 2);
     }
 
-  if (!regDead (A_IDX, ic))
+  if (!regDead (A_IDX, ic) && !callKeeps (A_IDX, ic))
     pop (ASMOP_A, 0, 1);
 
   //if (!regDead (C_IDX, ic))
@@ -9967,6 +10006,7 @@ genSTM8iCode (iCode *ic)
 float
 drySTM8iCode (iCode *ic)
 {
+  reportCount (COUNT_DRYRUNS, 1);
   regalloc_dry_run = TRUE;
   regalloc_dry_run_cost_bytes = 0;
   regalloc_dry_run_cost_cycles = 0;
@@ -10060,6 +10100,10 @@ genSTM8Code (iCode *lic)
   if (!options.nopeep)
     peepHole (&genLine.lineHead);
 
+  /* Later calls from this translation unit only need to save what the final code writes. */
+  if (currFunc)
+    currFunc->funcClobberedRegs = stm8ClobberedRegs (genLine.lineHead);
+
   /* now do the actual printing */
   printLine (genLine.lineHead, codeOutBuf);
 
@@ -965,10 +965,11 @@ callSurelyWrites (const lineNode *pl, const char *what)
   else if ((ISINST(pl->line, "jp") || ISINST(pl->line, "jr") || ISINST(pl->line, "jpf")) && !strchr(pl->line, ','))
     f = findSym (SymbolTab, 0, pl->line + 4 + ISINST(pl->line, "jpf"));
 
-  const bool *preserved_regs;
+  bool preserved_regs[YH_IDX + 1];
 
-  if(f)
-    preserved_regs = f->type->funcAttrs.preserved_regs;
+  if(f) // Registers the callee is known not to write are preserved, too.
+    for (int i = 0; i <= YH_IDX; i++)
+      preserved_regs[i] = f->type->funcAttrs.preserved_regs[i] || !(f->funcClobberedRegs & (1u << i));
   else // Err on the safe side for jp and jr - might not be a function call, might e.g. be a jump table.
     return (false);
 
@@ -1304,3 +1305,177 @@ stm8canAssign (const char *op1, const char *op2, const char *exotic)
     return(reg[0] == 'a');
   return(FALSE);
 }
+
+#define CLOBBER_ALL ((1u << (YH_IDX + 1)) - 1)
+
+/*-----------------------------------------------------------------*/
+/* operandEnd - end of the operand starting at op                  */
+/*-----------------------------------------------------------------*/
+static const char *
+operandEnd (const char *op, const char *end)
+{
+  int depth = 0;
+
+  for (; op < end; op++)
+    if (*op == '(' || *op == '[')
+      depth++;
+    else if (*op == ')' || *op == ']')
+      depth--;
+    else if (*op == ',' && !depth)
+      break;
+
+  return op;
+}
+
+/*-----------------------------------------------------------------*/
+/* operandClobbers - registers written when operand op, up to end, */
+/*                   is the destination of an instruction          */
+/*-----------------------------------------------------------------*/
+static unsigned int
+operandClobbers (const char *op, const char *end)
+{
+  static const struct
+  {
+    const char *name;
+    unsigned int regs;
+  } regNames[] =
+  {
+    {"a", 1u << A_IDX}, {"xl", 1u << XL_IDX}, {"xh", 1u << XH_IDX}, {"yl", 1u << YL_IDX}, {"yh", 1u << YH_IDX},
+    {"x", 1u << XL_IDX | 1u << XH_IDX}, {"y", 1u << YL_IDX | 1u << YH_IDX}, {"sp", 0}, {"cc", 0}
+  };
+  size_t len;
+  int i;
+
+  while (op < end && isspace ((unsigned char)*op))
+    op++;
+  while (end > op && isspace ((unsigned char)end[-1]))
+    end--;
+  len = end - op;
+
+  for (i = 0; i < sizeof (regNames) / sizeof (regNames[0]); i++)
+    if (len == strlen (regNames[i].name) && !STRNCASECMP (op, regNames[i].name, len))
+      return regNames[i].regs;
+
+  // Anything else is memory.
+  return 0;
+}
+
+/*-----------------------------------------------------------------*/
+/* targetClobbers - registers written when control goes to label   */
+/*-----------------------------------------------------------------*/
+static unsigned int
+targetClobbers (const char *label, const char *end)
+{
+  const symbol *f;
+  char name[256];
+
+  while (label < end && isspace ((unsigned char)*label))
+    label++;
+  while (end > label && isspace ((unsigned char)end[-1]))
+    end--;
+
+  // Local label.
+  if (memchr (label, '$', end - label))
+    return 0;
+
+  // Tail call to a function of this translation unit.
+  if (*label == '_' && end - label < sizeof (name))
+    {
+      memcpy (name, label, end - label);
+      name[end - label] = '\0';
+      if ((f = findSym (SymbolTab, 0, name + 1)) && IS_FUNC (f->type) && !strcmp (f->rname, name))
+        return f->funcClobberedRegs & CLOBBER_ALL;
+    }
+
+  return CLOBBER_ALL;
+}
+
+/*-----------------------------------------------------------------*/
+/* lineClobbers - registers the line might write, all if unsure    */
+/*-----------------------------------------------------------------*/
+static unsigned int
+lineClobbers (const lineNode *pl)
+{
+  static const char *const dst[] = {"ld", "ldw", "ldf", "add", "adc", "sub", "sbc", "and", "or", "xor", "addw", "subw",
+    "inc", "incw", "dec", "decw", "neg", "negw", "cpl", "cplw", "clr", "clrw", "sll", "sllw", "sla", "slaw",
+    "srl", "srlw", "sra", "sraw", "rlc", "rlcw", "rrc", "rrcw", "swap", "swapw", "pop", "popw", "mul"};
+  static const char *const both[] = {"exg", "exgw", "div", "divw"};
+  static const char *const none[] = {"nop", "cp", "cpw", "tnz", "tnzw", "bcp", "push", "pushw", "bset", "bres",
+    "bcpl", "bccm", "mov", "rcf", "scf", "ccf", "rvf", "rim", "sim", "ret", "retf", "break", "halt", "wfi", "wfe"};
+  const char *p, *ops, *sep, *end;
+  char mnem[8];
+  size_t len;
+  int i;
+
+  if (!pl->line || pl->isDebug || pl->isComment || pl->isLabel)
+    return 0;
+  if (pl->isInline)
+    return CLOBBER_ALL;
+
+  for (p = pl->line; isspace ((unsigned char)*p); p++);
+  if (!*p || *p == ';' || *p == '.')
+    return 0;
+
+  len = strcspn (p, " \t");
+  if (p[len - 1] == ':')
+    return 0;
+  if (len >= sizeof (mnem))
+    return CLOBBER_ALL;
+  for (i = 0; i < len; i++)
+    mnem[i] = tolower ((unsigned char)p[i]);
+  mnem[len] = '\0';
+
+  for (ops = p + len; isspace ((unsigned char)*ops); ops++);
+  end = ops + strcspn (ops, ";");
+  sep = operandEnd (ops, end);
+
+  for (i = 0; i < sizeof (none) / sizeof (none[0]); i++)
+    if (!strcmp (mnem, none[i]))
+      return 0;
+
+  for (i = 0; i < sizeof (dst) / sizeof (dst[0]); i++)
+    if (!strcmp (mnem, dst[i]))
+      return operandClobbers (ops, sep);
+
+  for (i = 0; i < sizeof (both) / sizeof (both[0]); i++)
+    if (!strcmp (mnem, both[i]) && sep < end)
+      return operandClobbers (ops, sep) | operandClobbers (sep + 1, operandEnd (sep + 1, end));
+
+  if (!strcmp (mnem, "rlwa") || !strcmp (mnem, "rrwa"))
+    return 1u << A_IDX | operandClobbers (ops, sep);
+
+  // Conditional jumps have the label last.
+  if (!strcmp (mnem, "jp") || !strcmp (mnem, "jpf") || !strcmp (mnem, "call") || !strcmp (mnem, "callf") || !strcmp (mnem, "callr") ||
+    mnem[0] == 'j' && mnem[1] == 'r' || !strcmp (mnem, "btjt") || !strcmp (mnem, "btjf"))
+    {
+      const char *label = ops;
+      while (sep < end)
+        {
+          label = sep + 1;
+          sep = operandEnd (label, end);
+        }
+      while (isspace ((unsigned char)*label))
+        label++;
+      if (*label == '(' || *label == '[')
+        return CLOBBER_ALL;
+      return targetClobbers (label, end);
+    }
+
+  return CLOBBER_ALL;
+}
+
+/*-----------------------------------------------------------------*/
+/* stm8ClobberedRegs - registers (bit per register index) that the */
+/* final code of a function, the lines from head on, might write,  */
+/* including the functions it calls.                               */
+/*-----------------------------------------------------------------*/
+unsigned int
+stm8ClobberedRegs (const lineNode *head)
+{
+  unsigned int regs = 0;
+
+  for (const lineNode *pl = head; pl && regs != CLOBBER_ALL; pl = pl->next)
+    regs |= lineClobbers (pl);
+
+  return regs;
+}
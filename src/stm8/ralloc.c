@@ -767,6 +767,7 @@ stm8_assignRegisters (ebbIndex *ebbi)
       dumpLiveRanges (DUMP_LRANGE, liveRanges);
     }
 
+  reportPhase (PHASE_CODEGEN);
   genSTM8Code (ic);
 
   _G.slocNum = 0;
@@ -5837,6 +5837,19 @@ restoreRegs (bool iy, bool de, bool bc, bool hl, const operand *result, const iC
     }
 }
 
+/*-----------------------------------------------------------------*/
+/* callPreserves - the call ic leaves register idx unchanged,      */
+/*                 as declared or as seen in the callee's code     */
+/*-----------------------------------------------------------------*/
+static bool
+callPreserves (const iCode *ic, const sym_link *ftype, int idx)
+{
+  if (ftype->funcAttrs.preserved_regs[idx])
+    return true;
+  return (ic->op == CALL && !IS_OP_LITERAL (IC_LEFT (ic)) && !optimize.noClobberSummary &&
+    !(OP_SYMBOL_CONST (IC_LEFT (ic))->funcClobberedRegs & (1u << idx)));
+}
+
 static void
 _saveRegsForCall (const iCode *ic, bool saveHLifused, bool dontsaveIY)
 {
@@ -5869,12 +5882,12 @@ _saveRegsForCall (const iCode *ic, bool saveHLifused, bool dontsaveIY)
     saveHLifused = true;
   if (!_G.saves.saved)
     {
-      const bool call_preserves_b = ftype->funcAttrs.preserved_regs[B_IDX] && !z80IsParmInCall(ftype, "b");
-      const bool call_preserves_c = ftype->funcAttrs.preserved_regs[C_IDX] && !z80IsParmInCall(ftype, "c");
-      const bool call_preserves_d = ftype->funcAttrs.preserved_regs[D_IDX] && !z80IsParmInCall(ftype, "d");
-      const bool call_preserves_e = ftype->funcAttrs.preserved_regs[E_IDX] && !z80IsParmInCall(ftype, "e");
-      const bool call_preserves_h = ftype->funcAttrs.preserved_regs[H_IDX] && !z80IsParmInCall(ftype, "h");
-      const bool call_preserves_l = ftype->funcAttrs.preserved_regs[L_IDX] && !z80IsParmInCall(ftype, "l");
+      const bool call_preserves_b = callPreserves (ic, ftype, B_IDX) && !z80IsParmInCall(ftype, "b");
+      const bool call_preserves_c = callPreserves (ic, ftype, C_IDX) && !z80IsParmInCall(ftype, "c");
+      const bool call_preserves_d = callPreserves (ic, ftype, D_IDX) && !z80IsParmInCall(ftype, "d");
+      const bool call_preserves_e = callPreserves (ic, ftype, E_IDX) && !z80IsParmInCall(ftype, "e");
+      const bool call_preserves_h = callPreserves (ic, ftype, H_IDX) && !z80IsParmInCall(ftype, "h");
+      const bool call_preserves_l = callPreserves (ic, ftype, L_IDX) && !z80IsParmInCall(ftype, "l");
       const bool push_bc = !isRegDead (B_IDX, ic) && !call_preserves_b || !isRegDead (C_IDX, ic) && !call_preserves_c;
       const bool push_de = !isRegDead (D_IDX, ic) && !call_preserves_d || !isRegDead (E_IDX, ic) && !call_preserves_e;
       const bool push_hl = !isRegDead (H_IDX, ic) && (!call_preserves_h || saveHLifused) || !isRegDead (L_IDX, ic) && (!call_preserves_l || saveHLifused);
@@ -6444,7 +6457,7 @@ genCall (const iCode *ic)
   bool tailjump = false;
 
   for (i = 0; i < IYH_IDX + 1; i++)
-    z80_regs_preserved_in_calls_from_current_function[i] |= ftype->funcAttrs.preserved_regs[i];
+    z80_regs_preserved_in_calls_from_current_function[i] |= callPreserves (ic, ftype, i);
 
   _saveRegsForCall (ic, false, false);
 
@@ -6829,6 +6842,11 @@ genCall (const iCode *ic)
   /* Mark the registers as restored. */
   _G.saves.saved = false;
 
+  /* Live registers that were not saved, since the callee preserves them, must not be used below. */
+  const bool bc_kept = !_G.stack.pushedBC && !(isRegDead (B_IDX, ic) && isRegDead (C_IDX, ic));
+  const bool de_kept = !_G.stack.pushedDE && !(isRegDead (D_IDX, ic) && isRegDead (E_IDX, ic));
+  const bool hl_kept = !_G.stack.pushedHL && !(isRegDead (H_IDX, ic) && isRegDead (L_IDX, ic));
+
   /* adjust the stack for parameters if required */
   if ((ic->parmBytes || bigreturn) && (IFFUNC_ISNORETURN (ftype) || isFuncCalleeStackCleanup (ftype)))
     {
@@ -6843,9 +6861,9 @@ genCall (const iCode *ic)
       bool return_in_reg = SomethingReturned && !bigreturn;
       adjustStack (ic->parmBytes + bigreturn * 2,
         !return_in_reg || !aopRet (ftype) || aopRet (ftype)->regs[A_IDX] < 0 || aopRet (ftype)->regs[A_IDX] > IC_RESULT (ic)->aop->size,
-        !return_in_reg || !aopRet (ftype) || (aopRet (ftype)->regs[C_IDX] < 0 || aopRet (ftype)->regs[C_IDX] > IC_RESULT (ic)->aop->size) && (aopRet (ftype)->regs[B_IDX] < 0 || aopRet (ftype)->regs[B_IDX] > IC_RESULT (ic)->aop->size),
-        !return_in_reg || !aopRet (ftype) || (aopRet (ftype)->regs[E_IDX] < 0 || aopRet (ftype)->regs[E_IDX] > IC_RESULT (ic)->aop->size) && (aopRet (ftype)->regs[D_IDX] < 0 || aopRet (ftype)->regs[D_IDX] > IC_RESULT (ic)->aop->size),
-        !return_in_reg || !aopRet (ftype) || (aopRet (ftype)->regs[L_IDX] < 0 || aopRet (ftype)->regs[L_IDX] > IC_RESULT (ic)->aop->size) && (aopRet (ftype)->regs[H_IDX] < 0 || aopRet (ftype)->regs[H_IDX] > IC_RESULT (ic)->aop->size),
+        !bc_kept && (!return_in_reg || !aopRet (ftype) || (aopRet (ftype)->regs[C_IDX] < 0 || aopRet (ftype)->regs[C_IDX] > IC_RESULT (ic)->aop->size) && (aopRet (ftype)->regs[B_IDX] < 0 || aopRet (ftype)->regs[B_IDX] > IC_RESULT (ic)->aop->size)),
+        !de_kept && (!return_in_reg || !aopRet (ftype) || (aopRet (ftype)->regs[E_IDX] < 0 || aopRet (ftype)->regs[E_IDX] > IC_RESULT (ic)->aop->size) && (aopRet (ftype)->regs[D_IDX] < 0 || aopRet (ftype)->regs[D_IDX] > IC_RESULT (ic)->aop->size)),
+        !hl_kept && (!return_in_reg || !aopRet (ftype) || (aopRet (ftype)->regs[L_IDX] < 0 || aopRet (ftype)->regs[L_IDX] > IC_RESULT (ic)->aop->size) && (aopRet (ftype)->regs[H_IDX] < 0 || aopRet (ftype)->regs[H_IDX] > IC_RESULT (ic)->aop->size)),
         !IY_RESERVED);
 
       if (regalloc_dry_run)
@@ -6855,7 +6873,7 @@ genCall (const iCode *ic)
   /* if we need assign a result value */
   if (SomethingReturned && !bigreturn)
     {
-      genMove (IC_RESULT (ic)->aop, aopRet (ftype), true, true, true, true);
+      genMove (IC_RESULT (ic)->aop, aopRet (ftype), true, !hl_kept, !de_kept, true);
 
       freeAsmop (IC_RESULT (ic), 0);
     }
@@ -17647,6 +17665,7 @@ genZ80iCode (iCode * ic)
 float
 dryZ80iCode (iCode * ic)
 {
+  reportCount (COUNT_DRYRUNS, 1);
   regalloc_dry_run = true;
   regalloc_dry_run_cost = 0;
   regalloc_dry_run_cost_bytes = 0;
@@ -17759,6 +17778,10 @@ genZ80Code (iCode * lic)
   if (!options.nopeep)
     peepHole (&genLine.lineHead);
 
+  /* Later calls from this translation unit only need to save what the final code writes. */
+  if (currFunc && !IFFUNC_ISBANKEDCALL (currFunc->type) && !IFFUNC_ISZ88DK_SHORTCALL (currFunc->type))
+    currFunc->funcClobberedRegs = z80ClobberedRegs (genLine.lineHead);
+
   /* This is unfortunate */
   /* now do the actual printing */
   {
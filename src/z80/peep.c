@@ -51,9 +51,46 @@ typedef enum
   S4O_CONTINUE
 } S4O_RET;
 
+/* Registers tracked by the liveness cache, see z80notUsed() */
+static const char *const liveRegs[] =
+{
+  "a", "b", "c", "d", "e", "h", "l", "ixl", "ixh", "iyl", "iyh", "sp",
+  "zf", "cf", "sf", "pf", "nf", "hf"
+};
+
+#define LIVE_ALL ((1ul << (sizeof (liveRegs) / sizeof (liveRegs[0]))) - 1)
+
+#define LABEL_INDEX_SIZE 256
+
+/* How control leaves a line */
+typedef enum
+{
+  LIVE_NEXT,    /* to the next line */
+  LIVE_STOP,    /* ret */
+  LIVE_ABORT,   /* unknown, e.g. inline assembler */
+  LIVE_JUMP,    /* to the label only: jp, jr, or a tail call */
+  LIVE_BRANCH   /* to the label or the next line */
+} LIVE_FLOW;
+
+/* Liveness information attached to each line via lineNode->aln */
+typedef struct
+{
+  asmLineNodeBase base;
+  LIVE_FLOW flow;
+  const char *label;      /* jump target for LIVE_JUMP and LIVE_BRANCH */
+  unsigned long gen;      /* registers that might be read by this line */
+  unsigned long kill;     /* registers surely written by this line */
+  unsigned long tailGen;  /* registers live at a jump to an unknown label */
+  lineNode *target;       /* line the label resolved to */
+  unsigned long live;     /* registers that might be read from this line on */
+} z80LineLiveness;
+
 static struct
 {
   lineNode *head;
+  hTab *labels;                 /* label definitions of liveHead by name */
+  lineNode *liveHead;           /* line list the liveness cache is for */
+  unsigned long liveGeneration; /* peepHoleGeneration it was computed at */
 } _G;
 
 extern bool z80_regs_used_as_parms_in_calls_from_current_function[IYH_IDX + 1];
@@ -90,18 +127,12 @@ incLabelJmpToCount (const char *label)
 }
 
 /*-----------------------------------------------------------------*/
-/* findLabel -                                                     */
-/* 1. extracts label in the opcode pl                              */
-/* 2. increment "label jump-to count" in labelHash                 */
-/* 3. search lineNode with label definition and return it          */
+/* jumpLabel - extracts the label in the jumping opcode pl         */
 /*-----------------------------------------------------------------*/
-static lineNode *
-findLabel (const lineNode *pl)
+static const char *
+jumpLabel (const lineNode *pl)
 {
-  char *p;
-  lineNode *cpl;
-
-  /* 1. extract label in opcode */
+  const char *p;
 
   /* In each z80 jumping opcode the label is at the end of the opcode */
   p = strlen (pl->line) - 1 + pl->line;
@@ -119,22 +150,67 @@ findLabel (const lineNode *pl)
     }
 
   /* skip ',' resp. '\t' */
-  ++p;
+  return p + 1;
+}
 
-  /* 2. increment "label jump-to count" */
+/*-----------------------------------------------------------------*/
+/* labelNameHash - hash of the label name in line, up to the ':'   */
+/*-----------------------------------------------------------------*/
+static int
+labelNameHash (const char *name, size_t len)
+{
+  unsigned int hash = 0;
+
+  while (len--)
+    hash = hash * 31 + (unsigned char)*name++;
+
+  return hash % LABEL_INDEX_SIZE;
+}
+
+/*-----------------------------------------------------------------*/
+/* findLabelDef - search lineNode with label definition p          */
+/*-----------------------------------------------------------------*/
+static lineNode *
+findLabelDef (const char *p)
+{
+  lineNode *cpl;
+  size_t len = strlen (p);
+
+  /* increment "label jump-to count" */
   if (!incLabelJmpToCount (p))
     return NULL;
 
-  /* 3. search lineNode with label definition and return it */
+  if (_G.labels && _G.head == _G.liveHead && _G.liveGeneration == peepHoleGeneration)
+    {
+      for (cpl = hTabFirstItemWK (_G.labels, labelNameHash (p, len)); cpl; cpl = hTabNextItemWK (_G.labels))
+        if (strncmp (p, cpl->line, len) == 0 && cpl->line[len] == ':')
+          return cpl;
+      return NULL;
+    }
+
   for (cpl = _G.head; cpl; cpl = cpl->next)
     if (cpl->isLabel &&
-      strncmp (p, cpl->line, strlen(p)) == 0 &&
-      cpl->line[strlen(p)] == ':')
+      strncmp (p, cpl->line, len) == 0 &&
+      cpl->line[len] == ':')
         return cpl;
 
   return NULL;
 }
 
+/*-----------------------------------------------------------------*/
+/* findLabel -                                                     */
+/* 1. extracts label in the opcode pl                              */
+/* 2. increment "label jump-to count" in labelHash                 */
+/* 3. search lineNode with label definition and return it          */
+/*-----------------------------------------------------------------*/
+static lineNode *
+findLabel (const lineNode *pl)
+{
+  const char *p = jumpLabel (pl);
+
+  return p ? findLabelDef (p) : NULL;
+}
+
 /* Check if reading arg implies reading what. */
 static bool argCont(const char *arg, const char *what)
 {
@@ -843,8 +919,14 @@ callSurelyWrites (const lineNode *pl, const char *what)
   if(!strcmp(what, "ix"))
     return(false);
 
+  bool summary_regs[IYH_IDX + 1];
   if(f)
-    preserved_regs = f->type->funcAttrs.preserved_regs;
+    {
+      // Registers the callee is known not to write are preserved, too.
+      for (int i = 0; i < IYH_IDX + 1; i++)
+        summary_regs[i] = f->type->funcAttrs.preserved_regs[i] || !(f->funcClobberedRegs & (1u << i));
+      preserved_regs = summary_regs;
+    }
   else if (ISINST(pl->line, "call"))
     preserved_regs = z80_regs_preserved_in_calls_from_current_function;
   else // Err on the safe side for jp and jr - might not be a function call, might e.g. be a jump table.
@@ -1189,12 +1271,191 @@ isRegPair(const char *what)
   return FALSE;
 }
 
+/*-----------------------------------------------------------------*/
+/* lineLiveness - returns the liveness information of pl, working  */
+/* out which of the liveRegs it reads and writes on first use.     */
+/* These only depend on the line itself, so they stay valid while  */
+/* peephole rules replace other lines.                             */
+/*-----------------------------------------------------------------*/
+static z80LineLiveness *
+lineLiveness (lineNode *pl)
+{
+  z80LineLiveness *ll;
+  const symbol *f;
+  int i;
+
+  if (pl->aln)
+    return (z80LineLiveness *) pl->aln;
+
+  ll = Safe_alloc (sizeof (z80LineLiveness));
+  pl->aln = &ll->base;
+
+  if (!pl->line || pl->isDebug || pl->isComment || pl->isLabel)
+    {
+      ll->flow = LIVE_NEXT;
+      return ll;
+    }
+
+  /* don't optimize across inline assembler,
+     e.g. isLabel doesn't work there */
+  if (pl->isInline)
+    {
+      ll->flow = LIVE_ABORT;
+      return ll;
+    }
+
+  for (i = 0; i < sizeof (liveRegs) / sizeof (liveRegs[0]); i++)
+    {
+      const char *what = liveRegs[i];
+      bool isFlag = (strlen(what) == 2 && what[1] == 'f');
+      if (isFlag ? z80MightReadFlag (pl, what) : z80MightRead (pl, what))
+        ll->gen |= 1ul << i;
+    }
+
+  /* Same order of tests as in scan4op() */
+  if (z80UncondJump (pl))
+    {
+      ll->flow = LIVE_JUMP;
+      ll->label = jumpLabel (pl);
+      /* jp/jr could be a tail call. */
+      f = findSym (SymbolTab, 0, pl->line + 4);
+      for (i = 0; i < sizeof (liveRegs) / sizeof (liveRegs[0]); i++)
+        if ((f && z80IsParmInCall (f->type, liveRegs[i])) || !callSurelyWrites (pl, liveRegs[i]))
+          ll->tailGen |= 1ul << i;
+      ll->tailGen |= ll->gen;
+      return ll;
+    }
+
+  if (z80CondJump (pl))
+    {
+      ll->flow = LIVE_BRANCH;
+      ll->label = jumpLabel (pl);
+      return ll;
+    }
+
+  for (i = 0; i < sizeof (liveRegs) / sizeof (liveRegs[0]); i++)
+    {
+      const char *what = liveRegs[i];
+      bool isFlag = (strlen(what) == 2 && what[1] == 'f');
+      if (isFlag ? z80SurelyWritesFlag (pl, what) : z80SurelyWrites (pl, what))
+        ll->kill |= 1ul << i;
+    }
+
+  if (z80SurelyReturns (pl))
+    ll->flow = LIVE_STOP;
+  else
+    ll->flow = LIVE_NEXT;
+
+  return ll;
+}
+
+/*-----------------------------------------------------------------*/
+/* liveAfter - registers that might be read after pl               */
+/*-----------------------------------------------------------------*/
+static unsigned long
+liveAfter (const lineNode *pl)
+{
+  return pl->next ? lineLiveness (pl->next)->live : LIVE_ALL;
+}
+
+/*-----------------------------------------------------------------*/
+/* updateLiveness - (re)computes the registers live at each line   */
+/* of the list starting at head, unless that has already been done */
+/* since the last change to the list. This is the same question    */
+/* scan4op() answers for a single register, solved for all of them */
+/* and all lines at once by iterating to the least fixpoint.       */
+/*-----------------------------------------------------------------*/
+static void
+updateLiveness (lineNode *head)
+{
+  lineNode *pl, *tail = NULL;
+  z80LineLiveness *ll;
+  unsigned long live;
+  bool change;
+
+  if (_G.liveHead == head && _G.liveGeneration == peepHoleGeneration)
+    return;
+
+  if (_G.labels)
+    {
+      hTabDeleteAll (_G.labels);
+      Safe_free (_G.labels);
+      _G.labels = NULL;
+    }
+  _G.liveHead = head;
+  _G.liveGeneration = peepHoleGeneration;
+
+  for (pl = head; pl; pl = pl->next)
+    {
+      const char *colon;
+      if (pl->isLabel && pl->line && (colon = strchr (pl->line, ':')))
+        hTabAddItem (&_G.labels, labelNameHash (pl->line, colon - pl->line), pl);
+      tail = pl;
+    }
+
+  for (pl = head; pl; pl = pl->next)
+    {
+      ll = lineLiveness (pl);
+      ll->live = 0;
+      ll->target = ll->label ? findLabelDef (ll->label) : NULL;
+    }
+
+  do
+    {
+      change = FALSE;
+      for (pl = tail; pl; pl = pl->prev)
+        {
+          ll = lineLiveness (pl);
+          switch (ll->flow)
+            {
+            case LIVE_NEXT:
+              live = ll->gen | (liveAfter (pl) & ~ll->kill);
+              break;
+            case LIVE_STOP:
+              live = ll->gen;
+              break;
+            case LIVE_JUMP:
+              live = ll->target ? ll->gen | lineLiveness (ll->target)->live : ll->tailGen;
+              break;
+            case LIVE_BRANCH:
+              live = ll->target ? ll->gen | liveAfter (pl) | lineLiveness (ll->target)->live : LIVE_ALL;
+              break;
+            default:
+              live = LIVE_ALL;
+              break;
+            }
+          if (live != ll->live)
+            {
+              ll->live = live;
+              change = TRUE;
+            }
+        }
+    }
+  while (change);
+}
+
+/*-----------------------------------------------------------------*/
+/* liveRegBit - bit of what in the liveness cache, 0 if untracked  */
+/*-----------------------------------------------------------------*/
+static unsigned long
+liveRegBit (const char *what)
+{
+  int i;
+
+  for (i = 0; i < sizeof (liveRegs) / sizeof (liveRegs[0]); i++)
+    if (!strcmp (what, liveRegs[i]))
+      return 1ul << i;
+
+  return 0;
+}
+
 /* Check that what is never read after endPl. */
 
 bool
 z80notUsed (const char *what, lineNode *endPl, lineNode *head)
 {
   lineNode *pl;
+  unsigned long bit;
   D(("Checking for %s\n", what));
 
   if(strcmp(what, "af") == 0)
@@ -1248,6 +1509,12 @@ z80notUsed (const char *what, lineNode *endPl, lineNode *head)
 
   _G.head = head;
 
+  if ((bit = liveRegBit (what)))
+    {
+      updateLiveness (head);
+      return !(liveAfter (endPl) & bit);
+    }
+
   unvisitLines (_G.head);
 
   pl = endPl->next;
@@ -1806,6 +2073,166 @@ int z80instructionSize(lineNode *pl)
   return(999);
 }
 
+#define CLOBBER_ALL ((1u << (IYH_IDX + 1)) - 1)
+
+/*-----------------------------------------------------------------*/
+/* operandClobbers - registers written when operand op, up to end, */
+/*                   is the destination of an instruction          */
+/*-----------------------------------------------------------------*/
+static unsigned int
+operandClobbers (const char *op, const char *end)
+{
+  static const struct
+  {
+    const char *name;
+    unsigned int regs;
+  } regNames[] =
+  {
+    {"a", 1u << A_IDX}, {"b", 1u << B_IDX}, {"c", 1u << C_IDX}, {"d", 1u << D_IDX},
+    {"e", 1u << E_IDX}, {"h", 1u << H_IDX}, {"l", 1u << L_IDX},
+    {"af", 1u << A_IDX}, {"bc", 1u << B_IDX | 1u << C_IDX}, {"de", 1u << D_IDX | 1u << E_IDX},
+    {"hl", 1u << H_IDX | 1u << L_IDX}, {"iyl", 1u << IYL_IDX}, {"iyh", 1u << IYH_IDX},
+    {"iy", 1u << IYL_IDX | 1u << IYH_IDX},
+    {"ix", 0}, {"ixl", 0}, {"ixh", 0}, {"sp", 0}, {"i", 0}, {"r", 0}
+  };
+  size_t len;
+  int i;
+
+  while (op < end && isspace ((unsigned char)*op))
+    op++;
+  while (end > op && isspace ((unsigned char)end[-1]))
+    end--;
+  len = end - op;
+
+  // Memory. The sm83 increments or decrements hl in (hl+), (hl-).
+  if (len && *op == '(')
+    return (end[-2] == '+' || end[-2] == '-' || end[-2] == 'i' || end[-2] == 'd') ? 1u << H_IDX | 1u << L_IDX : 0;
+
+  for (i = 0; i < sizeof (regNames) / sizeof (regNames[0]); i++)
+    if (len == strlen (regNames[i].name) && !STRNCASECMP (op, regNames[i].name, len))
+      return regNames[i].regs;
+
+  return CLOBBER_ALL;
+}
+
+/*-----------------------------------------------------------------*/
+/* targetClobbers - registers written when control goes to label   */
+/*-----------------------------------------------------------------*/
+static unsigned int
+targetClobbers (const char *label)
+{
+  const symbol *f;
+
+  while (isspace ((unsigned char)*label))
+    label++;
+
+  // Local label.
+  if (strchr (label, '$'))
+    return 0;
+
+  // Tail call to a function of this translation unit.
+  if (*label == '_' && (f = findSym (SymbolTab, 0, label + 1)) && IS_FUNC (f->type) && !strcmp (f->rname, label))
+    return f->funcClobberedRegs & CLOBBER_ALL;
+
+  return CLOBBER_ALL;
+}
+
+/*-----------------------------------------------------------------*/
+/* lineClobbers - registers the line might write, all if unsure    */
+/*-----------------------------------------------------------------*/
+static unsigned int
+lineClobbers (const lineNode *pl)
+{
+  static const char *const alu[] = {"add", "adc", "sub", "sbc", "and", "or", "xor"};
+  static const char *const dst[] = {"ld", "ldh", "lda", "ldp", "in", "in0", "lea", "inc", "dec", "rl", "rr", "rlc", "rrc",
+    "sla", "sra", "srl", "sll", "sli", "swap", "pop", "mlt", "bool"};
+  static const char *const acc[] = {"neg", "cpl", "daa", "rla", "rra", "rlca", "rrca", "rld", "rrd"};
+  static const char *const block[] = {"cpi", "cpd", "cpir", "cpdr", "ini", "ind", "inir", "indr",
+    "outi", "outd", "otir", "otdr", "otim", "otimr", "otdm", "otdmr"};
+  static const char *const none[] = {"nop", "halt", "di", "ei", "im", "cp", "bit", "push", "out", "scf", "ccf",
+    "tst", "pea", "ret", "reti", "retn"};
+  const char *p, *ops, *comma, *end;
+  char mnem[8];
+  size_t len;
+  int i;
+
+  if (!pl->line || pl->isDebug || pl->isComment || pl->isLabel)
+    return 0;
+  if (pl->isInline)
+    return CLOBBER_ALL;
+
+  for (p = pl->line; isspace ((unsigned char)*p); p++);
+  if (!*p || *p == ';' || *p == '.')
+    return 0;
+
+  len = strcspn (p, " \t");
+  if (p[len - 1] == ':')
+    return 0;
+  if (len >= sizeof (mnem))
+    return CLOBBER_ALL;
+  for (i = 0; i < len; i++)
+    mnem[i] = tolower ((unsigned char)p[i]);
+  mnem[len] = '\0';
+
+  for (ops = p + len; isspace ((unsigned char)*ops); ops++);
+  end = ops + strcspn (ops, ";");
+  comma = memchr (ops, ',', end - ops);
+
+  for (i = 0; i < sizeof (none) / sizeof (none[0]); i++)
+    if (!strcmp (mnem, none[i]))
+      return 0;
+
+  for (i = 0; i < sizeof (alu) / sizeof (alu[0]); i++)
+    if (!strcmp (mnem, alu[i]))
+      return comma ? operandClobbers (ops, comma) : 1u << A_IDX;
+
+  for (i = 0; i < sizeof (dst) / sizeof (dst[0]); i++)
+    if (!strcmp (mnem, dst[i]))
+      return operandClobbers (ops, comma ? comma : end) |
+        (IS_SM83 && memchr (ops, '(', end - ops) && (memchr (ops, '+', end - ops) || memchr (ops, '-', end - ops)) ? 1u << H_IDX | 1u << L_IDX : 0);
+
+  for (i = 0; i < sizeof (acc) / sizeof (acc[0]); i++)
+    if (!strcmp (mnem, acc[i]))
+      return 1u << A_IDX | (ops < end ? operandClobbers (ops, comma ? comma : end) : 0);
+
+  for (i = 0; i < sizeof (block) / sizeof (block[0]); i++)
+    if (!strcmp (mnem, block[i]))
+      return 1u << B_IDX | 1u << C_IDX | 1u << H_IDX | 1u << L_IDX;
+
+  if (!strcmp (mnem, "ldi") || !strcmp (mnem, "ldd") || !strcmp (mnem, "ldir") || !strcmp (mnem, "lddr"))
+    return IS_SM83 ? 1u << A_IDX | 1u << H_IDX | 1u << L_IDX : 1u << B_IDX | 1u << C_IDX | 1u << D_IDX | 1u << E_IDX | 1u << H_IDX | 1u << L_IDX;
+  if (!strcmp (mnem, "ldhl"))
+    return 1u << H_IDX | 1u << L_IDX;
+  if (!strcmp (mnem, "exx"))
+    return 1u << B_IDX | 1u << C_IDX | 1u << D_IDX | 1u << E_IDX | 1u << H_IDX | 1u << L_IDX;
+  if (!strcmp (mnem, "ex") && comma)
+    return operandClobbers (ops, comma) | (strncmp (comma + 1 + strspn (comma + 1, " \t"), "af'", 3) ? operandClobbers (comma + 1, end) : 1u << A_IDX);
+  if (!strcmp (mnem, "djnz"))
+    return 1u << B_IDX;
+  if ((!strcmp (mnem, "set") || !strcmp (mnem, "res")) && comma && !memchr (comma + 1, ',', end - comma - 1))
+    return operandClobbers (comma + 1, end);
+  if (!strcmp (mnem, "jp") || !strcmp (mnem, "jr") || !strcmp (mnem, "call"))
+    return targetClobbers (comma ? comma + 1 : ops);
+
+  return CLOBBER_ALL;
+}
+
+/*-----------------------------------------------------------------*/
+/* z80ClobberedRegs - registers (bit per register index) that the  */
+/* final code of a function, the lines from head on, might write,  */
+/* including the functions it calls.                               */
+/*-----------------------------------------------------------------*/
+unsigned int
+z80ClobberedRegs (const lineNode *head)
+{
+  unsigned int regs = 0;
+
+  for (const lineNode *pl = head; pl && regs != CLOBBER_ALL; pl = pl->next)
+    regs |= lineClobbers (pl);
+
+  return regs;
+}
+
 bool z80symmParmStack (const char *name)
 {
   if (!strcmp (name, "___sdcc_enter_ix"))
@@ -29,4 +29,5 @@ bool z80symmParmStack (const char *name);
 bool z80canJoinRegs (const char **regs, char dst[20]);
 bool z80canSplitReg (const char *reg, char dst[][16], int nDst);
 int z80instructionSize(lineNode *node);
+unsigned int z80ClobberedRegs (const lineNode *head);
 
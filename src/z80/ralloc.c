@@ -1290,6 +1290,7 @@ z80_ralloc (ebbIndex *ebbi)
       dumpLiveRanges (DUMP_LRANGE, liveRanges);
     }
 
+  reportPhase (PHASE_CODEGEN);
   genZ80Code (ic);
 
   /* free up any stackSpil locations allocated */
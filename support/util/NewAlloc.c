@@ -24,6 +24,7 @@
 #include <string.h>
 #include <memory.h>
 #include <assert.h>
+#include <stddef.h>
 #include "newalloc.h"
 
 #if OPT_ENABLE_LIBGC
@@ -47,6 +48,9 @@
 
 #define TRACEMALLOC	0
 
+/* bytes requested so far, for the memory report of sdcc */
+static unsigned long long _allocated;
+
 #if TRACEMALLOC
 enum
 {
@@ -110,6 +114,7 @@ Clear_realloc (void *OldPtr, size_t OldSize, size_t NewSize)
   void *NewPtr;
 
   NewPtr = REALLOC (OldPtr, NewSize);
+  _allocated += NewSize;
 
   if (!NewPtr)
     {
@@ -138,6 +143,7 @@ Safe_realloc (void *OldPtr, size_t NewSize)
   void *NewPtr;
 
   NewPtr = REALLOC (OldPtr, NewSize);
+  _allocated += NewSize;
 
   if (!NewPtr)
     {
@@ -163,6 +169,7 @@ Safe_calloc (size_t Elements, size_t Size)
   void *NewPtr;
 
   NewPtr = MALLOC (Elements * Size);
+  _allocated += Elements * Size;
 #if TRACEMALLOC
   _log (Elements * Size);
 #endif
@@ -193,6 +200,7 @@ Safe_malloc (size_t Size)
   void *NewPtr;
 
   NewPtr = MALLOC (Size);
+  _allocated += Size;
 
 #if TRACEMALLOC
   _log (Size);
@@ -275,3 +283,88 @@ freeTrace (allocTrace * ptrace)
   ptrace->palloced = NULL;
   ptrace->max = 0;
 }
+
+/* memory of a region is taken from the heap in blocks of this size */
+#define REGION_BLOCK_SIZE (64 * 1024)
+
+struct _regionBlock
+{
+  struct _regionBlock *next;
+  union
+  {
+    long double d;
+    long long l;
+    void *p;
+  } mem[1];
+};
+
+#define REGION_ALIGN (sizeof (((struct _regionBlock *) 0)->mem[0]))
+
+void *
+regionAlloc (allocRegion * pregion, size_t size)
+{
+  struct _regionBlock *pblock;
+  char *p;
+
+  assert (pregion);
+
+  size = (size + REGION_ALIGN - 1) / REGION_ALIGN * REGION_ALIGN;
+
+  if (size > pregion->left)
+    {
+      /* large requests get a block of their own, so that
+         the rest of the current block is not wasted */
+      if (size > REGION_BLOCK_SIZE / 4)
+        {
+          pblock = Safe_alloc (offsetof (struct _regionBlock, mem) + size);
+          if (pregion->blocks)
+            {
+              pblock->next = pregion->blocks->next;
+              pregion->blocks->next = pblock;
+            }
+          else
+            {
+              pregion->blocks = pblock;
+              pregion->left = 0;
+            }
+          pregion->size += size;
+          return pblock->mem;
+        }
+
+      pblock = Safe_alloc (offsetof (struct _regionBlock, mem) + REGION_BLOCK_SIZE);
+      pblock->next = pregion->blocks;
+      pregion->blocks = pblock;
+      pregion->pfree = (char *) pblock->mem;
+      pregion->left = REGION_BLOCK_SIZE;
+    }
+
+  p = pregion->pfree;
+  pregion->pfree += size;
+  pregion->left -= size;
+  pregion->size += size;
+
+  return p;
+}
+
+void
+freeRegion (allocRegion * pregion)
+{
+  struct _regionBlock *pblock;
+
+  assert (pregion);
+
+  while ((pblock = pregion->blocks))
+    {
+      pregion->blocks = pblock->next;
+      Safe_free (pblock);
+    }
+  pregion->pfree = NULL;
+  pregion->left = 0;
+  pregion->size = 0;
+}
+
+unsigned long long
+Safe_allocated (void)
+{
+  return _allocated;
+}
@@ -32,6 +32,14 @@ typedef struct _allocTrace
   void **palloced;
 } allocTrace;
 
+typedef struct _allocRegion
+{
+  struct _regionBlock *blocks;
+  char *pfree;
+  size_t left;
+  size_t size;
+} allocRegion;
+
 /*
 -------------------------------------------------------------------------------
 Clear_realloc - Reallocate a memory block and clear any memory added with
@@ -96,4 +104,18 @@ void *traceAlloc (allocTrace * ptrace, void *p);
  */
 void freeTrace (allocTrace * ptrace);
 
+/** Allocates zeroed memory in the given region. The memory can not be
+    freed or reallocated on its own, only all at once using freeRegion.
+*/
+void *regionAlloc (allocRegion * pregion, size_t size);
+
+/** Frees all the memory allocated in the region and resets the region.
+ */
+void freeRegion (allocRegion * pregion);
+
+/** Returns the number of bytes requested so far from the heap through
+    the functions above.
+ */
+unsigned long long Safe_allocated (void);
+
 #endif